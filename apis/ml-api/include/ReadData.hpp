@@ -3,10 +3,10 @@
 #include <vector>
 #include <iostream>
 #include <cctype>
-#include <fstream>
 
 // I use my own CSV library.
-// It can not read matrices, so I leave that to functions in this file.
+// TSPLIB files separate values with runs of spaces, which the CSV Reader
+// handles through a whitespace-run dialect (no custom tokenising loops here).
 #include "csv-library/CSV.hpp"
 #include "Utils.hpp"
 
@@ -21,8 +21,16 @@ inline std::vector<std::vector<double>> readDoubleMatrix(const std::string& file
 // ----------------------------< METHOD DEFINITIONS >-----------------------------
 // ===============================================================================
 
+// Whitespace-separated TSPLIB sections: any run of spaces/tabs is one separator
+inline csv::Dialect tsplibDialect(char delimiter){
+    csv::Dialect dialect;
+    dialect.delimiter = delimiter;
+    dialect.collapseWhitespace = (delimiter == ' ' || delimiter == '\t');
+    return dialect;
+}
+
 inline std::vector<City> readIntegerCSV(const std::string& filePath, uint32 startLine, char delimiter){
-    csv::Reader reader(delimiter);
+    csv::Reader reader(tsplibDialect(delimiter));
     
     reader.open(filePath);
     reader.setRowNumber(startLine); // start from data
@@ -32,6 +40,8 @@ inline std::vector<City> readIntegerCSV(const std::string& filePath, uint32 star
     while(auto row = reader.readRow()){
         if((*row)[0] == "EOF") 
 			break;
+        if(row->size() < 3) // blank or malformed line
+            continue;
         cities.push_back(City{
             (uint32_t) stoi((*row)[0]),    // City ID
             stod((*row)[1]),    // X Coordinate
@@ -44,89 +54,43 @@ inline std::vector<City> readIntegerCSV(const std::string& filePath, uint32 star
 }
 
 // Read asymmetric TSP matrix and convert to double
-// numCols: after every numCols values processed, start a new matrix row
+// dimension: after every dimension values processed, start a new matrix row
+// (TSPLIB wraps matrix rows over several lines, so lines and rows differ)
 inline std::vector<std::vector<double>> readDoubleMatrix(const std::string& filePath, uint32 startLine, uint32 dimension){
-    std::ifstream file;
+    csv::Reader reader(tsplibDialect(' '));
     
-    file.open(filePath, std::ios::in);
-    if(!file.is_open()) throw csv::FileOpenFailureException(filePath);
-    
-    for(uint32 i = 0; i < startLine; i++) 
-        file.ignore(2147483647, '\n');
+    reader.open(filePath);
+    reader.setRowNumber(startLine);
     
     std::vector<std::vector<double>> matrix;
-    std::string str;
-    char c;
-    bool previousCharIsNumber = false;
-    uint32_t valueCounted = 0;  // Track total number of values processed
-    
     std::vector<double> row;
-    while(file.get(c)){
-        
-        // If we encounter alphabetic characters (headers like EDGE_WEIGHT_SECTION
-        // or an EOF marker), read the token and handle appropriately.
-        if(std::isalpha(static_cast<unsigned char>(c))){
-            std::string token;
-            token.push_back(c);
-            // read until whitespace or EOF
-            while(file.peek() != EOF && !std::isspace(file.peek())){
-                char nc; file.get(nc);
-                token.push_back(nc);
+    row.reserve(dimension);
+    
+    while(auto line = reader.readRow()){
+        for(const std::string& field : *line){
+            if(field.empty()) continue;
+            
+            // Alphabetic tokens are section headers (e.g. EDGE_WEIGHT_SECTION)
+            // or the EOF marker; skip the rest of a header line
+            if(std::isalpha(static_cast<unsigned char>(field[0]))){
+                if(field == "EOF"){
+                    reader.close();
+                    return matrix;
+                }
+                break;
             }
-            // If token is EOF, break; otherwise skip the rest of the line and continue
-            if(token == "EOF") break;
-            file.ignore(2147483647, '\n');
-            previousCharIsNumber = false;
-            str.clear();
-            continue;
-        }
-
-        if(c == ' '){
-            if(!previousCharIsNumber) continue;
             
-            // if previous character is number
-            row.push_back(std::stod(str));
-            previousCharIsNumber = false;
-            str.clear();
-            valueCounted++;
+            row.push_back(std::stod(field));
             
-            // Every numCols values, start a new row
-            if(valueCounted % dimension == 0){
-                matrix.push_back(row);
+            // Every dimension values, start a new row
+            if(row.size() == dimension){
+                matrix.push_back(std::move(row));
                 row.clear();
+                row.reserve(dimension);
             }
-            continue;
-        }
-
-        else if(c == '\n'){
-            if(previousCharIsNumber){
-                row.push_back(std::stod(str));
-                str.clear();
-                previousCharIsNumber = false;
-                valueCounted++;
-                
-                // Every numCols values, start a new row
-                if(valueCounted % dimension == 0){
-                    matrix.push_back(row);
-                    row.clear();
-                }
-            }
-            continue;
         }
-        
-        else if(std::isdigit(static_cast<unsigned char>(c)) || c == '.'){
-            str += c;
-            previousCharIsNumber = true;
-            continue;
-        }
-        
-        // Any other non-handled character: skip until end of line to be robust
-        // std::numeric_limits<std::streamsize>::max() is essentially 'infinity'
-        file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
-        previousCharIsNumber = false;
-        str.clear();
-        continue;
     }
     
+    reader.close();
     return matrix;
 }
\ No newline at end of file
@@ -19,6 +19,20 @@
 #include <utility>
 #include <functional>
 #include <optional>
+#include <string_view>
+#include <algorithm>
+#include <limits>
+#include <cctype>
+#include <cstdlib>
+#include <chrono>
+#include <thread>
+#include <filesystem>
+
+#ifdef __linux__ // inotify is used by Reader::follow() to wake on file growth
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
 
 #include "include/Error.hpp"  // Project-specific error handling
 #include "include/Table.hpp"  // Table class
@@ -42,8 +56,27 @@ using uint64 = std::uint64_t;
 
 namespace csv{   
      
+// Line ending convention detected by sniffDialect()
+enum class LineEnding : uint8{
+    LF,     // "\n"
+    CRLF,   // "\r\n"
+    CR      // "\r" (classic Mac)
+};
+
+// Dialect: how a CSV file is laid out, as detected by sniffDialect()
+struct Dialect{
+    char delimiter = ',';               // Field separator
+    char quoteChar = '"';               // Quote character for fields containing special characters
+    bool hasHeader = false;             // First row looks like column names (informational: readers do not skip it, call setHeader(0))
+    LineEnding lineEnding = LineEnding::LF; // Row terminator; CRLF rows are split on '\n' and the '\r' trimmed
+    bool collapseWhitespace = false;    // Runs of spaces/tabs form one separator (e.g. TSPLIB files)
+};
+
 // Free utility functions (not part of any class):
-inline uint32 countLines(const std::string& filePath); // Count lines in a file
+inline uint32 countLines(const std::string& filePath, char lineBreak = '\n'); // Count lines in a file ('\r' for CR-only files)
+inline Dialect sniffSample(std::string_view sample); // Detect the dialect of an in-memory sample
+inline Dialect sniffDialect(const std::string& filePath, size_t sampleBytes = 64 * 1024); // Detect the dialect from the first sampleBytes of a file
+inline bool parseFields(std::string_view line, std::vector<std::string>& fields, std::string_view delim, char quoteChar = '"', bool collapseWhitespace = false); // Split one row into unescaped fields; false if a quoted field is left open
 
 // Specific fatal exceptions
 class WriterClosedException : public error::FatalException{
@@ -93,6 +126,14 @@ private:
 
 // Specific non-fatal exceptions
 
+// RowWidthMismatchException: when an in-place update would change a row's byte width
+class RowWidthMismatchException : public error::NonFatalException{
+public:
+    explicit RowWidthMismatchException(uint32 rowNumber, size_t existingWidth, size_t newWidth)
+    :   NonFatalException("Row "+std::to_string(rowNumber)+" is "+std::to_string(existingWidth)+" bytes wide, replacement is "+std::to_string(newWidth)+" bytes.")
+    {}
+};
+
 class ReaderClosedException : public error::NonFatalException{
 public:
     explicit ReaderClosedException()
@@ -213,29 +254,118 @@ public:
 };
 
 
+// Lenient parsing: malformed rows are recorded here instead of throwing
+enum class ParseErrorReason : uint8{
+    UnterminatedQuote,  // Quoted field still open at end of file or after maxRowBytes
+    StrayQuote,         // Quote inside an unquoted field
+    TextAfterQuote,     // Characters between a closing quote and the next delimiter
+    ShortRow            // Fewer fields than the set header
+};
+
+inline const char* toString(ParseErrorReason reason){
+    switch(reason){
+        case ParseErrorReason::UnterminatedQuote: return "unterminated quoted field";
+        case ParseErrorReason::StrayQuote:        return "quote inside unquoted field";
+        case ParseErrorReason::TextAfterQuote:    return "text after closing quote";
+        case ParseErrorReason::ShortRow:          return "row shorter than header";
+    }
+    return "unknown parse error";
+}
+
+struct ParseError{
+    uint32 rowNumber;   // Row number of the rejected row (0-based)
+    uint64 byteOffset;  // Byte offset of the start of the row
+    ParseErrorReason reason;
+};
+
+// Bounded store of parse errors; errors past capacity are only counted
+class ErrorSink{
+private:
+    std::vector<ParseError> errors;
+    size_t capacity;
+    uint64 numDropped;
+    
+public:
+    explicit ErrorSink(size_t capacity = 1000)
+    :   capacity(capacity),
+        numDropped(0)
+    {}
+    
+    void record(uint32 rowNumber, uint64 byteOffset, ParseErrorReason reason){
+        if(errors.size() < capacity) errors.push_back(ParseError{rowNumber, byteOffset, reason});
+        else numDropped++;
+    }
+    
+    const std::vector<ParseError>& getErrors() const noexcept { return errors; }
+    uint64 getNumDropped() const noexcept { return numDropped; }
+    size_t getCapacity() const noexcept { return capacity; }
+    void setCapacity(size_t newCapacity){
+        capacity = newCapacity;
+        if(errors.size() > capacity){
+            numDropped += errors.size() - capacity;
+            errors.resize(capacity);
+        }
+    }
+    void clear() noexcept {
+        errors.clear();
+        numDropped = 0;
+    }
+};
+
+
 // CSV Reader: strictly for reading CSV files
 class Reader{
 private:
     std::ifstream file; // Input file stream
     std::string path;   // Path to CSV file
     std::vector<std::string> header; // CSV header row
-    char delimiter;     // Delimiter character (default ',')
+    std::string delimiter; // Delimiter, one or more characters (default ",")
+    char quoteChar;     // Quote character (default '"')
+    bool collapseWhitespace; // Runs of spaces/tabs form one separator
+    LineEnding lineEnding; // Row terminator (CR files are split on '\r')
     uint32 rowNumber;   // Current row number (0-based)
     uint32 numRows;     // Total number of rows in file
+    uint64 rowOffset;   // Byte offset just past the last complete row (follow mode)
+    bool lenient;       // Record malformed rows and skip them instead of throwing
+    size_t maxRowBytes; // Longest row an open quote may span in lenient mode
+    ErrorSink errorSink; // Malformed rows seen in lenient mode
+    uint64 rowsAccepted; // Rows returned by readRow()
+    uint64 rowsRejected; // Rows skipped as malformed (lenient mode)
     std::function<void(const std::string&)> warningCallback; // Warning callback
+    std::string viewLine; // Line buffer behind readRowView() fields, reused between rows
+    std::vector<std::string> viewFields; // Unescaped fields of quoted rows for readRowView()
     
     // Internal parsing helpers
     void parseString(const std::string& lineStr, std::vector<std::string>& fields) const;
-    void parseString(const std::string& lineStr, std::vector<std::string>& fields, char delim) const;
+    void parseString(const std::string& lineStr, std::vector<std::string>& fields, std::string_view delim) const;
+    std::optional<std::vector<std::string>> readNextRow(std::string_view delim); // Shared body of the readRow() overloads
+    std::optional<std::vector<std::string>> readRowLenient(std::string_view delim); // readRow() for lenient mode
     void setNumLines(uint32 numRows); // Set total number of lines
-    friend class ReaderWriter; // Allow ReaderWriter access
+    char lineBreak() const noexcept { return lineEnding == LineEnding::CR ? '\r' : '\n'; } // Character that ends a physical line
+    void waitForGrowth(int watchDescriptor, uint32 pollIntervalMs); // Block until file changes or interval passes
     
 public:
     Reader(char delimiter = ',', uint32 startRow = 0)
+    :   Reader(std::string(1, delimiter), startRow)
+    {}
+    Reader(const std::string& delimiter, uint32 startRow = 0) // Multi-character delimiter, e.g. "::"
     :   delimiter(delimiter),
+        quoteChar('"'),
+        collapseWhitespace(false),
+        lineEnding(LineEnding::LF),
         rowNumber(startRow),
-        numRows(0)
+        numRows(0),
+        rowOffset(0),
+        lenient(false),
+        maxRowBytes(64 * 1024),
+        rowsAccepted(0),
+        rowsRejected(0)
     {}
+    Reader(const Dialect& dialect, uint32 startRow = 0)
+    :   Reader(dialect.delimiter, startRow)
+    {
+        setDialect(dialect);
+    }
     ~Reader() = default;
     
     void setWarningCallback(const std::function<void(const std::string&)>& cb) {
@@ -256,6 +386,7 @@ public:
     // Row reading
     std::optional<std::vector<std::string>> readRow(); // Read next row
     std::optional<std::vector<std::string>> readRow(char delim); // Read next row with custom delimiter
+    bool readRowView(std::vector<std::string_view>& fields); // Read next row as views into a reused buffer (valid until the next read); false at EOF
     // Read all rows
     table::Table readAll();
     table::Table readAll(char delim);
@@ -266,14 +397,33 @@ public:
     std::vector<std::string> getColumn(const std::string& columnName); // Get entire column by name
     
     // Delimiter access
-    char getDelimiter() const;
+    char getDelimiter() const; // First character of the delimiter
+    const std::string& getDelimiterString() const; // Full (possibly multi-character) delimiter
     void setDelimiter(char delim);
+    void setDelimiter(const std::string& delim);
+    
+    // Dialect access (delimiter, quote character, whitespace handling and line ending)
+    void setDialect(const Dialect& dialect); // Apply a dialect, e.g. from sniffDialect()
+    Dialect getDialect() const;
     
     // Row navigation
     uint32 getRowNumber() const; // Get current row number
     void setRowNumber(uint32 targetRow); // Jump to specific row
     void skipLines(uint32 count); // Skip lines
     uint32 getNumRows() const; // Get total number of rows
+    
+    // Follow (tail) mode for append-only files
+    std::optional<std::vector<std::string>> readAppendedRow(); // Read next complete row, partial rows are left unread
+    uint32 follow(const std::function<bool(const std::vector<std::string>&)>& callback, uint32 pollIntervalMs = 10, uint32 idleTimeoutMs = 0); // Deliver appended rows until callback returns false
+    uint64 getRowOffset() const; // Byte offset just past the last complete row
+    
+    // Lenient mode: malformed rows are recorded in the error sink and skipped
+    void setLenient(bool enable, size_t maxErrors = 1000, size_t maxRowBytes = 64 * 1024); // Enable/disable lenient parsing
+    bool isLenient() const noexcept;
+    const ErrorSink& getErrorSink() const noexcept; // Recorded malformed rows
+    uint64 getRowsAccepted() const noexcept; // Rows returned by readRow()
+    uint64 getRowsRejected() const noexcept; // Rows skipped as malformed
+    void resetParseStats() noexcept; // Clear counters and recorded errors
 };
 
 // CSV Writer: strictly for writing CSV files
@@ -325,31 +475,68 @@ public:
     uint32 getNumRows() const; // Get total number of rows written
 };
 
-// CSV ReaderWriter: combined reading and writing on the same file
+// CSV ReaderWriter: combined reading and writing on the same file.
+// Uses a single file handle and an in-memory copy of the file with a row
+// offset index, so written rows are visible to reads immediately and row
+// navigation is O(1). The whole file is held in memory, so it suits files
+// that fit comfortably in RAM; stream larger ones with Reader. Rows are split
+// by the same parser as Reader (delimiter, quote character and whitespace
+// runs from setDialect()), but there is no lenient mode: a malformed row
+// throws ParseException.
 class ReaderWriter{
 private:
-    Reader reader; // Internal Reader instance
-    Writer writer; // Internal Writer instance
+    std::fstream file;  // Single read/write file stream
+    std::string path;   // Path to CSV file
+    std::string buffer; // In-memory copy of the file contents
+    std::vector<uint64> rowOffsets; // Byte offset of the start of each row in buffer
+    std::vector<std::string> header; // CSV header row
+    std::string delimiter; // Delimiter, one or more characters (default ",")
+    char quoteChar;     // Quote character (default '"')
+    bool collapseWhitespace; // Runs of spaces/tabs form one separator
+    LineEnding lineEnding; // Row terminator, also used for appended rows
+    uint32 rowNumber;   // Read cursor: next row to be read (0-based)
     std::function<void(const std::string&)> warningCallback; // Warning callback
     
+    // Internal helpers
+    void indexRows(uint64 fromOffset); // Record row starts in buffer from fromOffset onward
+    std::string_view rowView(uint32 row) const; // Raw bytes of a row, including its newline
+    void parseString(std::string_view lineStr, std::vector<std::string>& fields, std::string_view delim, uint32 row) const;
+    std::string formatRow(const std::vector<std::string>& row, std::string_view delim) const; // Quote/escape and join a row
+    std::optional<std::vector<std::string>> readNextRow(std::string_view delim); // Shared body of the readRow() overloads
+    table::Table readAllRows(std::string_view delim); // Shared body of the readAll() overloads
+    void appendTable(const table::Table& t, std::string_view delim); // Shared body of the writeAll() overloads
+    void append(const std::string& rows); // Append pre-formatted rows in a single write
+    void overwrite(uint32 row, const std::string& formattedRow); // Replace a row of identical byte width
+    char lineBreak() const noexcept { return lineEnding == LineEnding::CR ? '\r' : '\n'; } // Character that ends a row
+    const char* lineEndingText() const noexcept { return lineEnding == LineEnding::CRLF ? "\r\n" : (lineEnding == LineEnding::CR ? "\r" : "\n"); }
+    
 public:
     ReaderWriter(char delimiter = ',', uint32 startLine = 0)
-    :   reader(delimiter, startLine),
-        writer(delimiter)
+    :   ReaderWriter(std::string(1, delimiter), startLine)
     {}
+    ReaderWriter(const std::string& delimiter, uint32 startLine = 0) // Multi-character delimiter, e.g. "::"
+    :   delimiter(delimiter),
+        quoteChar('"'),
+        collapseWhitespace(false),
+        lineEnding(LineEnding::LF),
+        rowNumber(startLine)
+    {}
+    ReaderWriter(const Dialect& dialect, uint32 startLine = 0)
+    :   ReaderWriter(dialect.delimiter, startLine)
+    {
+        setDialect(dialect);
+    }
     ~ReaderWriter() = default;
     
-    // Set warning callback for both reader and writer
+    // Set warning callback
     void setWarningCallback(const std::function<void(const std::string&)>& cb) {
         warningCallback = cb;
-        reader.setWarningCallback(cb);
-        writer.setWarningCallback(cb);
     }
     
     // File operations
-    void open(const std::string& filePath, uint32 rowNumber = 0); // Open file for reading/writing
+    void open(const std::string& filePath, uint32 rowNumber = 0); // Open existing file for reading/writing
     bool isOpen() const noexcept; // Is file open?
-    bool isEOF() const; // End of file reached?
+    bool isEOF() const; // Read cursor past last row?
     void close() noexcept; // Close file
     
     // Header operations
@@ -368,23 +555,31 @@ public:
     table::Table readAll();
     table::Table readAll(char delim);
     
-    // Row writing
-    void writeRow(const std::vector<std::string>& row); // Write a row
-    void writeRow(const std::vector<std::string>& row, char delim); // Write a row with custom delimiter
-    void writeAll(const table::Table& t); // Write all rows
-    void writeAll(const table::Table& t, char delim); // Write all rows with custom delimiter
+    // Row writing (appends are all-or-nothing: a failed write never leaves a partial row)
+    void writeRow(const std::vector<std::string>& row); // Append a row
+    void writeRow(const std::vector<std::string>& row, char delim); // Append a row with custom delimiter
+    void writeAll(const table::Table& t); // Append all rows
+    void writeAll(const table::Table& t, char delim); // Append all rows with custom delimiter
+    void updateRow(uint32 rowNumber, const std::vector<std::string>& row); // Overwrite a row in place (same byte width)
+    void updateRow(uint32 rowNumber, const std::vector<std::string>& row, char delim); // As above with custom delimiter
     void flush(); // Flush output
     
     // Delimiter access
-    char getDelimiter() const;
+    char getDelimiter() const; // First character of the delimiter
+    const std::string& getDelimiterString() const; // Full (possibly multi-character) delimiter
     void setDelimiter(char delim);
+    void setDelimiter(const std::string& delim);
+    
+    // Dialect access (delimiter, quote character, whitespace handling and line ending)
+    void setDialect(const Dialect& dialect); // Apply a dialect before or after open(); rows are re-indexed
+    Dialect getDialect() const;
     
     // Row navigation
     uint32 getReaderLine() const; // Get current reader line
     uint32 getNumRows() const; // Get total number of rows
     void setReaderLine(uint32 targetRow); // Jump to specific reader line
     void skipLines(uint32 count); // Skip lines
-    uint32 getWriterLine() const; // Get current writer line
+    uint32 getWriterLine() const; // Get current writer line (row index of the next append)
 };
 
 
@@ -400,12 +595,44 @@ inline bool Reader::isHeaderSet() const{
 inline char Reader::getDelimiter() const{
     if(!isOpen()) throw ReaderClosedException();
     std::cout << COLOUR_BLACK;
+    return delimiter.front();
+}
+
+inline const std::string& Reader::getDelimiterString() const{
+    if(!isOpen()) throw ReaderClosedException();
     return delimiter;
 }
 
 inline void Reader::setDelimiter(char delim){
     if(!isOpen()) throw ReaderClosedException();
-    delimiter = delim; 
+    delimiter.assign(1, delim); 
+}
+
+inline void Reader::setDelimiter(const std::string& delim){
+    if(!isOpen()) throw ReaderClosedException();
+    if(delim.empty()) throw error::FatalException("Delimiter must contain at least one character.");
+    delimiter = delim;
+}
+
+// Unlike setDelimiter(), usable before open() so a sniffed dialect can be
+// applied up front; set it before open() when the line ending changes, so
+// getNumRows() counts the right lines. hasHeader is informational: call
+// setHeader(0) to use it.
+inline void Reader::setDialect(const Dialect& dialect){
+    delimiter.assign(1, dialect.delimiter);
+    quoteChar = dialect.quoteChar;
+    collapseWhitespace = dialect.collapseWhitespace;
+    lineEnding = dialect.lineEnding;
+}
+
+inline Dialect Reader::getDialect() const{
+    Dialect dialect;
+    dialect.delimiter = delimiter.front();
+    dialect.quoteChar = quoteChar;
+    dialect.hasHeader = !header.empty();
+    dialect.lineEnding = lineEnding;
+    dialect.collapseWhitespace = collapseWhitespace;
+    return dialect;
 }
 
 inline uint32 Reader::getNumRows() const{
@@ -439,13 +666,13 @@ inline void Reader::setRowNumber(uint32 targetRow){
         file.seekg(0, std::ios::beg);
         rowNumber = 0;  // reset after rewind
         
-        for (uint32 i = 0; i < targetRow; ++i) {
+        while (rowNumber < targetRow) { // rejected rows in lenient mode also advance rowNumber
             auto maybeRow = readRow();
             if (!maybeRow) throw InvalidLineException(targetRow, numRows, path);
             // row number is already incremented by readRow()
         }
     }else{ // if row number < targetRow
-        for (uint32 i = rowNumber; i < targetRow; ++i) {
+        while (rowNumber < targetRow) {
             auto maybeRow = readRow();
             if (!maybeRow) {
                 if(file.eof()) return;
@@ -478,11 +705,14 @@ inline void Reader::open(const std::string& filePath, uint32 startLine){
     
     file.open(filePath, std::ios::in);
     if(!file.is_open()) throw FileOpenFailureException(filePath);
-    numRows = countLines(filePath);
+    numRows = countLines(filePath, lineBreak());
     
     if (startLine > 0){
         skipLines(startLine);
     }else rowNumber = 0;
+    
+    file.clear();
+    rowOffset = static_cast<uint64>(file.tellg());
 }
 
 inline void Reader::setHeader(uint32 headerRow){
@@ -497,101 +727,12 @@ inline void Reader::setHeader(uint32 headerRow){
     setRowNumber(originalLine);
 }
 
-// Add this implementation before Reader::readRow() (around row number 272):
 inline void Reader::parseString(const std::string& lineStr, std::vector<std::string>& fields) const {
-    fields.clear();
-    fields.reserve(10);
-    
-    std::string field;
-    field.reserve(64);
-    bool inQuotes = false;
-    bool lastWasQuote = false;
-    
-    for(size_t i = 0; i < lineStr.size(); ++i){
-        char c = lineStr[i];
-        
-        if(inQuotes){
-            if(c == '"'){
-                if(lastWasQuote){
-                    field += '"';
-                    lastWasQuote = false;
-                }else lastWasQuote = true;
-            }else if(lastWasQuote){
-                inQuotes = false;
-                lastWasQuote = false;
-                
-                if(c == delimiter){
-                    fields.push_back(std::move(field));
-                    field.clear();
-                    field.reserve(64);
-                }else field += c;
-            }else field += c;
-        }else{
-            if(c == '"'){
-                inQuotes = true;
-            }else if(c == delimiter){
-                fields.push_back(std::move(field));
-                field.clear();
-                field.reserve(64);
-            }else field += c;
-        }
-    }
-    
-    fields.push_back(std::move(field));
-    if(inQuotes && !lastWasQuote) throw ParseException(rowNumber, path);
-    
-    // Trim trailing newlines
-    for(auto& f : fields) {
-        while(!f.empty() && (f.back() == '\n' || f.back() == '\r')) f.pop_back();
-    }
+    parseString(lineStr, fields, delimiter);
 }
 
-inline void Reader::parseString(const std::string& lineStr, std::vector<std::string>& fields, char delim) const {
-    fields.clear();
-    fields.reserve(10);
-
-    std::string field;
-    field.reserve(64);
-    bool inQuotes = false;
-    bool lastWasQuote = false;
-
-    for(size_t i = 0; i < lineStr.size(); ++i){
-        char c = lineStr[i];
-
-        if(inQuotes){
-            if(c == '"'){
-                if(lastWasQuote){
-                    field += '"';
-                    lastWasQuote = false;
-                }else lastWasQuote = true;
-            }else if(lastWasQuote){
-                inQuotes = false;
-                lastWasQuote = false;
-
-                if(c == delim){
-                    fields.push_back(std::move(field));
-                    field.clear();
-                    field.reserve(64);
-                }else field += c;
-            }else field += c;
-        }else{
-            if(c == '"'){
-                inQuotes = true;
-            }else if(c == delim){
-                fields.push_back(std::move(field));
-                field.clear();
-                field.reserve(64);
-            }else field += c;
-        }
-    }
-
-    fields.push_back(std::move(field));
-    if(inQuotes && !lastWasQuote) throw ParseException(rowNumber, path);
-
-    // Trim trailing newlines
-    for(auto& f : fields) {
-        while(!f.empty() && (f.back() == '\n' || f.back() == '\r')) f.pop_back();
-    }
+inline void Reader::parseString(const std::string& lineStr, std::vector<std::string>& fields, std::string_view delim) const {
+    if(!parseFields(lineStr, fields, delim, quoteChar, collapseWhitespace)) throw ParseException(rowNumber, path);
 }
 
 inline std::vector<std::string> Reader::getColumn(const std::string& columnName){
@@ -614,11 +755,11 @@ inline std::string Reader::getFieldByType(const std::vector<std::string>& row, c
 
     for(size_t i = 0; i < header.size(); i++){
         if(header[i] == columnName){
-            if(i >= row.size()) throw ShortRowException(path, header, row.size(), delimiter);
+            if(i >= row.size()) throw ShortRowException(path, header, row.size(), delimiter.front());
             return row[i];
         }
     }
-    throw SchemaMismatchException(path, columnName, header, delimiter);
+    throw SchemaMismatchException(path, columnName, header, delimiter.front());
 }
 
 inline std::string Reader::getFieldByType(uint32 rowNumber, const std::string& columnName) {
@@ -634,103 +775,121 @@ inline std::string Reader::getFieldByType(uint32 rowNumber, const std::string& c
     const std::vector<std::string>& row2 = *row;
     for(size_t i = 0; i < header.size(); i++){
         if(header[i] == columnName){
-            if(i >= row2.size()) throw ShortRowException(path, header, row2.size(), delimiter);
+            if(i >= row2.size()) throw ShortRowException(path, header, row2.size(), delimiter.front());
             return row2[i];
         }
     }
-    throw SchemaMismatchException(path, columnName, header, delimiter);
+    throw SchemaMismatchException(path, columnName, header, delimiter.front());
 }
 
-inline std::optional<std::vector<std::string>> Reader::readRow(){        
+inline std::optional<std::vector<std::string>> Reader::readRow(){
     if(!isOpen()) throw ReaderClosedException();
+    return readNextRow(delimiter);
+}
+
+inline std::optional<std::vector<std::string>> Reader::readRow(char delim){
+    if(!isOpen()) throw ReaderClosedException();
+    return readNextRow(std::string_view(&delim, 1));
+}
+
+// Reads whole physical lines with std::getline (a buffered scan for the line break)
+// rather than one get() per character. A row continues onto the next line
+// while it holds an odd number of quote characters, i.e. a quoted field with
+// an embedded newline is still open; escaped ("") quotes keep the parity.
+inline std::optional<std::vector<std::string>> Reader::readNextRow(std::string_view delim){
+    if(lenient) return readRowLenient(delim);
     
     std::vector<std::string> RETURNvector;
     std::string lineStr;
-    bool inQuotes = false;
-    char c;
     
-    // Read characters until we have a complete CSV row
-    while(file.get(c)){
-        lineStr += c;
-        
-        // Track quote state to detect multi-row fields
-        if(c == '"'){
-            // Check if it's an escaped quote
-            if(file.peek() == '"') lineStr += file.get();  // consume the second quote
-            else inQuotes = !inQuotes;  // toggle quote state
-        }
-        
-        // If we hit a newline outside quotes, we have a complete row
-        if(c == '\n' && !inQuotes){
-            rowNumber++;
-            parseString(lineStr, RETURNvector, delimiter);
-            
-            if (!header.empty() && RETURNvector.size() < header.size()) throw ShortRowException(path, header, RETURNvector.size(), delimiter);
-            return RETURNvector;
+    if(!std::getline(file, lineStr, lineBreak())){
+        if(file.eof()){
+            if (warningCallback) warningCallback("Reached EOF while reading rowNumber.");
+            return std::nullopt; // null vector
         }
+        throw readRowException(rowNumber, path);
     }
     
-    // Loop exited - check why
-    if(file.eof()){
-        // End of file - process any remaining content (last row without newline)
-        if(!lineStr.empty()){
-            rowNumber++;
-            parseString(lineStr, RETURNvector, delimiter);
-            
-            if(!header.empty() && RETURNvector.size() < header.size()) throw ShortRowException(path, header, RETURNvector.size(), delimiter);
-            return RETURNvector;
-        }
-        if (warningCallback) warningCallback("Reached EOF while reading rowNumber.");
-        return std::nullopt; // null vector
+    size_t quotes = static_cast<size_t>(std::count(lineStr.begin(), lineStr.end(), quoteChar));
+    std::string continuation;
+    while(quotes % 2 == 1 && std::getline(file, continuation, lineBreak())){
+        lineStr += lineBreak();
+        lineStr += continuation;
+        quotes += static_cast<size_t>(std::count(continuation.begin(), continuation.end(), quoteChar));
     }
     
-    throw readRowException(rowNumber, path);
+    rowNumber++;
+    parseString(lineStr, RETURNvector, delim);
+    
+    if(!header.empty() && RETURNvector.size() < header.size()) throw ShortRowException(path, header, RETURNvector.size(), delim.front());
+    rowsAccepted++;
+    return RETURNvector;
 }
 
-inline std::optional<std::vector<std::string>> Reader::readRow(char delim){        
+// Same rows as readRow() without building a string per field: the line is read into
+// a buffer kept between calls and unquoted rows are split in place, so a numeric
+// file can be parsed with no allocation per row. Quoted rows are unescaped into
+// strings the reader reuses. The views are invalidated by the next read.
+inline bool Reader::readRowView(std::vector<std::string_view>& fields){
     if(!isOpen()) throw ReaderClosedException();
+    fields.clear();
     
-    std::vector<std::string> RETURNvector;
-    std::string lineStr;
-    bool inQuotes = false;
-    char c;
+    if(lenient){
+        auto row = readRowLenient(delimiter);
+        if(!row) return false;
+        viewFields = std::move(*row);
+        fields.assign(viewFields.begin(), viewFields.end());
+        return true;
+    }
     
-    // Read characters until we have a complete CSV row
-    while(file.get(c)){
-        lineStr += c;
-        
-        // Track quote state to detect multi-row fields
-        if(c == '"'){
-            // Check if it's an escaped quote
-            if(file.peek() == '"') lineStr += file.get();  // consume the second quote
-            else inQuotes = !inQuotes;  // toggle quote state
-        }
-        
-        // If we hit a newline outside quotes, we have a complete row
-        if(c == '\n' && !inQuotes){
-            rowNumber++;
-            parseString(lineStr, RETURNvector, delim);
-            
-            if (!header.empty() && RETURNvector.size() < header.size()) throw ShortRowException(path, header, RETURNvector.size(), delim);
-            return RETURNvector;
+    if(!std::getline(file, viewLine, lineBreak())){
+        if(file.eof()){
+            if (warningCallback) warningCallback("Reached EOF while reading rowNumber.");
+            return false;
         }
+        throw readRowException(rowNumber, path);
     }
     
-    // Loop exited - check why
-    if(file.eof()){
-        // End of file - process any remaining content (last rowNumber without newline)
-        if(!lineStr.empty()){
-            rowNumber++;
-            parseString(lineStr, RETURNvector, delim);
-            
-            if(!header.empty() && RETURNvector.size() < header.size()) throw ShortRowException(path, header, RETURNvector.size(), delim);
-            return RETURNvector;
+    if(viewLine.find(quoteChar) == std::string::npos){
+        std::string_view line(viewLine);
+        if(!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        
+        if(collapseWhitespace){
+            static constexpr const char* whitespace = " \t\r";
+            size_t start = line.find_first_not_of(whitespace);
+            while(start != std::string_view::npos){
+                size_t end = line.find_first_of(whitespace, start);
+                if(end == std::string_view::npos) end = line.size();
+                fields.push_back(line.substr(start, end - start));
+                start = line.find_first_not_of(whitespace, end);
+            }
+            if(fields.empty()) fields.emplace_back();
+        }else{
+            size_t start = 0;
+            while(true){
+                size_t end = (delimiter.size() == 1) ? line.find(delimiter.front(), start) : line.find(delimiter, start);
+                if(end == std::string_view::npos) break;
+                fields.push_back(line.substr(start, end - start));
+                start = end + delimiter.size();
+            }
+            fields.push_back(line.substr(start));
         }
-        if (warningCallback) warningCallback("Reached EOF while reading rowNumber.");
-        return std::nullopt; // null vector
+    }else{
+        size_t quotes = static_cast<size_t>(std::count(viewLine.begin(), viewLine.end(), quoteChar));
+        std::string continuation;
+        while(quotes % 2 == 1 && std::getline(file, continuation, lineBreak())){
+            viewLine += lineBreak();
+            viewLine += continuation;
+            quotes += static_cast<size_t>(std::count(continuation.begin(), continuation.end(), quoteChar));
+        }
+        parseString(viewLine, viewFields, delimiter);
+        fields.assign(viewFields.begin(), viewFields.end());
     }
     
-    throw readRowException(rowNumber, path);
+    rowNumber++;
+    if(!header.empty() && fields.size() < header.size()) throw ShortRowException(path, header, fields.size(), delimiter.front());
+    rowsAccepted++;
+    return true;
 }
 
 inline table::Table Reader::readAll(){
@@ -785,6 +944,250 @@ inline table::Table Reader::readAll(char delim){
     return table::Table(std::move(t));
 }
 
+inline void Reader::setLenient(bool enable, size_t maxErrors, size_t maxRowBytes){
+    lenient = enable;
+    errorSink.setCapacity(maxErrors);
+    this->maxRowBytes = maxRowBytes;
+}
+
+inline bool Reader::isLenient() const noexcept { return lenient; }
+inline const ErrorSink& Reader::getErrorSink() const noexcept { return errorSink; }
+inline uint64 Reader::getRowsAccepted() const noexcept { return rowsAccepted; }
+inline uint64 Reader::getRowsRejected() const noexcept { return rowsRejected; }
+
+inline void Reader::resetParseStats() noexcept {
+    errorSink.clear();
+    rowsAccepted = 0;
+    rowsRejected = 0;
+}
+
+// Reads rows until a well-formed one is found. Malformed rows are recorded in
+// the error sink (no exception or message string is built) and reading
+// resumes at the next row boundary. A quote only opens a quoted field at the
+// start of a field; anywhere else it is a stray quote and rejects the row
+// without swallowing the lines that follow it. An opening quote is followed
+// for at most maxRowBytes, so a stray one costs bounded work, not a scan to EOF.
+inline std::optional<std::vector<std::string>> Reader::readRowLenient(std::string_view delim){
+    std::vector<std::string> RETURNvector;
+    std::string lineStr;
+    char c;
+    
+    std::streamoff startOffset = file.tellg(); // one position query per call, then tracked by length
+    uint64 rowStart = startOffset < 0 ? 0 : static_cast<uint64>(startOffset);
+    
+    while(true){
+        lineStr.clear();
+        bool inQuotes = false;
+        bool fieldStart = true;
+        bool afterQuote = false;
+        bool malformed = false;
+        ParseErrorReason reason = ParseErrorReason::StrayQuote;
+        bool rowEnded = false;
+        bool overLong = false;
+        
+        while(file.get(c)){
+            lineStr += c;
+            
+            if(inQuotes){
+                if(c == quoteChar){
+                    if(file.peek() == quoteChar) lineStr += static_cast<char>(file.get()); // escaped quote
+                    else{
+                        inQuotes = false;
+                        afterQuote = true;
+                    }
+                }else if(lineStr.size() > maxRowBytes){
+                    overLong = true;
+                    break;
+                }
+                continue;
+            }
+            
+            if(c == lineBreak()){
+                rowEnded = true;
+                break;
+            }
+            bool atDelimiter = collapseWhitespace
+                ? (c == ' ' || c == '\t')
+                : (c == delim.back() && lineStr.size() >= delim.size() && lineStr.compare(lineStr.size() - delim.size(), delim.size(), delim) == 0);
+            if(atDelimiter){
+                fieldStart = true;
+                afterQuote = false;
+                continue;
+            }
+            if(afterQuote && c != '\r' && delim.find(c) == std::string_view::npos && !malformed){ // allow a multi-character delimiter to build up
+                malformed = true;
+                reason = ParseErrorReason::TextAfterQuote;
+            }
+            if(c == quoteChar){
+                if(fieldStart) inQuotes = true;
+                else if(!malformed){
+                    malformed = true;
+                    reason = ParseErrorReason::StrayQuote;
+                }
+            }
+            fieldStart = false;
+        }
+        
+        if(!rowEnded && !overLong){
+            if(!file.eof()) throw readRowException(rowNumber, path);
+            if(lineStr.empty()){
+                if (warningCallback) warningCallback("Reached EOF while reading rowNumber.");
+                return std::nullopt;
+            }
+        }
+        if(inQuotes){
+            // Quote left open at EOF or past maxRowBytes: reject only its
+            // first physical line and resynchronise after it
+            size_t lineEnd = lineStr.find(lineBreak());
+            errorSink.record(rowNumber, rowStart, ParseErrorReason::UnterminatedQuote);
+            rowsRejected++;
+            rowNumber++;
+            
+            file.clear();
+            if(lineEnd != std::string::npos){
+                rowStart += lineEnd + 1;
+                file.seekg(static_cast<std::streamoff>(rowStart), std::ios::beg);
+            }else{
+                if(!overLong || !file.ignore(std::numeric_limits<std::streamsize>::max(), lineBreak()) || file.eof()) return std::nullopt;
+                rowStart = static_cast<uint64>(file.tellg());
+            }
+            continue;
+        }
+        
+        uint64 rowLength = lineStr.size();
+        if(!malformed){
+            parseString(lineStr, RETURNvector, delim);
+            if(header.empty() || RETURNvector.size() >= header.size()){
+                rowNumber++;
+                rowsAccepted++;
+                return RETURNvector;
+            }
+            reason = ParseErrorReason::ShortRow;
+        }
+        
+        errorSink.record(rowNumber, rowStart, reason);
+        rowsRejected++;
+        rowNumber++;
+        rowStart += rowLength;
+    }
+}
+
+inline uint64 Reader::getRowOffset() const{
+    if(!isOpen()) throw ReaderClosedException();
+    return rowOffset;
+}
+
+// Like readRow(), but a final row without its terminating newline is treated as
+// still being written: the stream is rewound to the start of that row and
+// std::nullopt is returned, so the row is read in full on a later call.
+inline std::optional<std::vector<std::string>> Reader::readAppendedRow(){
+    if(!isOpen()) throw ReaderClosedException();
+    
+    file.clear(); // previous calls may have hit EOF
+    std::streampos rowStart = file.tellg();
+    
+    std::vector<std::string> RETURNvector;
+    std::string lineStr;
+    std::string part;
+    size_t quotes = 0;
+    
+    // getline() sets eofbit when a line has no terminating newline yet; such a
+    // line, or a quoted field still open at EOF, is an incomplete row
+    while(std::getline(file, part, lineBreak()) && !file.eof()){
+        lineStr += part;
+        quotes += static_cast<size_t>(std::count(part.begin(), part.end(), quoteChar));
+        
+        if(quotes % 2 == 0){
+            rowNumber++;
+            if(rowNumber > numRows) numRows = rowNumber;
+            rowOffset = static_cast<uint64>(file.tellg());
+            parseString(lineStr, RETURNvector, delimiter);
+            
+            if (!header.empty() && RETURNvector.size() < header.size()) throw ShortRowException(path, header, RETURNvector.size(), delimiter.front());
+            rowsAccepted++;
+            return RETURNvector;
+        }
+        lineStr += lineBreak();
+    }
+    
+    if(!file.eof()) throw readRowException(rowNumber, path);
+    
+    // Incomplete (or no) row: rewind so the partial row is re-read once finished
+    file.clear();
+    file.seekg(rowStart);
+    
+    // File shrank below the last complete row: it was truncated or replaced
+    std::error_code ec;
+    uint64 fileSize = std::filesystem::file_size(path, ec);
+    if(!ec && fileSize < static_cast<uint64>(rowStart)){
+        if (warningCallback) warningCallback("File truncated while following, restarting from row 0.");
+        file.seekg(0, std::ios::beg);
+        rowNumber = 0;
+        rowOffset = 0;
+    }
+    return std::nullopt;
+}
+
+inline void Reader::waitForGrowth(int watchDescriptor, uint32 pollIntervalMs){
+#ifdef __linux__
+    if(watchDescriptor >= 0){
+        pollfd pfd{watchDescriptor, POLLIN, 0};
+        if(::poll(&pfd, 1, static_cast<int>(pollIntervalMs)) > 0){
+            // Drain pending events; only the wake-up matters, not their contents
+            alignas(inotify_event) char events[4096];
+            while(::read(watchDescriptor, events, sizeof(events)) > 0) {}
+        }
+        return;
+    }
+#else
+    (void)watchDescriptor;
+#endif
+    std::this_thread::sleep_for(std::chrono::milliseconds(pollIntervalMs));
+}
+
+// Blocks, handing each newly appended complete row to callback. Growth is
+// detected with inotify on Linux (falling back to polling every
+// pollIntervalMs), so rows are delivered within milliseconds of being written.
+// Returns the number of rows delivered once callback returns false or, if
+// idleTimeoutMs is non-zero, once no new row has arrived for that long.
+inline uint32 Reader::follow(const std::function<bool(const std::vector<std::string>&)>& callback, uint32 pollIntervalMs, uint32 idleTimeoutMs){
+    if(!isOpen()) throw ReaderClosedException();
+    
+    // Closes the inotify descriptor on every exit path
+    struct WatchGuard{
+        int fd = -1;
+        ~WatchGuard(){
+#ifdef __linux__
+            if(fd >= 0) ::close(fd);
+#endif
+        }
+    } watch;
+    
+#ifdef __linux__
+    watch.fd = ::inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if(watch.fd >= 0 && ::inotify_add_watch(watch.fd, path.c_str(), IN_MODIFY | IN_CLOSE_WRITE | IN_ATTRIB) < 0){
+        ::close(watch.fd);
+        watch.fd = -1;
+    }
+    if(watch.fd < 0 && warningCallback) warningCallback("inotify unavailable, falling back to polling.");
+#endif
+    
+    uint32 delivered = 0;
+    auto lastRowTime = std::chrono::steady_clock::now();
+    
+    while(true){
+        while(auto row = readAppendedRow()){
+            delivered++;
+            lastRowTime = std::chrono::steady_clock::now();
+            if(!callback(*row)) return delivered;
+        }
+        
+        if(idleTimeoutMs > 0 && std::chrono::steady_clock::now() - lastRowTime >= std::chrono::milliseconds(idleTimeoutMs))
+            return delivered;
+        waitForGrowth(watch.fd, pollIntervalMs);
+    }
+}
+
 inline bool Reader::isEOF() const{
     if(!isOpen()) throw ReaderClosedException();
     return file.eof();                 // check the underlying stream
@@ -795,6 +1198,7 @@ inline void Reader::close() noexcept {
     
     header.clear();    // clear header vector
     rowNumber = 0;          // reset rowNumber counter
+    rowOffset = 0;     // reset follow offset
     path.clear();      // clear stored file path
 }
 
@@ -947,149 +1351,681 @@ inline void Writer::close() noexcept {
 
 //  === READERWRITER METHODS ===
 
-inline bool ReaderWriter::isOpen() const noexcept { return (reader.isOpen() && writer.isOpen()); }
+inline bool ReaderWriter::isOpen() const noexcept { return file.is_open(); }
+
+inline void ReaderWriter::open(const std::string& filePath, uint32 startLine){
+    if(file.is_open()) close();
+    
+    file.open(filePath, std::ios::in | std::ios::out | std::ios::binary);
+    if(!file.is_open()) throw FileOpenFailureException(filePath);
+    path = filePath;
+    
+    // Load the whole file once; all reads are served from this buffer
+    file.seekg(0, std::ios::end);
+    std::streamoff size = file.tellg();
+    file.seekg(0, std::ios::beg);
+    buffer.assign(static_cast<size_t>(size), '\0');
+    if(size > 0 && !file.read(buffer.data(), size)){
+        close();
+        throw readRowException(filePath);
+    }
+    file.clear();
+    
+    indexRows(0);
+    
+    if(startLine > rowOffsets.size()){
+        if (warningCallback) warningCallback("Reached EOF before skipping all requested lines.");
+        startLine = static_cast<uint32>(rowOffsets.size());
+    }
+    rowNumber = startLine;
+}
+
+inline void ReaderWriter::indexRows(uint64 fromOffset){
+    // A row ends at a newline outside quotes; quote state resets at each row
+    // start, and doubled quotes toggle twice so need no special handling.
+    bool inQuotes = false;
+    bool rowStarted = false;
+    
+    for(uint64 i = fromOffset; i < buffer.size(); ++i){
+        if(!rowStarted){
+            rowOffsets.push_back(i);
+            rowStarted = true;
+        }
+        char c = buffer[i];
+        if(c == quoteChar) inQuotes = !inQuotes;
+        else if(c == lineBreak() && !inQuotes) rowStarted = false;
+    }
+}
+
+inline std::string_view ReaderWriter::rowView(uint32 row) const{
+    uint64 start = rowOffsets[row];
+    uint64 end = (row + 1 < rowOffsets.size()) ? rowOffsets[row + 1] : buffer.size();
+    return std::string_view(buffer.data() + start, end - start);
+}
+
+inline void ReaderWriter::parseString(std::string_view lineStr, std::vector<std::string>& fields, std::string_view delim, uint32 row) const {
+    if(!parseFields(lineStr, fields, delim, quoteChar, collapseWhitespace)) throw ParseException(row + 1, path);
+}
+
+inline std::string ReaderWriter::formatRow(const std::vector<std::string>& row, std::string_view delim) const {
+    std::string line;
+    
+    for(size_t i = 0; i < row.size(); ++i){
+        if(i > 0) line += delim;
+        const std::string& field = row[i];
+        
+        // Quote and escape per RFC 4180 when the field contains special characters
+        // (for whitespace-run dialects also blanks, and empty fields, which would vanish)
+        bool needsQuotes = (field.find(delim) != std::string::npos
+                            || field.find_first_of("\r\n") != std::string::npos
+                            || field.find(quoteChar) != std::string::npos
+                            || (collapseWhitespace && (field.empty() || field.find_first_of(" \t") != std::string::npos)));
+        if(!needsQuotes){
+            line += field;
+            continue;
+        }
+        
+        line += quoteChar;
+        for(char c : field){
+            if(c == quoteChar) line += quoteChar;
+            line += c;
+        }
+        line += quoteChar;
+    }
+    line += lineEndingText();
+    return line;
+}
+
+inline void ReaderWriter::append(const std::string& rows){
+    uint64 oldSize = buffer.size();
+    
+    // An unterminated last row must be closed before new rows follow it
+    std::string block;
+    if(!buffer.empty() && buffer.back() != lineBreak()) block += lineEndingText();
+    block += rows;
+    
+    file.clear();
+    file.seekp(static_cast<std::streamoff>(oldSize), std::ios::beg);
+    file.write(block.data(), static_cast<std::streamsize>(block.size()));
+    file.flush();
+    
+    if(!file.good()){
+        // Roll the file back so it never ends in a partially written row
+        file.clear();
+        std::error_code ec;
+        std::filesystem::resize_file(path, oldSize, ec);
+        throw WriteLineException(static_cast<uint32>(rowOffsets.size()), path);
+    }
+    
+    buffer += block;
+    indexRows(oldSize + (block.size() - rows.size()));
+}
+
+inline void ReaderWriter::overwrite(uint32 row, const std::string& formattedRow){
+    if(row >= rowOffsets.size()) throw InvalidLineException(row, static_cast<uint32>(rowOffsets.size()), path);
+    
+    std::string_view existing = rowView(row);
+    std::string replacement = formattedRow;
+    
+    // Keep the existing line ending (CRLF or none on an unterminated last row)
+    size_t existingEnding = 0;
+    if(!existing.empty() && existing.back() == lineBreak()){
+        existingEnding = (existing.back() == '\n' && existing.size() > 1 && existing[existing.size() - 2] == '\r') ? 2 : 1;
+    }
+    replacement.resize(replacement.size() - std::char_traits<char>::length(lineEndingText())); // formatRow() appends a line ending
+    replacement += std::string(existing.substr(existing.size() - existingEnding));
+    
+    if(replacement.size() != existing.size()) throw RowWidthMismatchException(row, existing.size(), replacement.size());
+    
+    file.clear();
+    file.seekp(static_cast<std::streamoff>(rowOffsets[row]), std::ios::beg);
+    file.write(replacement.data(), static_cast<std::streamsize>(replacement.size()));
+    file.flush();
+    if(!file.good()) throw WriteLineException(row, path);
+    
+    buffer.replace(rowOffsets[row], replacement.size(), replacement);
+}
 
 inline void ReaderWriter::flush() {
     if(!isOpen()) throw ReaderWriterClosedException();
-    writer.flush();
+    file.flush();
 }
 
 inline void ReaderWriter::setHeader(){
     if(!isOpen()) throw ReaderWriterClosedException();
-    reader.setHeader();
+    
+    auto row = readRow();
+    if(!row) throw InvalidLineException(rowNumber, path);
+    header = std::move(*row);
 }
 
-inline void ReaderWriter::setHeader(uint32 rowNumber) {
+inline void ReaderWriter::setHeader(uint32 headerRow) {
     if(!isOpen()) throw ReaderWriterClosedException();
-    reader.setHeader(rowNumber);
+    if(headerRow >= rowOffsets.size()) throw InvalidLineException(headerRow, path);
+    
+    std::vector<std::string> row;
+    parseString(rowView(headerRow), row, delimiter, headerRow);
+    header = std::move(row);
 }
 
 inline bool ReaderWriter::isHeaderSet() const {
     if(!isOpen()) throw ReaderWriterClosedException();
-    return reader.isHeaderSet();
+    return !header.empty();
 }
 
 inline char ReaderWriter::getDelimiter() const {
     if(!isOpen()) throw ReaderWriterClosedException();
-    return reader.getDelimiter();
+    return delimiter.front();
+}
+
+inline const std::string& ReaderWriter::getDelimiterString() const {
+    if(!isOpen()) throw ReaderWriterClosedException();
+    return delimiter;
 }
 
 inline uint32 ReaderWriter::getReaderLine() const {
     if(!isOpen()) throw ReaderWriterClosedException();
-    return reader.getRowNumber();
+    return rowNumber;
 }
 
 inline uint32 ReaderWriter::getNumRows() const {
     if(!isOpen()) throw ReaderWriterClosedException();
-    return reader.getNumRows();
+    return static_cast<uint32>(rowOffsets.size());
 }
 
 inline uint32 ReaderWriter::getWriterLine() const {
     if(!isOpen()) throw ReaderWriterClosedException();
-    return writer.getRowNumber();
+    return static_cast<uint32>(rowOffsets.size());
 }
 
-inline void ReaderWriter::setReaderLine(uint32 rowNumber) {
+inline void ReaderWriter::setReaderLine(uint32 targetRow) {
     if(!isOpen()) throw ReaderWriterClosedException();
-    reader.setRowNumber(rowNumber);
+    if(targetRow > rowOffsets.size()) throw InvalidLineException(targetRow, static_cast<uint32>(rowOffsets.size()), path);
+    rowNumber = targetRow;
 }
 
 inline void ReaderWriter::setDelimiter(char delim) {
     if(!isOpen()) throw ReaderWriterClosedException();
-    reader.setDelimiter(delim);
-    writer.setDelimiter(delim);
-}
-
-inline void ReaderWriter::open(const std::string& filePath, uint32 startLine){ // if not appending to the file, truncate it (overwrite)
-    reader.open(filePath, startLine);
-    try{
-        writer.open(filePath, true);
-    }catch(const error::FatalException&){
-        reader.close();
-        throw;
-    }catch(const error::NonFatalException&){
-        reader.close();
-        throw;
+    delimiter.assign(1, delim);
+}
+
+inline void ReaderWriter::setDelimiter(const std::string& delim) {
+    if(!isOpen()) throw ReaderWriterClosedException();
+    if(delim.empty()) throw error::FatalException("Delimiter must contain at least one character.");
+    delimiter = delim;
+}
+
+// Usable before open(). The quote character and line ending decide where rows
+// end, so an open file is re-indexed with them. hasHeader is informational.
+inline void ReaderWriter::setDialect(const Dialect& dialect){
+    delimiter.assign(1, dialect.delimiter);
+    quoteChar = dialect.quoteChar;
+    collapseWhitespace = dialect.collapseWhitespace;
+    lineEnding = dialect.lineEnding;
+    if(isOpen()){
+        rowOffsets.clear();
+        indexRows(0);
+        if(rowNumber > rowOffsets.size()) rowNumber = static_cast<uint32>(rowOffsets.size());
     }
 }
 
+inline Dialect ReaderWriter::getDialect() const{
+    Dialect dialect;
+    dialect.delimiter = delimiter.front();
+    dialect.quoteChar = quoteChar;
+    dialect.hasHeader = !header.empty();
+    dialect.lineEnding = lineEnding;
+    dialect.collapseWhitespace = collapseWhitespace;
+    return dialect;
+}
+
 inline std::optional<std::vector<std::string>> ReaderWriter::readRow() {
     if(!isOpen()) throw ReaderWriterClosedException();
-    return reader.readRow();
+    return readNextRow(delimiter);
+}
+
+inline std::optional<std::vector<std::string>> ReaderWriter::readRow(char delim) {
+    if(!isOpen()) throw ReaderWriterClosedException();
+    return readNextRow(std::string_view(&delim, 1));
+}
+
+inline std::optional<std::vector<std::string>> ReaderWriter::readNextRow(std::string_view delim) {
+    if(rowNumber >= rowOffsets.size()){
+        if (warningCallback) warningCallback("Reached EOF while reading rowNumber.");
+        return std::nullopt;
+    }
+    
+    std::vector<std::string> RETURNvector;
+    parseString(rowView(rowNumber), RETURNvector, delim, rowNumber);
+    rowNumber++;
+    
+    if(!header.empty() && RETURNvector.size() < header.size()) throw ShortRowException(path, header, RETURNvector.size(), delim.front());
+    return RETURNvector;
 }
 
 inline table::Table ReaderWriter::readAll(){
     if(!isOpen()) throw ReaderWriterClosedException();
-    return reader.readAll();
+    return readAllRows(delimiter);
 }
 
 inline table::Table ReaderWriter::readAll(char delim){
     if(!isOpen()) throw ReaderWriterClosedException();
-    return reader.readAll(delim);
+    return readAllRows(std::string_view(&delim, 1));
+}
+
+inline table::Table ReaderWriter::readAllRows(std::string_view delim){
+    table::Table t;
+    std::vector<std::string> row;
+    for(uint32 i = 0; i < rowOffsets.size(); ++i){
+        parseString(rowView(i), row, delim, i);
+        if(!header.empty() && row.size() < header.size()) throw ShortRowException(path, header, row.size(), delim.front());
+        t.insertRow(row);
+    }
+    return t;
 }
 
 inline void ReaderWriter::skipLines(uint32 count){
     if(!isOpen()) throw ReaderWriterClosedException();
-    reader.skipLines(count);
+    
+    if(static_cast<uint64>(rowNumber) + count > rowOffsets.size()){
+        if (warningCallback) warningCallback("Reached EOF before skipping all requested lines.");
+        rowNumber = static_cast<uint32>(rowOffsets.size());
+        return;
+    }
+    rowNumber += count;
 }
 
 inline bool ReaderWriter::isEOF() const {
     if(!isOpen()) throw ReaderWriterClosedException();
-    return reader.isEOF();      // check the underlying stream
+    return rowNumber >= rowOffsets.size();
 }
 
 inline void ReaderWriter::writeRow(const std::vector<std::string>& fields){
     if(!isOpen()) throw ReaderWriterClosedException();
-    
-    writer.writeRow(fields);
-    reader.setNumLines(writer.getNumRows());
+    append(formatRow(fields, delimiter));
 }
 
 inline void ReaderWriter::writeRow(const std::vector<std::string>& fields, char delim){
     if(!isOpen()) throw ReaderWriterClosedException();
-    
-    writer.writeRow(fields, delim);
-    reader.setNumLines(writer.getNumRows());
+    append(formatRow(fields, std::string_view(&delim, 1)));
 }
 
 inline void ReaderWriter::writeAll(const table::Table& t){
     if(!isOpen()) throw ReaderWriterClosedException();
-    
-    writer.writeAll(t);
-    reader.setNumLines(writer.getNumRows());
+    appendTable(t, delimiter);
 }
 
 inline void ReaderWriter::writeAll(const table::Table& t, char delim){
     if(!isOpen()) throw ReaderWriterClosedException();
-    
-    writer.writeAll(t, delim);
-    reader.setNumLines(writer.getNumRows());
+    appendTable(t, std::string_view(&delim, 1));
+}
+
+inline void ReaderWriter::appendTable(const table::Table& t, std::string_view delim){
+    // Format every row first so the whole table is appended in one write
+    std::string rows;
+    for(size_t i = 0; i < t.getHeight(); ++i) rows += formatRow(t[i], delim);
+    if(!rows.empty()) append(rows);
+}
+
+inline void ReaderWriter::updateRow(uint32 row, const std::vector<std::string>& fields){
+    if(!isOpen()) throw ReaderWriterClosedException();
+    overwrite(row, formatRow(fields, delimiter));
+}
+
+inline void ReaderWriter::updateRow(uint32 row, const std::vector<std::string>& fields, char delim){
+    if(!isOpen()) throw ReaderWriterClosedException();
+    overwrite(row, formatRow(fields, std::string_view(&delim, 1)));
 }
 
 inline std::string ReaderWriter::getFieldByType(const std::vector<std::string>& row, const std::string& columnName) const {
     if(!isOpen()) throw ReaderWriterClosedException();
-    return reader.getFieldByType(row, columnName);
+    if(header.empty()) throw NoFileHeaderException(path);
+
+    for(size_t i = 0; i < header.size(); i++){
+        if(header[i] == columnName){
+            if(i >= row.size()) throw ShortRowException(path, header, row.size(), delimiter.front());
+            return row[i];
+        }
+    }
+    throw SchemaMismatchException(path, columnName, header, delimiter.front());
 }
 
-inline std::string ReaderWriter::getFieldByType(uint32 rowNumber, const std::string& columnName){
+inline std::string ReaderWriter::getFieldByType(uint32 row, const std::string& columnName){
     if(!isOpen()) throw ReaderWriterClosedException();
-    return reader.getFieldByType(rowNumber, columnName);
+    if(header.empty()) throw NoFileHeaderException(path);
+    if(row >= rowOffsets.size()) throw InvalidLineException(row, path);
+    
+    std::vector<std::string> fields;
+    parseString(rowView(row), fields, delimiter, row);
+    return getFieldByType(fields, columnName);
 }
 
 inline void ReaderWriter::close() noexcept {
-    reader.close();
-    writer.close();
+    if(file.is_open()) file.close();
+    
+    buffer.clear();
+    buffer.shrink_to_fit();
+    rowOffsets.clear();
+    header.clear();
+    rowNumber = 0;
+    path.clear();
 }
 
 // Standalone utility functions
 
-inline uint32 countLines(const std::string& filePath){
+// Row splitting shared by Reader and ReaderWriter. Rows without a quote
+// character take a fast path that splits with find() and copies each field
+// once. Quoted fields may contain the delimiter, newlines and doubled quotes.
+// With collapseWhitespace any run of spaces/tabs is one separator and
+// leading/trailing whitespace is ignored, so "  1   150  40" gives 3 fields.
+// Trailing line-break characters are trimmed from the fields. Returns false
+// when a quoted field is still open at the end of the line.
+inline bool parseFields(std::string_view line, std::vector<std::string>& fields, std::string_view delim, char quoteChar, bool collapseWhitespace){
+    fields.clear();
+    
+    if(collapseWhitespace){
+        static constexpr const char* whitespace = " \t\r\n";
+        
+        if(line.find(quoteChar) == std::string_view::npos){
+            // Fast path: hop between runs with find_first_(not_)of
+            size_t start = line.find_first_not_of(whitespace);
+            while(start != std::string_view::npos){
+                size_t end = line.find_first_of(whitespace, start);
+                if(end == std::string_view::npos) end = line.size();
+                fields.emplace_back(line.substr(start, end - start));
+                start = line.find_first_not_of(whitespace, end);
+            }
+            if(fields.empty()) fields.emplace_back();
+            return true;
+        }
+        
+        fields.reserve(10);
+        std::string field;
+        bool inField = false;
+        bool inQuotes = false;
+        bool lastWasQuote = false;
+        
+        for(char c : line){
+            if(inQuotes){
+                if(c == quoteChar){
+                    if(lastWasQuote){
+                        field += quoteChar;
+                        lastWasQuote = false;
+                    }else lastWasQuote = true;
+                    continue;
+                }
+                if(!lastWasQuote){
+                    field += c;
+                    continue;
+                }
+                inQuotes = false; // closing quote was the previous character
+                lastWasQuote = false;
+            }
+            
+            if(c == ' ' || c == '\t' || c == '\n' || c == '\r'){
+                if(inField){
+                    fields.push_back(std::move(field));
+                    field.clear();
+                    inField = false;
+                }
+            }else if(c == quoteChar && !inField){
+                inQuotes = true;
+                inField = true;
+            }else{
+                field += c;
+                inField = true;
+            }
+        }
+        
+        if(inQuotes && !lastWasQuote) return false;
+        if(inField || fields.empty()) fields.push_back(std::move(field));
+        return true;
+    }
+    
+    bool closed = true;
+    if(line.find(quoteChar) == std::string_view::npos){
+        size_t start = 0;
+        while(true){
+            size_t end = (delim.size() == 1) ? line.find(delim.front(), start) : line.find(delim, start);
+            if(end == std::string_view::npos) break;
+            fields.emplace_back(line.substr(start, end - start));
+            start = end + delim.size();
+        }
+        fields.emplace_back(line.substr(start));
+    }else{
+        fields.reserve(10);
+        
+        std::string field;
+        field.reserve(64);
+        bool inQuotes = false;
+        bool lastWasQuote = false;
+        
+        for(size_t i = 0; i < line.size(); ++i){
+            char c = line[i];
+            bool atDelimiter = (c == delim.front()) && (delim.size() == 1 || line.compare(i, delim.size(), delim) == 0);
+            
+            if(inQuotes){
+                if(c == quoteChar){
+                    if(lastWasQuote){
+                        field += quoteChar;
+                        lastWasQuote = false;
+                    }else lastWasQuote = true;
+                }else if(lastWasQuote){
+                    inQuotes = false;
+                    lastWasQuote = false;
+                    
+                    if(atDelimiter){
+                        fields.push_back(std::move(field));
+                        field.clear();
+                        i += delim.size() - 1;
+                    }else field += c;
+                }else field += c;
+            }else{
+                if(c == quoteChar){
+                    inQuotes = true;
+                }else if(atDelimiter){
+                    fields.push_back(std::move(field));
+                    field.clear();
+                    i += delim.size() - 1;
+                }else field += c;
+            }
+        }
+        
+        fields.push_back(std::move(field));
+        closed = !inQuotes || lastWasQuote;
+    }
+    
+    // Trim trailing newlines
+    for(auto& f : fields) {
+        while(!f.empty() && (f.back() == '\n' || f.back() == '\r')) f.pop_back();
+    }
+    return closed;
+}
+
+
+// Detects the dialect of a CSV sample. Each candidate delimiter is scored by
+// how consistently it splits the sample's lines into the same number (> 1) of
+// fields; whitespace is also tried as run-splitting. A header is assumed when
+// the first row disagrees with the type (numeric or not) of most columns below.
+inline Dialect sniffSample(std::string_view sample){
+    Dialect dialect;
+    
+    // Line endings
+    size_t lf = 0, crlf = 0, cr = 0;
+    for(size_t i = 0; i < sample.size(); ++i){
+        if(sample[i] == '\n') lf++;
+        else if(sample[i] == '\r'){
+            if(i + 1 < sample.size() && sample[i + 1] == '\n'){
+                crlf++;
+                i++;
+            }else cr++;
+        }
+    }
+    if(crlf >= lf && crlf >= cr && crlf > 0) dialect.lineEnding = LineEnding::CRLF;
+    else if(cr > lf) dialect.lineEnding = LineEnding::CR;
+    
+    // Split into (at most 200) non-empty lines
+    const char lineBreak = (dialect.lineEnding == LineEnding::CR) ? '\r' : '\n';
+    std::vector<std::string_view> lines;
+    size_t start = 0;
+    while(start < sample.size() && lines.size() < 200){
+        size_t end = sample.find(lineBreak, start);
+        if(end == std::string_view::npos) end = sample.size();
+        std::string_view line = sample.substr(start, end - start);
+        if(!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if(!line.empty()) lines.push_back(line);
+        start = end + 1;
+    }
+    if(lines.empty()) return dialect;
+    
+    // Quote character: the one found most often directly after a line start
+    // or punctuation, i.e. where a quoted field would begin
+    size_t doubleQuotes = 0, singleQuotes = 0;
+    for(std::string_view line : lines){
+        for(size_t i = 0; i < line.size(); ++i){
+            if(line[i] != '"' && line[i] != '\'') continue;
+            char previous = (i == 0) ? ',' : line[i - 1];
+            if(std::isalnum(static_cast<unsigned char>(previous))) continue;
+            (line[i] == '"' ? doubleQuotes : singleQuotes)++;
+        }
+    }
+    dialect.quoteChar = (singleQuotes > doubleQuotes) ? '\'' : '"';
+    
+    // Field count of a line for a candidate delimiter, ignoring quoted text
+    auto countFields = [&](std::string_view line, char delim, bool runs){
+        size_t count = 0;
+        bool inQuotes = false;
+        bool inField = false;
+        for(char c : line){
+            if(c == dialect.quoteChar) inQuotes = !inQuotes;
+            bool separator = !inQuotes && (runs ? (c == ' ' || c == '\t') : (c == delim));
+            if(!runs){
+                if(separator) count++;
+                continue;
+            }
+            if(separator) inField = false;
+            else if(!inField){
+                count++;
+                inField = true;
+            }
+        }
+        return runs ? count : count + 1;
+    };
+    
+    // Score: fraction of lines agreeing with the most common field count
+    auto score = [&](char delim, bool runs, size_t& modeFields){
+        std::vector<size_t> counts;
+        counts.reserve(lines.size());
+        for(std::string_view line : lines) counts.push_back(countFields(line, delim, runs));
+        
+        size_t bestCount = 0, bestFrequency = 0;
+        for(size_t candidate : counts){
+            size_t frequency = static_cast<size_t>(std::count(counts.begin(), counts.end(), candidate));
+            if(frequency > bestFrequency || (frequency == bestFrequency && candidate > bestCount)){
+                bestFrequency = frequency;
+                bestCount = candidate;
+            }
+        }
+        modeFields = bestCount;
+        return (bestCount > 1) ? static_cast<double>(bestFrequency) / counts.size() : 0.0;
+    };
+    
+    double bestScore = 0.0;
+    size_t bestFields = 0;
+    for(char delim : {',', ';', '\t', '|', ':', ' '}){
+        size_t fields = 0;
+        double candidateScore = score(delim, false, fields);
+        if(candidateScore > bestScore || (candidateScore == bestScore && candidateScore > 0.0 && fields > bestFields)){
+            bestScore = candidateScore;
+            bestFields = fields;
+            dialect.delimiter = delim;
+            dialect.collapseWhitespace = false;
+        }
+    }
+    
+    // Whitespace runs win if they split more consistently, or as consistently
+    // as single spaces (collapsing is then harmless and tolerates ragged files)
+    size_t runFields = 0;
+    double runScore = score(' ', true, runFields);
+    if(runScore > bestScore || (runScore > 0.0 && runScore == bestScore && dialect.delimiter == ' ')){
+        bestScore = runScore;
+        dialect.delimiter = ' ';
+        dialect.collapseWhitespace = true;
+    }
+    
+    // Header detection: compare the first row against the rows below it
+    if(lines.size() < 2) return dialect;
+    auto split = [&](std::string_view line){
+        std::vector<std::string_view> fields;
+        size_t fieldStart = 0;
+        bool inQuotes = false;
+        bool inField = false;
+        for(size_t i = 0; i <= line.size(); ++i){
+            char c = (i < line.size()) ? line[i] : '\n';
+            if(c == dialect.quoteChar) inQuotes = !inQuotes;
+            if(inQuotes) continue;
+            bool separator = dialect.collapseWhitespace ? (c == ' ' || c == '\t' || c == '\n') : (c == dialect.delimiter || c == '\n');
+            if(dialect.collapseWhitespace){
+                if(separator && inField) { fields.push_back(line.substr(fieldStart, i - fieldStart)); inField = false; }
+                else if(!separator && !inField) { fieldStart = i; inField = true; }
+            }else if(separator){
+                fields.push_back(line.substr(fieldStart, i - fieldStart));
+                fieldStart = i + 1;
+            }
+        }
+        return fields;
+    };
+    auto isNumeric = [&](std::string_view field){
+        if(!field.empty() && field.front() == dialect.quoteChar && field.size() >= 2) field = field.substr(1, field.size() - 2);
+        if(field.empty()) return false;
+        char* end = nullptr;
+        std::string value(field);
+        std::strtod(value.c_str(), &end);
+        return end == value.c_str() + value.size();
+    };
+    
+    std::vector<std::string_view> first = split(lines[0]);
+    int votes = 0;
+    for(size_t column = 0; column < first.size(); ++column){
+        size_t numeric = 0, total = 0;
+        for(size_t i = 1; i < lines.size(); ++i){
+            std::vector<std::string_view> row = split(lines[i]);
+            if(row.size() != first.size()) continue;
+            total++;
+            if(isNumeric(row[column])) numeric++;
+        }
+        if(total == 0) continue;
+        bool columnNumeric = numeric * 2 > total;
+        if(columnNumeric) votes += isNumeric(first[column]) ? -1 : 1;
+    }
+    dialect.hasHeader = votes > 0;
+    
+    return dialect;
+}
+
+inline Dialect sniffDialect(const std::string& filePath, size_t sampleBytes){
+    std::ifstream file(filePath, std::ios::in | std::ios::binary);
+    if(!file.is_open()) throw FileOpenFailureException(filePath);
+    
+    std::string sample(sampleBytes, '\0');
+    file.read(sample.data(), static_cast<std::streamsize>(sampleBytes));
+    sample.resize(static_cast<size_t>(file.gcount()));
+    
+    // Drop a trailing partial line so it cannot skew the field counts
+    if(sample.size() == sampleBytes){
+        size_t lastBreak = sample.find_last_of("\r\n");
+        if(lastBreak != std::string::npos) sample.resize(lastBreak + 1);
+    }
+    return sniffSample(sample);
+}
+
+inline uint32 countLines(const std::string& filePath, char lineBreak){
     // Count the number of lines in a file
     std::ifstream file(filePath);
     if(!file.is_open()) throw FileOpenFailureException(filePath);
     uint32 lineCount = 0;
     std::string rowNumber;
-    while(std::getline(file, rowNumber)) lineCount++;
+    while(std::getline(file, rowNumber, lineBreak)) lineCount++;
     return lineCount;
 }
     
@@ -1,6 +1,7 @@
 #include "include/Error.hpp"
 #include "include/Table.hpp"
 #include "CSV.hpp"
+#include <cstdio>
 
 
 // Demo program for csv::Reader / csv::Writer and table::Table
@@ -173,6 +174,119 @@ int main() {
         std::cout << "(no data)]" << std::endl;
     }
 
+    // Demonstrate follow mode: only complete rows are returned, a half-written
+    // final row stays unread until its newline arrives.
+    {
+        std::ofstream log("follow.csv", std::ios::trunc);
+        log << "id,event\n1,start\n2,runn";
+    }
+    csv::Reader follower;
+    follower.open("follow.csv");
+    while (auto appended = follower.readAppendedRow()) std::cout << "appended row: " << (*appended)[0] << std::endl;
+    std::cout << "offset after complete rows: " << follower.getRowOffset() << std::endl;
+    {
+        std::ofstream log("follow.csv", std::ios::app);
+        log << "ing\n3,stop\n";
+    }
+    uint32 delivered = follower.follow([](const std::vector<std::string>& appended) {
+        std::cout << "followed row: " << appended[0] << "," << appended[1] << std::endl;
+        return appended[1] != "stop";
+    });
+    std::cout << "rows delivered by follow(): " << delivered << std::endl;
+    follower.close();
+    std::remove("follow.csv");
+
+    // Demonstrate multi-character delimiters and whitespace runs (TSPLIB-style
+    // coordinate lines), both split on the fast path without quotes
+    {
+        std::ofstream multi("delimiters.csv", std::ios::trunc);
+        multi << "id::name::score\n1::\"a::b\"::9.5\n";
+        std::ofstream coords("coords.txt", std::ios::trunc);
+        coords << "  1   1150.0  1760.0\n\t2 630.0\t1660.0  \n";
+    }
+    csv::Reader doubleColon("::");
+    doubleColon.open("delimiters.csv");
+    doubleColon.skipLines(1);
+    auto scored = doubleColon.readRow();
+    if (scored) std::cout << "'::' row: " << scored->size() << " fields, name " << (*scored)[1] << std::endl;
+    doubleColon.close();
+
+    csv::Dialect runs;
+    runs.delimiter = ' ';
+    runs.collapseWhitespace = true;
+    csv::Reader coordinates(runs);
+    coordinates.open("coords.txt");
+    std::vector<std::string_view> coordinate;
+    while (coordinates.readRowView(coordinate))
+        std::cout << "node " << coordinate[0] << " at (" << coordinate[1] << ", " << coordinate[2] << ")" << std::endl;
+    coordinates.close();
+    std::remove("delimiters.csv");
+    std::remove("coords.txt");
+
+    // Demonstrate dialect sniffing: a semicolon-separated file with a header
+    // row and classic Mac (CR-only) line endings
+    {
+        std::ofstream mac("sniffed.csv", std::ios::binary | std::ios::trunc);
+        mac << "city;population\r'Le Mans';143000\rLyon;522000\r";
+    }
+    csv::Dialect dialect = csv::sniffDialect("sniffed.csv");
+    std::cout << "sniffed delimiter '" << dialect.delimiter << "', quote " << dialect.quoteChar
+              << ", header " << (dialect.hasHeader ? "yes" : "no")
+              << ", line ending " << (dialect.lineEnding == csv::LineEnding::CR ? "CR" : dialect.lineEnding == csv::LineEnding::CRLF ? "CRLF" : "LF") << std::endl;
+    csv::Reader sniffed(dialect);
+    sniffed.open("sniffed.csv");
+    if (dialect.hasHeader) sniffed.setHeader(0); // hasHeader is only a hint
+    sniffed.skipLines(1);
+    while (auto city = sniffed.readRow()) std::cout << "sniffed row: " << (*city)[0] << " / " << sniffed.getFieldByType(*city, "population") << std::endl;
+    sniffed.close();
+    std::remove("sniffed.csv");
+
+    // Demonstrate lenient mode: malformed rows are recorded and skipped, and
+    // an unterminated quote only costs its own line
+    {
+        std::ofstream dirty("lenient.csv", std::ios::trunc);
+        dirty << "id,name\n1,ok\n2,bro\"ken\n3,\"closed\"extra\n4\n5,\"never closed\n6,fine\n";
+    }
+    csv::Reader tolerant;
+    tolerant.open("lenient.csv");
+    tolerant.setHeader(0);
+    tolerant.setLenient(true, 10);
+    tolerant.skipLines(1);
+    tolerant.resetParseStats(); // count only the data rows below
+    while (auto accepted = tolerant.readRow()) std::cout << "lenient row: " << (*accepted)[0] << "," << (*accepted)[1] << std::endl;
+    for (const csv::ParseError& parseError : tolerant.getErrorSink().getErrors())
+        std::cout << "rejected row " << parseError.rowNumber << " at byte " << parseError.byteOffset << ": " << csv::toString(parseError.reason) << std::endl;
+    std::cout << "accepted " << tolerant.getRowsAccepted() << ", rejected " << tolerant.getRowsRejected() << std::endl;
+    tolerant.close();
+    std::remove("lenient.csv");
+
+    // Demonstrate ReaderWriter: appended rows are readable at once, awkward
+    // fields (delimiter, quotes, '\r', newlines) survive a round trip, and
+    // fixed-width rows can be rewritten in place
+    {
+        std::ofstream seed("readerwriter.csv", std::ios::trunc);
+        seed << "id,status,note\n1,ok,plain\n";
+    }
+    csv::ReaderWriter rw;
+    rw.open("readerwriter.csv");
+    rw.setHeader(0);
+    std::vector<std::string> awkward = {"2", "ok", "a,b \"quoted\"\r\nnext line"};
+    rw.writeRow(awkward);
+    rw.setReaderLine(2);
+    auto roundTrip = rw.readRow();
+    std::cout << "ReaderWriter round trip: " << ((roundTrip && *roundTrip == awkward) ? "matches" : "differs") << std::endl;
+    rw.updateRow(1, {"1", "no", "plain"});
+    std::cout << "updated status: " << rw.getFieldByType(1, "status") << ", rows: " << rw.getNumRows() << std::endl;
+    rw.close();
+
+    // The same rows through Reader, which shares ReaderWriter's parser
+    csv::Reader check;
+    check.open("readerwriter.csv");
+    auto all = check.readAll();
+    std::cout << "Reader sees " << all.getHeight() << " rows, last note has " << all.rowRef(2)[2].size() << " characters" << std::endl;
+    check.close();
+    std::remove("readerwriter.csv");
+
     // Demonstrate closing
     r.close();
     std::cout << "File closed." << std::endl;
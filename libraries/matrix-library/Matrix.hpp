@@ -1,6 +1,18 @@
 #pragma once
 
+#include "include/Allocator.hpp"
 #include "include/Error.hpp"
+#include "include/Gemm.hpp"
+#include "include/Simd.hpp"
+#include "include/Strassen.hpp"
+#include "include/Expression.hpp"
+#include "include/MatrixView.hpp"
+#include "include/RowReduction.hpp"
+#include "include/ThreadPool.hpp"
+#include "include/Transpose.hpp"
+#include <algorithm>
+#include <atomic>
+#include <complex>
 #include <vector>
 #include <stdexcept>
 #include <cmath>
@@ -8,247 +20,387 @@
 #include <sstream>
 #include <iomanip>
 #include <numeric>
+#include <type_traits>
 
 namespace la{
 
-class Matrix {
+namespace detail{
+    template<class T> struct IsComplex : std::false_type {};
+    template<class T> struct IsComplex<std::complex<T>> : std::true_type {};
+}
+
+// Row layout of a matrix's storage: packed (stride = number of columns), or every
+// row padded to start on a 64-byte boundary (see include/Allocator.hpp)
+enum class Padding { None, AlignRows };
+
+// Dense row-major matrix of T: float, double, std::complex<float/double> or an integer type.
+// Matrix (double) is the default; the factorizations (LU, Cholesky, QR, solve, eigen, SVD) are double-only.
+template<class T>
+class BasicMatrix : public MatrixExpr<BasicMatrix<T>> {
+    static_assert((std::is_arithmetic<T>::value && !std::is_same<T, bool>::value) || detail::IsComplex<T>::value,
+                  "Matrix elements must be an arithmetic or std::complex type.");
+
 private:
+    using Storage = std::vector<T, detail::AlignedAllocator<T>>;
+
     size_t rowSize, colSize;
-    std::vector<double> data;
+    size_t stride;                              // elements between row starts; padding past rowSize is kept zero
+    Padding padding = Padding::None;
+    Storage data;
     bool isAugmented = false;
     
     // Internal functions
     
-    double& get(size_t row, size_t col) {
-        return data[row * rowSize + col];
+    T& get(size_t row, size_t col) {
+        return data[row * stride + col];
     }
-    const double& get(size_t row, size_t col) const {
-        return data[row * rowSize + col];
+    const T& get(size_t row, size_t col) const {
+        return data[row * stride + col];
     }
     
-    void set(size_t row, size_t col, double value){
-        data[row * rowSize + col] = value;
+    void set(size_t row, size_t col, T value){
+        data[row * stride + col] = value;
     }
     
-    Matrix submatrix(size_t startRow, size_t startColumn, size_t numRows, size_t numColumns){
-        Matrix matrix(numRows, numColumns);
-        
-        for(int i=startRow; i<(startRow+numRows); i++)
-            std::copy(data.begin() + i * rowSize + startColumn, 
-                      data.begin() + i * rowSize + startColumn + numColumns,
-                      matrix.data.begin() + (i - startRow) * numColumns);
-        
-        return matrix;
+    bool isPacked() const { return stride == rowSize; }
+    
+    size_t strideFor(size_t numColumns) const {
+        return padding == Padding::AlignRows ? detail::paddedStride<T>(numColumns) : numColumns;
+    }
+    
+    // body(offset, length) over every stored element, skipping row padding: in tiles when
+    // the rows are packed, otherwise one row at a time
+    template<class F>
+    void forEachSpan(F&& body) const {
+        if(isPacked())
+            detail::forEachTile(data.size(), [&](size_t low, size_t high){ body(low, high - low); });
+        else
+            detail::forEachBand(0, colSize, rowSize, [&](size_t low, size_t high){
+                for(size_t row = low; row < high; row++) body(row * stride, rowSize);
+            });
+    }
+    
+    BasicMatrix submatrix(size_t startRow, size_t startColumn, size_t numRows, size_t numColumns) const{
+        return BasicMatrix(block(startRow, startColumn, numRows, numColumns));
     }
 
+    // Rows keep their place when the stride does not change (only rows added or removed, or
+    // columns within the padding); otherwise the kept block is copied row by row
     void resize(size_t numRows, size_t numColumns){
         size_t old_colSize = colSize;
         size_t old_rowSize = rowSize;
+        size_t old_stride = stride;
         
         colSize = numRows;
         rowSize = numColumns;
+        stride = strideFor(numColumns);
         
-        std::vector<double> old_data = data;
-        data.resize(rowSize * colSize, 0.0);
-        
-        for(size_t y=0; y<std::min(numRows, old_colSize); y++){
-            for(size_t x=0; x<std::min(numColumns, old_rowSize); x++){
-                data[y * rowSize + x] = old_data[y * old_rowSize + x];
-            }
+        if(stride == old_stride){
+            data.resize(stride * colSize, T(0));
+            if(numColumns < old_rowSize)
+                for(size_t y=0; y<std::min(numRows, old_colSize); y++)
+                    std::fill(data.begin() + y * stride + numColumns, data.begin() + y * stride + old_rowSize, T(0));
+            return;
         }
+        
+        Storage old_data = std::move(data);
+        data.assign(stride * colSize, T(0));
+        
+        size_t keep = std::min(numColumns, old_rowSize);
+        for(size_t y=0; y<std::min(numRows, old_colSize); y++)
+            std::copy(old_data.begin() + y * old_stride, old_data.begin() + y * old_stride + keep, data.begin() + y * stride);
     }
 
+    bool equals(const BasicMatrix& other) const;
+    T dot(const BasicMatrix& columnVector) const;
+
     class RowProxy {
     private:
-        std::vector<double>& data;
+        Storage& data;
         size_t rowIndex;
-        size_t rowSize;
+        size_t stride;
         
     public:
-        RowProxy(std::vector<double>& data, size_t rowIndex, size_t rowSize)
-            : data(data), rowIndex(rowIndex), rowSize(rowSize) {}
+        RowProxy(Storage& data, size_t rowIndex, size_t stride)
+            : data(data), rowIndex(rowIndex), stride(stride) {}
         
-        double& operator[](size_t col) {
-            return data[rowIndex * rowSize + col];
+        T& operator[](size_t col) {
+            return data[rowIndex * stride + col];
         }
         
-        const double& operator[](size_t col) const {
-            return data[rowIndex * rowSize + col];
+        const T& operator[](size_t col) const {
+            return data[rowIndex * stride + col];
         }
     };
 
 public:
-    Matrix(size_t rowSize, size_t colSize){
+    using value_type = T;
+
+    BasicMatrix(size_t rowSize, size_t colSize, Padding padding = Padding::None) : padding(padding){
         if (rowSize<1 || colSize<1) throw error::FatalException("Matrix dimensions must be greater than 0");
         this->rowSize = rowSize;
         this->colSize = colSize;
+        stride = strideFor(rowSize);
         
         // set data vector size
-        data.resize(rowSize * colSize);
+        data.resize(stride * colSize);
         zero();
     }
     
-    Matrix(std::vector<std::vector<double>> rows){
+    BasicMatrix(const std::vector<std::vector<T>>& rows){
         colSize = rows.size();
         rowSize = rows[0].size();
-        data.reserve(rowSize * colSize);
+        stride = rowSize;
         
-        for(int y=0; y<colSize; y++){
-            if(rows[y].size() != rowSize)
+        for(const std::vector<T>& row : rows)
+            if(row.size() != rowSize)
                 throw error::FatalException("Mismatching row sizes passed to matrix constructor.");
-            
-            for(int x=0; x<rowSize; x++)
-                data.push_back(rows[y][x]);
-        }
+        
+        data.resize(rowSize * colSize);
+        for(size_t y=0; y<colSize; y++)
+            std::copy(rows[y].begin(), rows[y].end(), data.begin() + y * stride);
     }
     
     
-    ~Matrix() = default;
+    // Evaluates an elementwise expression (e.g. A + B * 2.0 - C) in one pass; an
+    // expression holding a temporary matrix is evaluated into that matrix's storage
+    template<class E>
+    BasicMatrix(const MatrixExpr<E>& expr);
+    template<class E>
+    BasicMatrix(MatrixExpr<E>&& expr);
+    
+    BasicMatrix(const BasicMatrix&) = default;
+    BasicMatrix(BasicMatrix&&) noexcept = default;
+    BasicMatrix& operator=(const BasicMatrix&) = default;
+    BasicMatrix& operator=(BasicMatrix&&) noexcept = default;
+    ~BasicMatrix() = default;
     
-    static Matrix identity(size_t size);
+    template<class E>
+    BasicMatrix& operator=(const MatrixExpr<E>& expr);
+    template<class E>
+    BasicMatrix& operator=(MatrixExpr<E>&& expr);
+    
+    static BasicMatrix identity(size_t size);
+    
+    // Elementwise conversion, e.g. IntMatrix -> Matrix before an inverse
+    template<class U>
+    BasicMatrix<U> cast() const;
     
     RowProxy operator[](size_t row);            // element access using [x][y]
     const RowProxy operator[](size_t row) const;
     
     void zero();
     
-    Matrix col(size_t col) const;
-    Matrix row(size_t row) const;
+    BasicMatrix col(size_t col) const;          // copies; use view().col(col) to avoid the copy
+    BasicMatrix row(size_t row) const;
+    
+    // Non-owning views of the storage (include/MatrixView.hpp); valid until the matrix is resized or destroyed
+    BasicMatrixView<T> view();
+    BasicMatrixView<const T> view() const;
+    BasicMatrixView<T> block(size_t startRow, size_t startColumn, size_t numRows, size_t numColumns);
+    BasicMatrixView<const T> block(size_t startRow, size_t startColumn, size_t numRows, size_t numColumns) const;
     
     size_t getRowSize() const;
     size_t getColSize() const;
+    size_t getStride() const;                   // elements between row starts (getRowSize() unless padded)
+    Padding getPadding() const;
     
-    double determinant() const;                       // Gaussian elimination O(n³)
+    const T* getData() const;                   // row-major storage, 64-byte aligned
+    T* getData();
     
-    friend bool operator==(const Matrix& mtx1, const Matrix& mtx2);
-    friend bool operator!=(const Matrix& mtx1, const Matrix& mtx2);
+    T determinant() const;                      // via LU factorization, O(n³)
     
-    Matrix operator+(const Matrix& other) const;
-    void operator+=(const Matrix& other);
+    friend bool operator==(const BasicMatrix& mtx1, const BasicMatrix& mtx2) { return mtx1.equals(mtx2); }
+    friend bool operator!=(const BasicMatrix& mtx1, const BasicMatrix& mtx2) { return !mtx1.equals(mtx2); }
     
-    Matrix operator+(double scalar) const;
-    friend Matrix operator+(double scalar, const Matrix& mtx);
-    void operator+=(double scalar);
+    // +, - and scalar *, / between matrices build expressions (include/Expression.hpp)
+    template<class E>
+    void operator+=(const MatrixExpr<E>& other);
+    void operator+=(T scalar);
     
-    Matrix operator-(const Matrix& other) const;
-    void operator-=(const Matrix& other);
+    template<class E>
+    void operator-=(const MatrixExpr<E>& other);
+    void operator-=(T scalar);
     
-    Matrix operator-(double scalar) const;
-    friend Matrix operator-(double scalar, const Matrix& mtx);
-    void operator-=(double scalar);
+    void operator*=(const BasicMatrix& other);  // A * B itself is a free function (see multiply)
+    void operator*=(T scalar);
     
-    Matrix operator*(const Matrix& other) const;
-    void operator*=(const Matrix& other);
+    BasicMatrix operator/(const BasicMatrix& other) const;
+    void operator/=(const BasicMatrix& other);
+    void operator/=(T scalar);
     
-    Matrix operator*(double scalar) const;
-    friend Matrix operator*(double scalar, const Matrix& mtx);
-    void operator*=(double scalar);
-    
-    Matrix operator/(const Matrix& other) const;
-    void operator/=(const Matrix& other);
-    
-    Matrix operator/(double scalar) const;
-    void operator/=(double scalar);
-    
-    Matrix square() const;
+    BasicMatrix square() const;
     void squareInPlace();
     
     // double dotProduct(const Matrix& other) const;
-    friend double dotProduct(const Matrix& rowVector, const Matrix& columnVector);
+    friend T dotProduct(const BasicMatrix& rowVector, const BasicMatrix& columnVector) { return rowVector.dot(columnVector); }
     
-    Matrix transpose() const;
+    // The && overloads (called on temporaries, e.g. A.inverse().transpose()) reuse the temporary's storage
+    BasicMatrix transpose() const&;
+    BasicMatrix transpose() &&;                 // in place when square
+    void transpose(BasicMatrix& out) const;     // into out, resized only if its shape differs
     void transposeInPlace();
     
-    double trace() const;
+    T trace() const;
     
-    Matrix inverse() const;
-    Matrix inverse(double threshold) const;
+    BasicMatrix inverse() const&;
+    BasicMatrix inverse() &&;
+    BasicMatrix inverse(double threshold) const;
     void inverseInPlace();
     void inverseInPlace(double threshold);
     void operator!();
     
-    Matrix augment(const Matrix &other) const;
-    void augmentInPlace(const Matrix &other);
+    BasicMatrix augment(const BasicMatrix &other) const;
+    void augmentInPlace(const BasicMatrix &other);
     
-    Matrix rowEchelonForm() const;  // forward elimination
+    BasicMatrix rowEchelonForm() const&;  // forward elimination
+    BasicMatrix rowEchelonForm() &&;
     void rowEchelonFormInPlace();
     
-    Matrix reducedREF();    // calls REF, then back-substitutes
+    BasicMatrix reducedREF() const&;    // calls REF, then back-substitutes
+    BasicMatrix reducedREF() &&;
     void reducedREFInPlace();
     
     size_t rank() const;
     
     double frobeniusNorm() const;
     
-    Matrix clean(double threshold=1e-10) const;
+    BasicMatrix clean(double threshold=1e-10) const&;
+    BasicMatrix clean(double threshold=1e-10) &&;
     void cleanInPlace(double threshold=1e-10);
-    bool isBasicallyZero(double value, double threshold) const;
+    bool isBasicallyZero(T value, double threshold=1e-10) const;
     
     void print() const;
     std::string toString(int precision = 2, int tabAmount = 1) const;
 };
 
-bool Matrix::isBasicallyZero(double value, double threshold=1e-10) const {
+using FloatMatrix = BasicMatrix<float>;
+using ComplexMatrix = BasicMatrix<std::complex<double>>;
+using IntMatrix = BasicMatrix<int>;
+
+// Matrix product with GEMM; takes any mix of matrices, views and expressions of one element type
+template<class L, class R>
+BasicMatrix<detail::ExprValueT<L>> multiply(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs);
+
+// The product written into existing storage: out is resized only when its shape differs (a view
+// must already have the product's shape), so a loop reusing out does not allocate
+template<class L, class R, class T>
+void multiply(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs, BasicMatrix<T>& out);
+template<class L, class R, class T>
+void multiply(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs, BasicMatrixView<T> out);
+
+// --- Expression glue (see include/Expression.hpp) ---
+
+template<class E> auto MatrixExpr<E>::eval() const { return BasicMatrix<detail::ExprValueT<E>>(*this); }
+template<class E> size_t MatrixExpr<E>::getRowSize() const { return detail::wrapOperand(*this).cols(); }
+template<class E> size_t MatrixExpr<E>::getColSize() const { return detail::wrapOperand(*this).rows(); }
+template<class E> auto MatrixExpr<E>::transpose() const { return eval().transpose(); }
+template<class E> auto MatrixExpr<E>::trace() const { return eval().trace(); }
+template<class E> auto MatrixExpr<E>::determinant() const { return eval().determinant(); }
+template<class E> double MatrixExpr<E>::frobeniusNorm() const { return eval().frobeniusNorm(); }
+template<class E> size_t MatrixExpr<E>::rank() const { return eval().rank(); }
+template<class E> auto MatrixExpr<E>::inverse() const { return eval().inverse(); }
+template<class E> auto MatrixExpr<E>::clean(double threshold) const { return eval().clean(threshold); }
+template<class E> void MatrixExpr<E>::print() const { eval().print(); }
+template<class E> std::string MatrixExpr<E>::toString(int precision, int tabAmount) const { return eval().toString(precision, tabAmount); }
+
+}
+
+// Factorizations and solvers built on the Matrix interface above
+#include "include/LU.hpp"
+#include "include/Cholesky.hpp"
+#include "include/QR.hpp"
+#include "include/Solve.hpp"
+#include "include/SymmetricEigen.hpp"
+#include "include/SVD.hpp"
+#include "include/FixedMatrix.hpp"
+#include "include/Sparse.hpp"
+#include "include/Batch.hpp"
+#include "include/BinaryIO.hpp"
+
+namespace la{
+template<class T>
+bool BasicMatrix<T>::isBasicallyZero(T value, double threshold) const {
     return std::abs(value) < threshold;
 }
 
-size_t Matrix::rank() const {
-    Matrix ref = rowEchelonForm();
-    size_t r = 0;
-    for(size_t i = 0; i < ref.colSize; i++){           // each row
-        bool nonZeroRow = false;
-        for(size_t j = 0; j < ref.rowSize; j++){       // each col
-            if(!ref.isBasicallyZero(ref.get(i, j))){
-                nonZeroRow = true;
-                break;
+template<class T>
+size_t BasicMatrix<T>::rank() const {
+    if constexpr(std::is_integral<T>::value)
+        return cast<double>().rank();           // elimination needs division
+    else{
+        BasicMatrix ref = rowEchelonForm();
+        size_t r = 0;
+        for(size_t i = 0; i < ref.colSize; i++){           // each row
+            bool nonZeroRow = false;
+            for(size_t j = 0; j < ref.rowSize; j++){       // each col
+                if(!ref.isBasicallyZero(ref.get(i, j))){
+                    nonZeroRow = true;
+                    break;
+                }
             }
+            if(nonZeroRow) r++;
         }
-        if(nonZeroRow) r++;
+        return r;
     }
-    return r;
 }
 
-double Matrix::frobeniusNorm() const{
-    double sum = 0.0;
-    for(double value : data)
-        sum += value * value;
-    
-    return std::sqrt(sum);
+// Runs over the whole buffer: row padding is always zero
+template<class T>
+double BasicMatrix<T>::frobeniusNorm() const{
+    const T* values = data.data();
+    return std::sqrt(detail::sumTiles(data.size(), [&](size_t low, size_t high){
+        return detail::simd<T>().sumSquares(values + low, high - low);
+    }));
 }
 
-Matrix Matrix::clean(double threshold) const{
-    Matrix cleanMatrix = *this;
-    
-    for(double& value : cleanMatrix.data)
-        if(isBasicallyZero(value, threshold))
-            value = 0.0;
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::clean(double threshold) const&{
+    BasicMatrix cleanMatrix(rowSize, colSize, padding);
+    forEachSpan([&](size_t offset, size_t length){
+        detail::simd<T>().clean(data.data() + offset, cleanMatrix.data.data() + offset, length, threshold);
+    });
+    cleanMatrix.isAugmented = isAugmented;
     
     return cleanMatrix;
 }
 
-void Matrix::cleanInPlace(double threshold){
-    for(double& value : data)
-        if(isBasicallyZero(value))
-            value = 0.0;
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::clean(double threshold) &&{
+    cleanInPlace(threshold);
+    return std::move(*this);
 }
 
-bool operator==(const Matrix& mtx1, const Matrix& mtx2){
-    if(mtx1.rowSize != mtx2.rowSize || mtx1.colSize != mtx2.colSize)
-        return false;
-    
-    for(size_t i=0; i<mtx1.data.size(); i++)
-        if(!mtx1.isBasicallyZero(mtx1.data[i] - mtx2.data[i]))
-            return false;
-    
-    return true;
+template<class T>
+void BasicMatrix<T>::cleanInPlace(double threshold){
+    forEachSpan([&](size_t offset, size_t length){
+        detail::simd<T>().clean(data.data() + offset, data.data() + offset, length, threshold);
+    });
 }
 
-bool operator!=(const Matrix& mtx1, const Matrix& mtx2){
-    return !(mtx1 == mtx2);
+template<class T>
+bool BasicMatrix<T>::equals(const BasicMatrix& other) const{
+    if(rowSize != other.rowSize || colSize != other.colSize)
+        return false;
+    
+    std::atomic<bool> equal{true};
+    if(stride == other.stride)
+        forEachSpan([&](size_t offset, size_t length){
+            if(equal && !detail::simd<T>().allClose(data.data() + offset, other.data.data() + offset, length, 1e-10))
+                equal = false;
+        });
+    else
+        detail::forEachBand(0, colSize, rowSize, [&](size_t low, size_t high){
+            for(size_t row = low; row < high && equal; row++)
+                if(!detail::simd<T>().allClose(&get(row, 0), &other.get(row, 0), rowSize, 1e-10))
+                    equal = false;
+        });
+    return equal;
 }
 
-double Matrix::trace() const{
-    double sum = 0.0;
+template<class T>
+T BasicMatrix<T>::trace() const{
+    T sum = T(0);
     
     for(size_t i=0; i<std::min(rowSize, colSize); i++)
         sum += get(i, i);
@@ -256,91 +408,45 @@ double Matrix::trace() const{
     return sum;
 }
 
-Matrix Matrix::square() const{
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::square() const{
     return (*this) * (*this);
 }
 
-void Matrix::squareInPlace(){
+template<class T>
+void BasicMatrix<T>::squareInPlace(){
     (*this) *= (*this);
 }
 
-Matrix Matrix::operator+(double scalar) const{
-    Matrix returnMatrix(rowSize, colSize);
-    
-    for(size_t i=0; i<data.size(); i++)
-        returnMatrix.data[i] = data[i] + scalar;
-        
-    return returnMatrix;
-}
-
-Matrix operator+(double scalar, const Matrix& mtx){
-    return mtx + scalar;
-}
-
-void Matrix::operator+=(double scalar){
-    for(double& mtxValue : data)
-        mtxValue += scalar;
-}
-
-Matrix Matrix::operator-(double scalar) const{
-    Matrix returnMatrix(rowSize, colSize);
-    
-    for(size_t i=0; i<data.size(); i++)
-        returnMatrix.data[i] = data[i] - scalar;
-        
-    return returnMatrix;
-}
-
-Matrix operator-(double scalar, const Matrix& mtx){
-    Matrix returnMatrix(mtx.rowSize, mtx.colSize);
-    
-    for(size_t i=0; i<mtx.data.size(); i++)
-        returnMatrix.data[i] = scalar - mtx.data[i];
-        
-    return returnMatrix;
-}
-
-void Matrix::operator-=(double scalar){
-    for(double& mtxValue : data)
-        mtxValue -= scalar;
+template<class T>
+void BasicMatrix<T>::operator+=(T scalar){
+    forEachSpan([&](size_t offset, size_t length){
+        detail::simd<T>().addVS(data.data() + offset, scalar, data.data() + offset, length);
+    });
 }
 
-Matrix Matrix::operator*(double scalar) const{
-    Matrix returnMatrix(rowSize, colSize);
-    
-    for(size_t i=0; i<data.size(); i++)
-        returnMatrix.data[i] = data[i] * scalar;
-        
-    return returnMatrix;
+template<class T>
+void BasicMatrix<T>::operator-=(T scalar){
+    forEachSpan([&](size_t offset, size_t length){
+        detail::simd<T>().addVS(data.data() + offset, -scalar, data.data() + offset, length);
+    });
 }
 
-Matrix operator*(double scalar, const Matrix& mtx){
-    return mtx * scalar;
+template<class T>
+void BasicMatrix<T>::operator*=(T scalar){
+    forEachSpan([&](size_t offset, size_t length){
+        detail::simd<T>().mulVS(data.data() + offset, scalar, data.data() + offset, length);
+    });
 }
 
-void Matrix::operator*=(double scalar){
-    for(double& mtxValue : data)
-        mtxValue *= scalar;
-}
-
-Matrix Matrix::operator/(double scalar) const{
+template<class T>
+void BasicMatrix<T>::operator/=(T scalar){
     if(isBasicallyZero(scalar))
         throw error::NonFatalException("Division by zero in matrix-scalar division.");
     
-    Matrix returnMatrix(rowSize, colSize);
-    
-    for(size_t i=0; i<data.size(); i++)
-        returnMatrix.data[i] = data[i] / scalar;
-        
-    return returnMatrix;
-}
-
-void Matrix::operator/=(double scalar){
-    if(isBasicallyZero(scalar))
-        throw error::NonFatalException("Division by zero in matrix-scalar division.");
-    
-    for(double& mtxValue : data)
-        mtxValue /= scalar;
+    forEachSpan([&](size_t offset, size_t length){
+        detail::simd<T>().divVS(data.data() + offset, scalar, data.data() + offset, length);
+    });
 }
 
 // double Matrix::dotProduct(const Matrix& columnVector) const{
@@ -354,171 +460,336 @@ void Matrix::operator/=(double scalar){
 //     return total;
 // }
 
-Matrix Matrix::operator+(const Matrix& other) const {
-    if(rowSize != other.rowSize || colSize != other.colSize)
-        throw error::NonFatalException("Unable to add matrices, mismatching dimensions.");
-    
-    Matrix summedMatrix(rowSize, colSize);
-    
-    for(size_t i=0; i<data.size(); i++)
-        summedMatrix.data[i] = data[i] + other.data[i];
-    
-    return summedMatrix;
+template<class T>
+template<class E>
+BasicMatrix<T>::BasicMatrix(const MatrixExpr<E>& expr){
+    static_assert(std::is_same<detail::ExprValueT<E>, T>::value,
+                  "Matrix expressions cannot mix element types; convert one operand with cast<T>() first.");
+    const auto& operand = detail::wrapOperand(expr);
+    rowSize = operand.cols();
+    colSize = operand.rows();
+    stride = rowSize;
+    data.resize(rowSize * colSize);
+    detail::evaluateInto(operand, data.data(), data.size());
 }
 
-void Matrix::operator+=(const Matrix& other) {
-    if(rowSize != other.rowSize || colSize != other.colSize)
+// Takes over the storage of a packed temporary operand (the node keeps reading it; every
+// chunk is computed before it is written back, as for A = A + B)
+template<class T>
+template<class E>
+BasicMatrix<T>::BasicMatrix(MatrixExpr<E>&& expr){
+    static_assert(std::is_same<detail::ExprValueT<E>, T>::value,
+                  "Matrix expressions cannot mix element types; convert one operand with cast<T>() first.");
+    auto&& operand = detail::wrapOperand(std::move(expr));
+    BasicMatrix* owned = operand.ownedMatrix();
+    if(owned && owned->padding == Padding::None){
+        *this = std::move(*owned);
+        isAugmented = false;
+    }else{
+        rowSize = operand.cols();
+        colSize = operand.rows();
+        stride = rowSize;
+        data.resize(rowSize * colSize);
+    }
+    detail::evaluateInto(operand, data.data(), data.size());
+}
+
+template<class T>
+template<class E>
+BasicMatrix<T>& BasicMatrix<T>::operator=(MatrixExpr<E>&& expr){
+    static_assert(std::is_same<detail::ExprValueT<E>, T>::value,
+                  "Matrix expressions cannot mix element types; convert one operand with cast<T>() first.");
+    auto&& operand = detail::wrapOperand(std::move(expr));
+    BasicMatrix* owned = operand.ownedMatrix();
+    
+    // A resize can take the temporary's storage when it has this matrix's row layout and the
+    // expression does not also read this matrix, whose storage the move releases
+    if((rowSize != operand.cols() || colSize != operand.rows()) && owned && owned->stride == strideFor(operand.cols())
+       && !operand.overlaps(data.data(), data.data() + data.size())){
+        Padding policy = padding;
+        *this = std::move(*owned);
+        padding = policy;
+        isAugmented = false;
+        if(isPacked())
+            detail::evaluateInto(operand, data.data(), data.size());
+        else
+            detail::evaluateIntoView(operand, data.data(), colSize, rowSize, stride);
+        return *this;
+    }
+    return *this = static_cast<const MatrixExpr<E>&>(expr);
+}
+
+template<class T>
+template<class E>
+BasicMatrix<T>& BasicMatrix<T>::operator=(const MatrixExpr<E>& expr){
+    static_assert(std::is_same<detail::ExprValueT<E>, T>::value,
+                  "Matrix expressions cannot mix element types; convert one operand with cast<T>() first.");
+    const auto& operand = detail::wrapOperand(expr);
+    
+    if(rowSize != operand.cols() || colSize != operand.rows()){
+        // Resizing would free storage the expression still reads through a view
+        if(operand.overlaps(data.data(), data.data() + data.size())){
+            BasicMatrix result(operand.cols(), operand.rows(), padding);
+            result = expr;
+            return *this = std::move(result);
+        }
+        
+        rowSize = operand.cols();
+        colSize = operand.rows();
+        stride = strideFor(rowSize);
+        data.assign(stride * colSize, T(0));
+    }
+    if(isPacked())
+        detail::evaluateInto(operand, data.data(), data.size());
+    else
+        detail::evaluateIntoView(operand, data.data(), colSize, rowSize, stride);
+    isAugmented = false;
+    return *this;
+}
+
+template<class T>
+template<class E>
+void BasicMatrix<T>::operator+=(const MatrixExpr<E>& other) {
+    const auto& operand = detail::wrapOperand(other);
+    if(rowSize != operand.cols() || colSize != operand.rows())
         throw error::NonFatalException("Unable to add matrices, mismatching dimensions");
     
-    for(size_t i=0; i<data.size(); i++)
-        data[i] += other.data[i];
+    if(isPacked())
+        detail::accumulateInto<detail::AddOp>(operand, data.data(), data.size());
+    else
+        detail::accumulateIntoView<detail::AddOp>(operand, data.data(), colSize, rowSize, stride);
 }
 
-Matrix Matrix::operator-(const Matrix& other) const {
-    if(rowSize != other.rowSize || colSize != other.colSize)
+template<class T>
+template<class E>
+void BasicMatrix<T>::operator-=(const MatrixExpr<E>& other) {
+    const auto& operand = detail::wrapOperand(other);
+    if(rowSize != operand.cols() || colSize != operand.rows())
         throw error::NonFatalException("Unable to subtract matrices, mismatching dimensions");
     
-    Matrix subtractedMatrix(rowSize, colSize);
-    
-    for(size_t i=0; i<data.size(); i++)
-        subtractedMatrix.data[i] = data[i] - other.data[i];
-    
-    return subtractedMatrix;
+    if(isPacked())
+        detail::accumulateInto<detail::SubOp>(operand, data.data(), data.size());
+    else
+        detail::accumulateIntoView<detail::SubOp>(operand, data.data(), colSize, rowSize, stride);
 }
 
-void Matrix::operator-=(const Matrix& other) {
-    if(rowSize != other.rowSize || colSize != other.colSize)
-        throw error::NonFatalException("Unable to subtract matrices, mismatching dimensions");
+// A * B for any matrix expressions: non-Matrix operands are evaluated once, then multiplied with GEMM
+namespace detail{
+    template<class T>
+    const BasicMatrix<T>& productOperand(const MatrixExpr<BasicMatrix<T>>& matrix){
+        return matrix.derived();
+    }
+    template<class T>
+    BasicMatrixView<const std::remove_const_t<T>> productOperand(const MatrixExpr<BasicMatrixView<T>>& view){
+        return view.derived();
+    }
+    template<class E>
+    BasicMatrix<ExprValueT<E>> productOperand(const MatrixExpr<E>& expr){
+        return BasicMatrix<ExprValueT<E>>(expr);
+    }
+
+    template<class T>
+    BasicMatrix<T> multiplyViews(BasicMatrixView<const T> lhs, BasicMatrixView<const T> rhs){
+        // For A(m x n) * B(n x p) => lhs.cols() (n) must equal rhs.rows() (n)
+        if(lhs.cols() != rhs.rows())
+            throw error::NonFatalException("Unable to multiply matrices, mismatching dimensions");
+        
+        // Result has m rows and p columns
+        BasicMatrix<T> multipliedMatrix(rhs.cols(), lhs.rows());
+        
+        // Blocked, packed GEMM straight on the row-major storage (see include/Gemm.hpp),
+        // or Strassen-Winograd above the threshold when selected (see include/Strassen.hpp)
+        multiplyInto(lhs.rows(), rhs.cols(), lhs.cols(),
+                     lhs.getData(), lhs.getStride(),
+                     rhs.getData(), rhs.getStride(),
+                     multipliedMatrix.getData(), multipliedMatrix.getStride());
+        
+        return multipliedMatrix;
+    }
     
-    for(size_t i=0; i<data.size(); i++)
-        data[i] -= other.data[i];
+    // out = lhs * rhs for an out of the product's shape, overwriting its contents.
+    // When out shares storage with an operand the product goes through a temporary.
+    template<class T>
+    void multiplyViewsInto(BasicMatrixView<const T> lhs, BasicMatrixView<const T> rhs, BasicMatrixView<T> out){
+        if(lhs.cols() != rhs.rows())
+            throw error::NonFatalException("Unable to multiply matrices, mismatching dimensions");
+        if(out.rows() != lhs.rows() || out.cols() != rhs.cols())
+            throw error::NonFatalException("Unable to multiply into matrix, mismatching dimensions.");
+        
+        const T* outBegin = out.getData();
+        const T* outEnd = outBegin + (out.rows() - 1) * out.getStride() + out.cols();
+        if(MatrixRef<T>(lhs.getData(), lhs.rows(), lhs.cols(), lhs.getStride()).overlaps(outBegin, outEnd) ||
+           MatrixRef<T>(rhs.getData(), rhs.rows(), rhs.cols(), rhs.getStride()).overlaps(outBegin, outEnd)){
+            out = multiplyViews<T>(lhs, rhs);
+            return;
+        }
+        
+        multiplyInto(lhs.rows(), rhs.cols(), lhs.cols(),
+                     lhs.getData(), lhs.getStride(),
+                     rhs.getData(), rhs.getStride(),
+                     out.getData(), out.getStride());
+    }
 }
 
-Matrix Matrix::operator*(const Matrix& other) const {
-    // For A(m x n) * B(n x p) => this->rowSize (n) must equal other.colSize (n)
-    if(rowSize != other.colSize)
-        throw error::NonFatalException("Unable to multiply matrices, mismatching dimensions");
-    
-    // Result has m rows (this->colSize) and p columns (other.rowSize)
-    Matrix multipliedMatrix(other.rowSize, colSize);
-    
-    for(size_t i=0; i<colSize; i++)
-        for(size_t j=0; j<other.rowSize; j++)
-            multipliedMatrix.set(i, j, dotProduct(row(i), other.col(j)));
-    
-    return multipliedMatrix;
+template<class L, class R>
+BasicMatrix<detail::ExprValueT<L>> multiply(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs){
+    using T = detail::ExprValueT<L>;
+    static_assert(std::is_same<T, detail::ExprValueT<R>>::value,
+                  "Matrix products cannot mix element types; convert one operand with cast<T>() first.");
+    return detail::multiplyViews<T>(detail::productOperand(lhs), detail::productOperand(rhs));
+}
+
+template<class L, class R, class T>
+void multiply(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs, BasicMatrixView<T> out){
+    static_assert(std::is_same<T, detail::ExprValueT<L>>::value && std::is_same<T, detail::ExprValueT<R>>::value,
+                  "Matrix products cannot mix element types; convert one operand with cast<T>() first.");
+    detail::multiplyViewsInto<T>(detail::productOperand(lhs), detail::productOperand(rhs), out);
 }
 
-void Matrix::operator*=(const Matrix& other) {
-    if(colSize != other.rowSize)
+// A differently shaped out gets new storage (with its padding policy), filled before
+// the old storage is released, since that may be an operand
+template<class L, class R, class T>
+void multiply(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs, BasicMatrix<T>& out){
+    static_assert(std::is_same<T, detail::ExprValueT<L>>::value && std::is_same<T, detail::ExprValueT<R>>::value,
+                  "Matrix products cannot mix element types; convert one operand with cast<T>() first.");
+    auto&& left = detail::productOperand(lhs);
+    auto&& right = detail::productOperand(rhs);
+    BasicMatrixView<const T> a(left), b(right);
+    
+    if(out.getColSize() == a.rows() && out.getRowSize() == b.cols()){
+        detail::multiplyViewsInto<T>(a, b, out.view());
+        return;
+    }
+    BasicMatrix<T> product(b.cols(), a.rows(), out.getPadding());
+    detail::multiplyViewsInto<T>(a, b, product.view());
+    out = std::move(product);
+}
+
+template<class L, class R>
+BasicMatrix<detail::ExprValueT<L>> operator*(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs){
+    return multiply(lhs, rhs);
+}
+
+template<class T>
+void BasicMatrix<T>::operator*=(const BasicMatrix& other) {
+    if(rowSize != other.colSize)
         throw error::NonFatalException("Unable to multiply matrices, mismatching dimensions");
     
     *this = *this * other;
 }
 
-Matrix Matrix::operator/(const Matrix& other) const {
-    return *this * other.inverse();
+// A / B = A B^-1. For double, found by solving B^T X^T = A^T instead of inverting B
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::operator/(const BasicMatrix& other) const {
+    if(other.rowSize != other.colSize)
+        throw error::FatalException("Cannot invert a non-square matrix.");
+    if(rowSize != other.colSize)
+        throw error::NonFatalException("Unable to multiply matrices, mismatching dimensions");
+    
+    if constexpr(std::is_same<T, double>::value){
+        LU lu(other.transpose());
+        if(lu.isSingular())
+            throw error::NonFatalException("Matrix is singular, cannot invert matrix.");
+        
+        return lu.solve(transpose()).transpose();
+    }else
+        return *this * other.inverse();
 }
 
-void Matrix::operator/=(const Matrix& other) {
-    *this *= other.inverse();
+template<class T>
+void BasicMatrix<T>::operator/=(const BasicMatrix& other) {
+    *this = *this / other;
 }
 
-void Matrix::reducedREFInPlace(){
+template<class T>
+void BasicMatrix<T>::reducedREFInPlace(){
+    static_assert(!std::is_integral<T>::value, "Row reduction needs division; use cast<double>() on an integer matrix first.");
     rowEchelonFormInPlace();
     
-    // Back substitution - eliminate above pivots
-    size_t minDim = std::min(rowSize, colSize);
-    
-    // Loop backwards from last pivot to first
-    for(int i = minDim - 1; i >= 0; i--){
-        for(int k = i - 1; k >= 0; k--){
-            double factor = get(k, i);
-            
-            // Subtract factor * row i from row k
-            for(size_t j = i; j < rowSize; j++)
-                (*this)[k][j] -= factor * get(i, j);
-        }
-    }
+    // Back substitution - eliminate above pivots, a panel of pivots per GEMM update (see include/RowReduction.hpp)
+    detail::backSubstituteInPlace(data.data(), colSize, rowSize, stride);
 }
 
-Matrix Matrix::reducedREF(){
-    Matrix copy = *this;
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::reducedREF() const&{
+    BasicMatrix copy = *this;
     copy.reducedREFInPlace();
     return copy;
 }
 
-Matrix Matrix::rowEchelonForm() const{
-    Matrix copy = *this;
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::reducedREF() &&{
+    reducedREFInPlace();
+    return std::move(*this);
+}
+
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::rowEchelonForm() const&{
+    BasicMatrix copy = *this;
     copy.rowEchelonFormInPlace();
     return copy;
 }
 
-void Matrix::rowEchelonFormInPlace(){
-    size_t minDimension = std::min(rowSize, colSize);
-    
-    for(size_t i=0; i<minDimension; i++){
-        double maxVal = 0.0;
-        size_t pivotRow = i;
-        
-        for(size_t j=i; j<colSize; j++){
-            double currentValue = get(j, i);
-            
-            if(std::abs(currentValue) > maxVal){
-                maxVal = std::abs(currentValue);
-                pivotRow = j;
-            }
-        }
-        
-        if(isBasicallyZero(maxVal))
-            continue;  // Skip this pivot, move to next
-        
-        if(i != pivotRow)
-            for(size_t j=0; j<rowSize; j++)
-                std::swap(get(i, j), get(pivotRow, j));
-        
-        double pivot = get(i, i);
-        for(size_t j=i; j<rowSize; j++)
-            set(i, j, get(i, j) / pivot);
-        
-        // Eliminate below pivot
-        for(size_t k=i+1; k<colSize; k++){          // for each row below i
-            double factor = get(k, i);                   // value to eliminate in column i
-            for(size_t j=i; j<rowSize; j++)        // for each column from i onward
-                (*this)[k][j] -= factor * get(i, j); // subtract factor * pivot row
-        }
-    }
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::rowEchelonForm() &&{
+    rowEchelonFormInPlace();
+    return std::move(*this);
 }
 
+template<class T>
+void BasicMatrix<T>::rowEchelonFormInPlace(){
+    static_assert(!std::is_integral<T>::value, "Row reduction needs division; use cast<double>() on an integer matrix first.");
+    
+    // Partial pivoting per column, skipping columns without a pivot; blocked, with the
+    // trailing rows updated through GEMM (see include/RowReduction.hpp)
+    detail::rowEchelonInPlace(data.data(), colSize, rowSize, stride);
+}
 
-Matrix Matrix::identity(size_t size){
-    Matrix identity(size, size);
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::identity(size_t size){
+    BasicMatrix identity(size, size);
     
-    for(int i=0; i<size; i++){
-        identity[i][i] = 1.0;
+    for(size_t i=0; i<size; i++){
+        identity[i][i] = T(1);
     }
     return identity;
 }
 
-Matrix::RowProxy Matrix::operator[](size_t row){
-    return RowProxy(data, row, rowSize);
+template<class T>
+template<class U>
+BasicMatrix<U> BasicMatrix<T>::cast() const{
+    BasicMatrix<U> converted(rowSize, colSize, padding);
+    U* out = converted.getData();
+    for(size_t y=0; y<colSize; y++)
+        for(size_t x=0; x<rowSize; x++)
+            out[y * converted.getStride() + x] = static_cast<U>(get(y, x));
+    return converted;
 }
 
-const Matrix::RowProxy Matrix::operator[](size_t row) const{
-    return RowProxy(const_cast<std::vector<double>&>(data), row, rowSize);
+template<class T>
+typename BasicMatrix<T>::RowProxy BasicMatrix<T>::operator[](size_t row){
+    return RowProxy(data, row, stride);
 }
 
-void Matrix::operator!(){
+template<class T>
+const typename BasicMatrix<T>::RowProxy BasicMatrix<T>::operator[](size_t row) const{
+    return RowProxy(const_cast<Storage&>(data), row, stride);
+}
+
+template<class T>
+void BasicMatrix<T>::operator!(){
     inverseInPlace();
 }
 
-void Matrix::zero(){
-    for(double& mtxValue : data) mtxValue = 0.0;
+template<class T>
+void BasicMatrix<T>::zero(){
+    for(T& mtxValue : data) mtxValue = T(0);
 }
 
-Matrix Matrix::col(size_t col) const{
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::col(size_t col) const{
     // Column vector has 1 column and 'colSize' rows
-    Matrix columnVector(1, colSize);
+    BasicMatrix columnVector(1, colSize);
     
     for(size_t i=0; i<colSize; i++){
         columnVector[i][0] = get(i, col);
@@ -526,10 +797,11 @@ Matrix Matrix::col(size_t col) const{
     return columnVector;
 }
 
-Matrix Matrix::row(size_t row) const{
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::row(size_t row) const{
     // Row vector has 'rowSize' columns and 1 row
-    size_t startIdx = row * rowSize;
-    Matrix rowVector(rowSize, 1);
+    size_t startIdx = row * stride;
+    BasicMatrix rowVector(rowSize, 1);
     
     std::copy(data.begin() + startIdx, 
               data.begin() + startIdx + rowSize, 
@@ -538,43 +810,111 @@ Matrix Matrix::row(size_t row) const{
     return rowVector;
 }
 
-size_t Matrix::getRowSize() const{
+template<class T>
+size_t BasicMatrix<T>::getRowSize() const{
     return rowSize;
 }
 
-size_t Matrix::getColSize() const{
+template<class T>
+size_t BasicMatrix<T>::getColSize() const{
     return colSize;
 }
 
-void Matrix::transposeInPlace(){
-    if(rowSize == colSize) // easier transposition if square matrix
-        for(int outerIndex=0; outerIndex<rowSize; outerIndex++)
-            for(int innerIndex=outerIndex+1; innerIndex<rowSize; innerIndex++)
-                std::swap(get(outerIndex, innerIndex), get(innerIndex, outerIndex));
-            
-    else // if NOT square matrix
-        *this = transpose();
+template<class T>
+size_t BasicMatrix<T>::getStride() const{
+    return stride;
 }
 
-Matrix Matrix::transpose() const{
-    Matrix transposed(colSize, rowSize);
-    
-    for(int y=0; y<colSize; y++)
-        for(int x=0; x<rowSize; x++)
-            transposed[y][x] = get(x, y);
+template<class T>
+Padding BasicMatrix<T>::getPadding() const{
+    return padding;
+}
+
+template<class T>
+const T* BasicMatrix<T>::getData() const{
+    return data.data();
+}
+
+template<class T>
+T* BasicMatrix<T>::getData(){
+    return data.data();
+}
+
+template<class T>
+BasicMatrixView<T> BasicMatrix<T>::view(){
+    return BasicMatrixView<T>(data.data(), colSize, rowSize, stride);
+}
+
+template<class T>
+BasicMatrixView<const T> BasicMatrix<T>::view() const{
+    return BasicMatrixView<const T>(data.data(), colSize, rowSize, stride);
+}
+
+template<class T>
+BasicMatrixView<T> BasicMatrix<T>::block(size_t startRow, size_t startColumn, size_t numRows, size_t numColumns){
+    return view().block(startRow, startColumn, numRows, numColumns);
+}
+
+template<class T>
+BasicMatrixView<const T> BasicMatrix<T>::block(size_t startRow, size_t startColumn, size_t numRows, size_t numColumns) const{
+    return view().block(startRow, startColumn, numRows, numColumns);
+}
+
+// Packed storage is permuted in place; padded rows change length, so those go through a copy
+template<class T>
+void BasicMatrix<T>::transposeInPlace(){
+    if(!isPacked() || strideFor(colSize) != colSize){
+        *this = transpose();
+        return;
+    }
+    detail::transposeCyclesInPlace(data.data(), colSize, rowSize);
     
+    if(rowSize != colSize){
+        std::swap(rowSize, colSize);
+        stride = rowSize;
+        isAugmented = false;
+    }
+}
+
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::transpose() const&{
+    BasicMatrix transposed(colSize, rowSize, padding);
+    detail::transpose(data.data(), stride, colSize, rowSize, transposed.data.data(), transposed.stride);
     return transposed;
 }
 
-void Matrix::augmentInPlace(const Matrix &other){
+// Square matrices swap tiles in place; the rectangular in-place permutation is slower
+// than a copy, so those still transpose into new storage
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::transpose() &&{
+    if(rowSize != colSize)
+        return static_cast<const BasicMatrix&>(*this).transpose();
+    transposeInPlace();
+    return std::move(*this);
+}
+
+template<class T>
+void BasicMatrix<T>::transpose(BasicMatrix& out) const{
+    if(&out == this){
+        out.transposeInPlace();
+        return;
+    }
+    if(out.rowSize != colSize || out.colSize != rowSize)
+        out = BasicMatrix(colSize, rowSize, out.padding);
+    detail::transpose(data.data(), stride, colSize, rowSize, out.data.data(), out.stride);
+    out.isAugmented = false;
+}
+
+template<class T>
+void BasicMatrix<T>::augmentInPlace(const BasicMatrix &other){
     if(colSize != other.colSize)
         throw error::FatalException("Unable to augment, number of rows don't match.");
     
     size_t old_rowSize = rowSize;
     resize(colSize, old_rowSize + other.rowSize);
     
-    for(int y=0; y<colSize; y++){
-        for(int x=0; x<other.rowSize; x++){
+    for(size_t y=0; y<colSize; y++){
+        for(size_t x=0; x<other.rowSize; x++){
             set(y, x + old_rowSize, other.get(y, x));
         }
     }
@@ -582,146 +922,156 @@ void Matrix::augmentInPlace(const Matrix &other){
     isAugmented = true;
 }
 
-Matrix Matrix::augment(const Matrix &other) const{
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::augment(const BasicMatrix &other) const{
     if(colSize != other.colSize)
         throw error::FatalException("Unable to augment, number of rows don't match.");
-    Matrix augmentedMatrix(rowSize + other.getRowSize(), colSize);
+    BasicMatrix augmentedMatrix(rowSize + other.getRowSize(), colSize, padding);
     
-    for(int y=0; y<colSize; y++)
-        for(int x=0; x<rowSize; x++)
+    for(size_t y=0; y<colSize; y++)
+        for(size_t x=0; x<rowSize; x++)
             augmentedMatrix[y][x] = get(y, x);
     
-    for(int y=0; y<colSize; y++)
-        for(int x=0; x<other.rowSize; x++)
+    for(size_t y=0; y<colSize; y++)
+        for(size_t x=0; x<other.rowSize; x++)
             augmentedMatrix.set(y, rowSize + x, other.get(y, x));
     
     augmentedMatrix.isAugmented = true;
     return augmentedMatrix;
 }
 
-// Determinant using Gaussian Elimination with partial pivoting
-// Done with AI
-double Matrix::determinant() const{
+// Determinant from the LU factorization (product of U's diagonal, signed by the row swaps).
+// float and integer matrices are factored in double; complex ones by elimination on a copy.
+template<class T>
+T BasicMatrix<T>::determinant() const{
     if(rowSize != colSize)
         throw error::NonFatalException("Determinant only defined for square matrices");
     
-    size_t n = rowSize;
-    if(n == 1) return data[0];
-    if(n == 2) return data[0] * data[3] - data[1] * data[2];
-    
-    // Create working copy
-    std::vector<double> temp = data;
-    int swaps = 0;
-    
-    // Forward elimination with partial pivoting
-    for(size_t i = 0; i < n; i++) {
-        // Find pivot (max absolute value in column i, rows i to n-1)
-        size_t pivotRow = i;
-        double maxVal = std::abs(temp[i * n + i]);
-        
-        for(size_t k = i + 1; k < n; k++) {
-            double val = std::abs(temp[k * n + i]);
-            if(val > maxVal) {
-                maxVal = val;
-                pivotRow = k;
-            }
-        }
-        
-        // Check for singular matrix
-        if(isBasicallyZero(maxVal)) {
-            return 0.0;  // Determinant is zero
-        }
-        
-        // Swap rows if needed
-        if(pivotRow != i) {
-            for(size_t j = 0; j < n; j++) {
-                std::swap(temp[i * n + j], temp[pivotRow * n + j]);
+    if constexpr(std::is_same<T, double>::value)
+        return LU(*this).determinant();
+    else if constexpr(std::is_integral<T>::value)
+        return static_cast<T>(std::llround(cast<double>().determinant()));
+    else if constexpr(std::is_floating_point<T>::value)
+        return static_cast<T>(cast<double>().determinant());
+    else{
+        BasicMatrix work = *this;
+        T det = T(1);
+        for(size_t i=0; i<rowSize; i++){
+            size_t pivotRow = i;
+            for(size_t j=i+1; j<colSize; j++)
+                if(std::abs(work.get(j, i)) > std::abs(work.get(pivotRow, i)))
+                    pivotRow = j;
+            
+            if(work.get(pivotRow, i) == T(0))
+                return T(0);
+            if(pivotRow != i){
+                for(size_t j=i; j<rowSize; j++)
+                    std::swap(work.get(i, j), work.get(pivotRow, j));
+                det = -det;
             }
-            swaps++;
-        }
-        
-        // Eliminate below pivot
-        for(size_t k = i + 1; k < n; k++) {
-            double factor = temp[k * n + i] / temp[i * n + i];
             
-            for(size_t j = i; j < n; j++) {
-                temp[k * n + j] -= factor * temp[i * n + j];
+            T pivot = work.get(i, i);
+            det *= pivot;
+            for(size_t k=i+1; k<colSize; k++){
+                T factor = work.get(k, i) / pivot;
+                for(size_t j=i; j<rowSize; j++)
+                    work.get(k, j) -= factor * work.get(i, j);
             }
         }
+        return det;
     }
-    
-    // Calculate determinant (product of diagonal)
-    double det = 1.0;
-    for(size_t i = 0; i < n; i++) {
-        det *= temp[i * n + i];
-    }
-    
-    // Apply sign from row swaps
-    if(swaps % 2 == 1) {
-        det = -det;
-    }
-    
-    return det;
 }
 
-Matrix Matrix::inverse() const{
+// One LU factorization (which also detects singularity), then n triangular solves against the identity.
+// float matrices are inverted in double; complex ones by Gauss-Jordan on [A | I].
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::inverse() const&{
+    static_assert(!std::is_integral<T>::value, "Integer matrices have no integer inverse in general; use cast<double>().inverse().");
     if(rowSize != colSize)
         throw error::FatalException("Cannot invert a non-square matrix.");
     
-    if(isBasicallyZero(determinant()))
-        throw error::NonFatalException("Matrix is singular, cannot invert matrix.");
-    
-    Matrix augmented = augment(identity(colSize));
-    augmented.reducedREFInPlace();
-    
-    return augmented.submatrix(0, rowSize, colSize, rowSize);
+    if constexpr(std::is_same<T, double>::value){
+        LU lu(*this);
+        if(lu.isSingular())
+            throw error::NonFatalException("Matrix is singular, cannot invert matrix.");
+        
+        return lu.inverse();
+    }else if constexpr(std::is_floating_point<T>::value)
+        return cast<double>().inverse().template cast<T>();
+    else{
+        BasicMatrix reduced = augment(identity(rowSize)).reducedREF();
+        for(size_t i=0; i<rowSize; i++)
+            if(isBasicallyZero(reduced.get(i, i)))
+                throw error::NonFatalException("Matrix is singular, cannot invert matrix.");
+        
+        return BasicMatrix(reduced.block(0, rowSize, rowSize, rowSize));
+    }
 }
 
-Matrix Matrix::inverse(double threshold) const{
-    if(rowSize != colSize)
-        throw error::FatalException("Cannot invert a non-square matrix.");
-    
-    if(isBasicallyZero(determinant()))
-        throw error::NonFatalException("Matrix is singular, cannot invert matrix.");
-    
-    Matrix augmented = augment(identity(colSize));
-    augmented.reducedREFInPlace();
-    
-    return augmented.submatrix(0, rowSize, colSize, rowSize).clean(threshold);
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::inverse(double threshold) const{
+    return inverse().clean(threshold);
 }
 
-void Matrix::inverseInPlace(){
-    *this = inverse();
+template<class T>
+BasicMatrix<T> BasicMatrix<T>::inverse() &&{
+    inverseInPlace();
+    return std::move(*this);
 }
 
-void Matrix::inverseInPlace(double threshold){
+// For double, the LU factors live in their own buffer, so the inverse is solved
+// straight into this matrix's storage (A X = I with X starting as I)
+template<class T>
+void BasicMatrix<T>::inverseInPlace(){
+    if constexpr(std::is_same<T, double>::value){
+        if(rowSize != colSize)
+            throw error::FatalException("Cannot invert a non-square matrix.");
+        
+        LU lu(*this);
+        if(lu.isSingular())
+            throw error::NonFatalException("Matrix is singular, cannot invert matrix.");
+        
+        zero();
+        for(size_t i=0; i<rowSize; i++)
+            set(i, i, 1.0);
+        lu.solveInPlace(view());
+        isAugmented = false;
+    }else
+        *this = inverse();
+}
+
+template<class T>
+void BasicMatrix<T>::inverseInPlace(double threshold){
     *this = inverse(threshold);
 }
 
-void Matrix::print() const{
+template<class T>
+void BasicMatrix<T>::print() const{
     std::cout << toString() << std::endl;
 }
 
-std::string Matrix::toString(int precision, int tabAmount) const{
-    int width = 0;
+template<class T>
+std::string BasicMatrix<T>::toString(int precision, int tabAmount) const{
+    size_t width = 0;
     
-    for(double mtxValue : data){
-        std::ostringstream oss;
-        oss << std::fixed << std::setprecision(precision) << mtxValue;
-        std::string s = oss.str();
-        
-        if(s.length() > width)
-            width = s.length();
-    }
+    for(size_t y=0; y<colSize; y++)
+        for(size_t x=0; x<rowSize; x++){
+            std::ostringstream oss;
+            oss << std::fixed << std::setprecision(precision) << get(y, x);
+            std::string s = oss.str();
+            
+            if(s.length() > width)
+                width = s.length();
+        }
     
     std::string matrixString;
     
-    for(int y=0; y<colSize; y++){
+    for(size_t y=0; y<colSize; y++){
         for(int tab=0; tab<tabAmount; tab++)
             matrixString += '\t';
         matrixString+= "[";
                 
-        for(int x=0; x<rowSize; x++){
+        for(size_t x=0; x<rowSize; x++){
             std::ostringstream oss;
             oss << std::fixed << std::setprecision(precision) << get(y, x);
             std::string s = oss.str();
@@ -739,15 +1089,16 @@ std::string Matrix::toString(int precision, int tabAmount) const{
     return matrixString;
 }
 
-double dotProduct(const Matrix& rowVector, const Matrix& columnVector){
-    if(rowVector.rowSize != columnVector.colSize || rowVector.colSize != 1 || columnVector.rowSize != 1)
+template<class T>
+T BasicMatrix<T>::dot(const BasicMatrix& columnVector) const{
+    if(rowSize != columnVector.colSize || colSize != 1 || columnVector.rowSize != 1)
         throw error::NonFatalException("Unable to perform dot product, mismatching vectors.");
     
-    double total = 0.0;
-    for(size_t i=0; i<rowVector.rowSize; i++)
-        total += rowVector.data[i] * columnVector.data[i];
+    T total = T(0);
+    for(size_t i=0; i<rowSize; i++)
+        total += data[i] * columnVector.get(i, 0);
     
     return total;
 }
 
-}
\ No newline at end of file
+}
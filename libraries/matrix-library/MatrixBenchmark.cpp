@@ -0,0 +1,300 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <iomanip>
+#include <chrono>
+#include <functional>
+#include <string>
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include "Matrix.hpp"
+#include "include/CSVImport.hpp"
+
+// Throughput of the elementwise operations for every instruction set the CPU supports.
+// Bytes moved per element: 8 per input read + 8 per output written.
+
+double secondsFor(const std::function<void()>& op, int repetitions){
+    op(); // warm-up
+    auto start = std::chrono::steady_clock::now();
+    for(int r=0; r<repetitions; r++) op();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(end - start).count() / repetitions;
+}
+
+int main(){
+    using namespace la;
+
+    const size_t size = 1024;            // 1024 x 1024 doubles = 8 MiB per matrix
+    const int repetitions = 20;
+    const double elements = double(size) * size;
+
+    Matrix a(size, size), b(size, size);
+    for(size_t i=0; i<size; i++)
+        for(size_t j=0; j<size; j++){
+            a[i][j] = 0.5 + double((i * 31 + j * 17) % 97);
+            b[i][j] = 1.5 + double((i * 13 + j * 7) % 89);
+        }
+    Matrix c = a;
+    volatile double sink = 0.0;
+
+    struct Benchmark{
+        std::string name;
+        double bytesPerElement;
+        std::function<void()> op;
+    };
+    std::vector<Benchmark> benchmarks = {
+        {"A + B",          24, [&]{ c = a + b; }},
+        {"A - B",          24, [&]{ c = a - b; }},
+        {"A += B",         24, [&]{ c += b; }},
+        {"A + s",          16, [&]{ c = a + 2.0; }},
+        {"s - A",          16, [&]{ c = 2.0 - a; }},
+        {"A *= s",         16, [&]{ c *= 1.0000001; }},
+        {"A / s",          16, [&]{ c = a / 3.0; }},
+        {"frobeniusNorm",   8, [&]{ sink = sink + a.frobeniusNorm(); }},
+        {"clean",          16, [&]{ c.cleanInPlace(1.0); }},
+        {"A == B",         16, [&]{ sink = sink + (a == c); }},
+    };
+
+    std::vector<detail::SimdLevel> levels = {detail::SimdLevel::Scalar};
+    detail::SimdLevel detected = detail::detectSimdLevel();
+    if(detected >= detail::SimdLevel::AVX2) levels.push_back(detail::SimdLevel::AVX2);
+    if(detected >= detail::SimdLevel::AVX512) levels.push_back(detail::SimdLevel::AVX512);
+
+    std::cout << "Elementwise throughput, " << size << "x" << size << " matrices (GB/s)\n" << std::endl;
+    std::cout << std::left << std::setw(16) << "operation";
+    for(detail::SimdLevel level : levels)
+        std::cout << std::right << std::setw(10) << detail::toString(level);
+    std::cout << std::endl;
+
+    for(const Benchmark& benchmark : benchmarks){
+        std::cout << std::left << std::setw(16) << benchmark.name;
+        for(detail::SimdLevel level : levels){
+            detail::setSimdLevel(level);
+            c = a;
+            double seconds = secondsFor(benchmark.op, repetitions);
+            double gbPerSecond = elements * benchmark.bytesPerElement / seconds / 1e9;
+            std::cout << std::right << std::setw(10) << std::fixed << std::setprecision(2) << gbPerSecond;
+        }
+        std::cout << std::endl;
+    }
+
+    detail::setSimdLevel(detected);
+    std::cout << "\nDispatching to: " << detail::toString(detail::getSimdLevel()) << std::endl;
+
+    // D = A + B * 2.0 - C reads three matrices and writes one (32 bytes/element)
+    Matrix d(size, size);
+    double fused = secondsFor([&]{ d = a + b * 2.0 - c; }, repetitions);
+    double unfused = secondsFor([&]{
+        Matrix scaled = b * 2.0;
+        Matrix summed = a + scaled;
+        d = summed - c;
+    }, repetitions);
+
+    std::cout << "\nD = A + B * 2.0 - C (GB/s)" << std::endl;
+    std::cout << std::left << std::setw(16) << "fused" << std::right << std::setw(10) << elements * 32 / fused / 1e9 << std::endl;
+    std::cout << std::left << std::setw(16) << "temporaries" << std::right << std::setw(10) << elements * 32 / unfused / 1e9 << std::endl;
+
+    // Small fixed-size transforms: the same 4x4 products through la::Matrix4 and la::Matrix
+    const int transforms = 1000000;
+    Matrix4 rotation(0.0, -1.0, 0.0, 1.0,
+                     1.0,  0.0, 0.0, 2.0,
+                     0.0,  0.0, 1.0, 3.0,
+                     0.0,  0.0, 0.0, 1.0);
+    Vector4 point(1.0, 2.0, 3.0, 1.0);
+    Matrix dynamicRotation = rotation.toMatrix(), dynamicPoint = point.toMatrix();
+
+    double fixedSeconds = secondsFor([&]{
+        for(int i=0; i<transforms; i++){
+            point = rotation * point;
+            point(3, 0) = 1.0;
+        }
+    }, 1);
+    double dynamicSeconds = secondsFor([&]{
+        for(int i=0; i<transforms / 10; i++){
+            dynamicPoint = dynamicRotation * dynamicPoint;
+            dynamicPoint[3][0] = 1.0;
+        }
+    }, 1) * 10;
+    sink = sink + point(0, 0) + dynamicPoint[0][0];
+
+    std::cout << "\n4x4 transform of a point (millions per second)" << std::endl;
+    std::cout << std::left << std::setw(16) << "Matrix4" << std::right << std::setw(10) << transforms / fixedSeconds / 1e6 << std::endl;
+    std::cout << std::left << std::setw(16) << "Matrix" << std::right << std::setw(10) << transforms / dynamicSeconds / 1e6 << std::endl;
+
+    // The same product in single precision: twice the lanes per register and half the bytes
+    const size_t productSize = 512;
+    Matrix p = a.block(0, 0, productSize, productSize), q = b.block(0, 0, productSize, productSize), r(productSize, productSize);
+    FloatMatrix pf = p.cast<float>(), qf = q.cast<float>(), rf(productSize, productSize);
+    const double flops = 2.0 * productSize * productSize * productSize;
+    double doubleSeconds = secondsFor([&]{ r = p * q; }, 5);
+    double floatSeconds = secondsFor([&]{ rf = pf * qf; }, 5);
+
+    std::cout << "\n" << productSize << "x" << productSize << " product (GFLOP/s)" << std::endl;
+    std::cout << std::left << std::setw(16) << "Matrix" << std::right << std::setw(10) << flops / doubleSeconds / 1e9 << std::endl;
+    std::cout << std::left << std::setw(16) << "FloatMatrix" << std::right << std::setw(10) << flops / floatSeconds / 1e9 << std::endl;
+
+    // Matrix-vector product with 1% of the elements nonzero: CSR against the dense product
+    const size_t sparseSize = 4096;
+    COOMatrix triplets(sparseSize, sparseSize);
+    Matrix denseA(sparseSize, sparseSize), vector(1, sparseSize), product(1, sparseSize);
+    for(size_t i=0; i<sparseSize; i++){
+        vector[i][0] = 1.0 + double(i % 5);
+        for(size_t j=(i * 7) % 100; j<sparseSize; j+=100){
+            triplets.add(i, j, 0.5 + double(j % 3));
+            denseA[i][j] = 0.5 + double(j % 3);
+        }
+    }
+    CSRMatrix sparseA = triplets.toCSR();
+    double sparseSeconds = secondsFor([&]{ product = sparseA * vector; }, repetitions);
+    double denseSeconds = secondsFor([&]{ product = denseA * vector; }, repetitions);
+
+    std::cout << "\n" << sparseSize << "x" << sparseSize << " matrix-vector product, 1% nonzero (ms, MB)" << std::endl;
+    std::cout << std::left << std::setw(16) << "CSRMatrix" << std::right << std::setw(10) << sparseSeconds * 1e3
+              << std::setw(10) << sparseA.memoryBytes() / 1e6 << std::endl;
+    std::cout << std::left << std::setw(16) << "Matrix" << std::right << std::setw(10) << denseSeconds * 1e3
+              << std::setw(10) << double(sparseSize) * sparseSize * sizeof(double) / 1e6 << std::endl;
+
+    // Odd-width matrices: packed rows start at arbitrary offsets, padded rows on cache lines
+    const size_t oddSize = 1021;
+    std::cout << "\n" << oddSize << "x" << oddSize << " transpose (ms)" << std::endl;
+    for(Padding padding : {Padding::None, Padding::AlignRows}){
+        Matrix source(oddSize, oddSize, padding), target(oddSize, oddSize, padding);
+        source = a.block(0, 0, oddSize, oddSize);
+        double seconds = secondsFor([&]{ target = source.transpose(); }, repetitions);
+        std::cout << std::left << std::setw(16) << (padding == Padding::None ? "packed" : "AlignRows")
+                  << std::right << std::setw(10) << seconds * 1e3 << std::endl;
+    }
+
+    // A loop of small inverses and products: temporaries recycled by the scratch pool against fresh heap buffers
+    const size_t loopSize = 32;
+    const int iterations = 10000;
+    Matrix system = a.block(0, 0, loopSize, loopSize) + Matrix::identity(loopSize) * 1e4, state(1, loopSize);
+    auto iterate = [&]{
+        for(int i=0; i<iterations; i++){
+            state = system.inverse() * state + system * state;
+            state = state.clean(1e-12) / state.frobeniusNorm();
+        }
+    };
+    std::cout << "\n" << loopSize << "x" << loopSize << " inverse and products in a loop (us per iteration, heap allocations)" << std::endl;
+    for(size_t limit : {getScratchPoolLimit(), size_t(0)}){
+        setScratchPoolLimit(limit);
+        releaseScratchPool();
+        state[0][0] = 1.0;
+        double seconds = secondsFor(iterate, 1);
+        resetAllocationStats();
+        iterate();
+        std::cout << std::left << std::setw(16) << (limit ? "scratch pool" : "heap") << std::right << std::setw(10)
+                  << seconds / iterations * 1e6 << std::setw(10) << getAllocationStats().heapAllocations << std::endl;
+    }
+    sink = sink + state[0][0];
+
+    // Row reduction: blocked forward elimination, then back substitution, both with GEMM panel updates
+    const size_t reductionSize = 2000;
+    Matrix equations(reductionSize, reductionSize), reduced(1, 1);
+    for(size_t i=0; i<reductionSize; i++)
+        for(size_t j=0; j<reductionSize; j++)
+            equations[i][j] = 1.0 / a[i % size][j % size] + (i == j ? 1.0 : 0.0);
+    double echelonSeconds = secondsFor([&]{ reduced = equations.rowEchelonForm(); }, 1);
+    double reducedSeconds = secondsFor([&]{ reduced = equations.reducedREF(); }, 1);
+
+    std::cout << "\n" << reductionSize << "x" << reductionSize << " row reduction (s)" << std::endl;
+    std::cout << std::left << std::setw(16) << "rowEchelonForm" << std::right << std::setw(10) << echelonSeconds << std::endl;
+    std::cout << std::left << std::setw(16) << "reducedREF" << std::right << std::setw(10) << reducedSeconds << std::endl;
+
+    // Strassen-Winograd against the blocked GEMM; the largest error is relative to the classic product
+    std::cout << "\nSquare products, Strassen threshold " << getStrassenThreshold() << " (s, largest difference)" << std::endl;
+    for(size_t n : {size_t(512), size_t(1024), size_t(2048)}){
+        Matrix x(n, n), y(n, n), classic(n, n), strassen(n, n);
+        for(size_t i=0; i<n; i++)
+            for(size_t j=0; j<n; j++){
+                x[i][j] = 1.0 / a[i % size][j % size];
+                y[i][j] = 1.0 / b[j % size][i % size];
+            }
+        setMultiplyAlgorithm(MultiplyAlgorithm::Classic);
+        double classicSeconds = secondsFor([&]{ multiply(x, y, classic); }, 1);
+        setMultiplyAlgorithm(MultiplyAlgorithm::Strassen);
+        double strassenSeconds = secondsFor([&]{ multiply(x, y, strassen); }, 1);
+        setMultiplyAlgorithm(MultiplyAlgorithm::Classic);
+
+        double difference = 0.0;
+        for(size_t i=0; i<n; i++)
+            for(size_t j=0; j<n; j++)
+                difference = std::max(difference, std::abs(strassen[i][j] - classic[i][j]) / std::abs(classic[i][j]));
+        std::cout << std::left << std::setw(16) << std::to_string(n) + " classic" << std::right << std::setw(10) << classicSeconds << std::endl;
+        std::cout << std::left << std::setw(16) << std::to_string(n) + " Strassen" << std::right << std::setw(10) << strassenSeconds
+                  << std::setw(10) << std::scientific << std::setprecision(1) << difference << std::fixed << std::setprecision(2) << std::endl;
+    }
+
+    // Many small systems: one MatrixBatch (SIMD lanes across matrices) against a loop over separate Matrix objects
+    const size_t batchSize = 100000;
+    std::cout << "\n" << batchSize << " small matrices (ns per matrix)" << std::endl;
+    for(size_t n : {size_t(3), size_t(6)}){
+        MatrixBatch batch(batchSize, n, n), inverses(1, 1, 1);
+        std::vector<Matrix> matrices(batchSize, Matrix(n, n));
+        for(size_t m=0; m<batchSize; m++){
+            for(size_t i=0; i<n; i++)
+                for(size_t j=0; j<n; j++)
+                    matrices[m][i][j] = a[(m + i) % size][(m * 3 + j) % size] + (i == j ? 2.0 : 0.0);
+            batch.set(m, matrices[m]);
+        }
+        double batchInverse = secondsFor([&]{ inverses = batch.inverse(); }, 5);
+        double batchDeterminant = secondsFor([&]{ sink = sink + batch.determinants()[0]; }, 5);
+        double loopInverse = secondsFor([&]{ for(const Matrix& m : matrices) sink = sink + m.inverse()[0][0]; }, 1);
+        double loopDeterminant = secondsFor([&]{ for(const Matrix& m : matrices) sink = sink + m.determinant(); }, 1);
+        sink = sink + inverses(0, 0, 0);
+
+        std::string label = std::to_string(n) + "x" + std::to_string(n);
+        std::cout << std::left << std::setw(16) << label + " inverse" << std::right << std::setw(10) << loopInverse / batchSize * 1e9
+                  << std::setw(10) << batchInverse / batchSize * 1e9 << std::endl;
+        std::cout << std::left << std::setw(16) << label + " determinant" << std::right << std::setw(10) << loopDeterminant / batchSize * 1e9
+                  << std::setw(10) << batchDeterminant / batchSize * 1e9 << std::endl;
+    }
+
+    // Binary files: streaming save, mmap-backed load, and the zero-copy view of a float64 file
+    const std::string binaryPath = "matrix-benchmark.bin";
+    std::cout << "\n" << size << "x" << size << " binary file (ms save, ms load, MB)" << std::endl;
+    for(BinaryElement element : {BinaryElement::Float64, BinaryElement::Float32, BinaryElement::Float16}){
+        Matrix loaded(1, 1);
+        double saveSeconds = secondsFor([&]{ saveBinary(a, binaryPath, element); }, 3);
+        double loadSeconds = secondsFor([&]{ loaded = loadBinary(binaryPath); }, 3);
+        sink = sink + loaded[0][0];
+        const char* name = element == BinaryElement::Float64 ? "float64" : element == BinaryElement::Float32 ? "float32" : "float16";
+        std::cout << std::left << std::setw(16) << name << std::right << std::setw(10) << saveSeconds * 1e3
+                  << std::setw(10) << loadSeconds * 1e3 << std::setw(10) << elements * detail::binaryElementBytes(element) / 1e6 << std::endl;
+    }
+    saveBinary(a, binaryPath);
+    double viewSeconds = secondsFor([&]{ MappedMatrix mapped(binaryPath); sink = sink + mapped.view()(size - 1, size - 1); }, repetitions);
+    std::cout << std::left << std::setw(16) << "mapped view" << std::right << std::setw(10) << "" << std::setw(10) << viewSeconds * 1e3 << std::endl;
+    std::remove(binaryPath.c_str());
+
+    // CSV import: fields parsed in place from csv::Reader::readRowView() against readRow() and std::stod
+    const size_t csvSize = 1000;
+    const std::string csvPath = "matrix-benchmark.csv";
+    {
+        std::ofstream csvFile(csvPath);
+        csvFile << std::setprecision(17);
+        for(size_t i=0; i<csvSize; i++)
+            for(size_t j=0; j<csvSize; j++)
+                csvFile << a[i][j] << (j + 1 < csvSize ? ',' : '\n');
+    }
+    Matrix imported(1, 1), parsed(csvSize, csvSize);
+    double importSeconds = secondsFor([&]{ imported = loadCSV(csvPath, csv::Dialect()); }, 1);
+    double stringSeconds = secondsFor([&]{
+        csv::Reader reader;
+        reader.open(csvPath);
+        size_t row = 0;
+        while(auto fields = reader.readRow()){
+            for(size_t j=0; j<fields->size(); j++) parsed[row][j] = std::stod((*fields)[j]);
+            row++;
+        }
+    }, 1);
+    std::remove(csvPath.c_str());
+
+    std::cout << "\n" << csvSize << "x" << csvSize << " CSV import (ms)" << std::endl;
+    std::cout << std::left << std::setw(16) << "loadCSV" << std::right << std::setw(10) << importSeconds * 1e3 << std::endl;
+    std::cout << std::left << std::setw(16) << "readRow + stod" << std::right << std::setw(10) << stringSeconds * 1e3 << std::endl;
+    sink = sink + imported[0][0] + parsed[0][0];
+
+    return 0;
+}
@@ -1,5 +1,121 @@
 #include <iostream>
+#include <atomic>
+#include <cmath>
+#include <complex>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <string>
+#include <thread>
+#include <vector>
 #include "Matrix.hpp"
+#include "include/CSVImport.hpp"
+
+// Behaviour checks: each result is compared with a reference computed another way
+// (plain loops, a reconstruction, or the plain Matrix routines). main() returns 1 if any fails.
+static int failures = 0;
+
+void check(const std::string& name, bool passed){
+    std::cout << (passed ? "[pass] " : "[FAIL] ") << name << std::endl;
+    if(!passed) failures++;
+}
+
+// Reproducible values in [-1, 1)
+la::Matrix randomMatrix(size_t rows, size_t cols, uint32_t seed){
+    la::Matrix result(cols, rows);
+    uint32_t state = seed * 2654435761u + 1;
+    for(size_t i=0; i<rows; i++)
+        for(size_t j=0; j<cols; j++){
+            state = state * 1664525u + 1013904223u;
+            result[i][j] = double(state >> 8) / double(1u << 23) - 1.0;
+        }
+    return result;
+}
+
+// Largest elementwise difference (infinite when the shapes differ)
+double maxDifference(const la::Matrix& a, const la::Matrix& b){
+    if(a.getRowSize() != b.getRowSize() || a.getColSize() != b.getColSize()) return std::numeric_limits<double>::infinity();
+    double largest = 0.0;
+    for(size_t i=0; i<a.getColSize(); i++)
+        for(size_t j=0; j<a.getRowSize(); j++)
+            largest = std::max(largest, std::abs(a[i][j] - b[i][j]));
+    return largest;
+}
+
+// Triple-loop product, the reference for every product path
+la::Matrix naiveProduct(const la::Matrix& a, const la::Matrix& b){
+    la::Matrix result(b.getRowSize(), a.getColSize());
+    for(size_t i=0; i<a.getColSize(); i++)
+        for(size_t j=0; j<b.getRowSize(); j++){
+            double sum = 0.0;
+            for(size_t k=0; k<a.getRowSize(); k++) sum += a[i][k] * b[k][j];
+            result[i][j] = sum;
+        }
+    return result;
+}
+
+// Row-by-row Gauss-Jordan elimination with partial pivoting (columns without an entry above 1e-10 skipped)
+la::Matrix naiveReducedREF(la::Matrix a){
+    size_t row = 0;
+    for(size_t col=0; col<a.getRowSize() && row<a.getColSize(); col++){
+        size_t pivot = row;
+        for(size_t i=row+1; i<a.getColSize(); i++)
+            if(std::abs(a[i][col]) > std::abs(a[pivot][col])) pivot = i;
+        if(std::abs(a[pivot][col]) <= 1e-10) continue;
+        
+        for(size_t j=0; j<a.getRowSize(); j++) std::swap(a[row][j], a[pivot][j]);
+        double scale = a[row][col];
+        for(size_t j=0; j<a.getRowSize(); j++) a[row][j] /= scale;
+        for(size_t i=0; i<a.getColSize(); i++){
+            if(i == row) continue;
+            double factor = a[i][col];
+            for(size_t j=0; j<a.getRowSize(); j++) a[i][j] -= factor * a[row][j];
+        }
+        row++;
+    }
+    return a;
+}
+
+// MatrixBatch / FloatMatrixBatch of n x n matrices against the same operations on each Matrix
+template<class T>
+void checkBatch(size_t n, uint32_t seed, double tolerance){
+    const size_t count = 37;                    // several groups of lanes and a partial last group
+    la::BasicMatrixBatch<T> batch(count, n, n), rhs(count, n, 2);
+    std::vector<la::Matrix> matrices, rights;
+    for(size_t b=0; b<count; b++){
+        matrices.push_back(randomMatrix(n, n, seed + 2 * b) + la::Matrix::identity(n) * double(n));     // diagonally dominant: well conditioned in float
+        rights.push_back(randomMatrix(n, 2, seed + 2 * b + 1));
+        batch.set(b, matrices[b].cast<T>());
+        rhs.set(b, rights[b].cast<T>());
+    }
+    
+    la::BasicMatrixBatch<T> products = batch * batch, inverses = batch.inverse(), solutions = la::solve(batch, rhs);
+    std::vector<T> determinants = batch.determinants();
+    double product = 0.0, inverse = 0.0, solution = 0.0, determinant = 0.0;
+    for(size_t b=0; b<count; b++){
+        product = std::max(product, maxDifference(products.get(b).template cast<double>(), naiveProduct(matrices[b], matrices[b])));
+        inverse = std::max(inverse, maxDifference(inverses.get(b).template cast<double>(), matrices[b].inverse()));
+        solution = std::max(solution, maxDifference(solutions.get(b).template cast<double>(), la::solve(matrices[b], rights[b])));
+        double expected = matrices[b].determinant();
+        determinant = std::max(determinant, std::abs(determinants[b] - expected) / std::abs(expected));
+    }
+    std::string name = std::string(sizeof(T) == 4 ? "FloatMatrixBatch " : "MatrixBatch ") + std::to_string(n) + "x" + std::to_string(n);
+    check(name + " product, inverse, solve and determinants", product < tolerance && inverse < tolerance && solution < tolerance && determinant < tolerance);
+}
+
+// FixedMatrix<N, N> against the runtime Matrix routines (closed forms up to 4x4, elimination beyond)
+template<size_t N>
+void checkFixedMatrix(uint32_t seed){
+    la::Matrix a = randomMatrix(N, N, seed) + la::Matrix::identity(N) * 2.0, b = randomMatrix(N, N, seed + 1);
+    la::FixedMatrix<N, N> fixedA(a), fixedB(b);
+    std::string size = std::to_string(N) + "x" + std::to_string(N);
+    check("FixedMatrix " + size + " product", maxDifference((fixedA * fixedB).toMatrix(), naiveProduct(a, b)) < 1e-14);
+    check("FixedMatrix " + size + " determinant", std::abs(fixedA.determinant() - a.determinant()) < 1e-12 * std::abs(a.determinant()));
+    check("FixedMatrix " + size + " inverse", maxDifference((fixedA * fixedA.inverse()).toMatrix(), la::Matrix::identity(N)) < 1e-12);
+    check("FixedMatrix " + size + " transpose", fixedA.transpose().toMatrix() == a.transpose());
+}
 
 int main(){
     using namespace la;
@@ -33,5 +149,592 @@ int main(){
     
     std::cout << "Rank of Matrix: " << mat.rank() << std::endl;
     
-    return 0;
+    std::cout << "\nBehaviour checks:" << std::endl;
+    
+    // Blocked GEMM: edge tiles, a vector, and a product large enough to be split across threads
+    {
+        Matrix a = randomMatrix(131, 67, 1), b = randomMatrix(67, 203, 2);
+        check("GEMM 131x67 * 67x203 matches the triple loop", maxDifference(a * b, naiveProduct(a, b)) < 1e-12);
+        Matrix x = randomMatrix(67, 1, 3);
+        check("GEMM matrix-vector product matches the triple loop", maxDifference(a * x, naiveProduct(a, x)) < 1e-12);
+        Matrix c = randomMatrix(260, 260, 4), d = randomMatrix(260, 260, 5);
+        Matrix product = c;
+        product *= d;
+        check("GEMM 260x260 (parallel) and *= match the triple loop", maxDifference(product, naiveProduct(c, d)) < 1e-11);
+    }
+    
+    // Elementwise kernels at every SIMD level the CPU has, against plain loops (odd size for the tails)
+    {
+        Matrix a = randomMatrix(37, 29, 6), b = randomMatrix(37, 29, 7);
+        Matrix sum(29, 37), scaled(29, 37), cleaned = a;
+        double squares = 0.0;
+        for(size_t i=0; i<37; i++)
+            for(size_t j=0; j<29; j++){
+                sum[i][j] = a[i][j] + b[i][j];
+                scaled[i][j] = a[i][j] * 3.0;
+                squares += a[i][j] * a[i][j];
+                if(std::abs(cleaned[i][j]) < 0.25) cleaned[i][j] = 0.0;
+            }
+        
+        la::detail::SimdLevel detected = la::detail::detectSimdLevel();
+        for(la::detail::SimdLevel level : {la::detail::SimdLevel::Scalar, la::detail::SimdLevel::AVX2, la::detail::SimdLevel::AVX512}){
+            if(level > detected) continue;
+            la::detail::setSimdLevel(level);
+            std::string name = la::detail::toString(level);
+            check(name + " A + B, A - B, A * s and A / s match plain loops",
+                  maxDifference(a + b, sum) == 0.0 && maxDifference(sum - b, a) < 1e-15 &&
+                  maxDifference(a * 3.0, scaled) == 0.0 && maxDifference(scaled / 3.0, a) < 1e-15);
+            check(name + " frobeniusNorm, clean and == match plain loops",
+                  std::abs(a.frobeniusNorm() - std::sqrt(squares)) < 1e-12 && a.clean(0.25) == cleaned &&
+                  a == Matrix(a) && !(a == b));
+        }
+        la::detail::setSimdLevel(detected);
+    }
+    
+    // Fused expressions against the same arithmetic done one element at a time
+    {
+        Matrix a = randomMatrix(45, 33, 8), b = randomMatrix(45, 33, 9), c = randomMatrix(45, 33, 10);
+        Matrix expected(33, 45);
+        for(size_t i=0; i<45; i++)
+            for(size_t j=0; j<33; j++) expected[i][j] = a[i][j] + b[i][j] * 2.0 - c[i][j];
+        Matrix d = a + b * 2.0 - c;
+        check("D = A + B * 2.0 - C matches element-by-element arithmetic", maxDifference(d, expected) < 1e-15);
+        
+        Matrix aliased = a;
+        aliased = aliased + b * 2.0 - c;          // reads and writes the same storage
+        check("A = A + B * 2.0 - C (aliased) matches", maxDifference(aliased, expected) < 1e-15);
+        
+        Matrix square = randomMatrix(33, 33, 11), offset = randomMatrix(45, 33, 12);
+        check("A + B * C evaluates the product once with GEMM", maxDifference(offset + a * square, offset + naiveProduct(a, square)) < 1e-12);
+        check("(2.0 - A).eval() matches", maxDifference((2.0 - a).eval(), a * -1.0 + 2.0) == 0.0);
+    }
+    
+    // Thread pool: one thread and several give the same results, to the last bit
+    {
+        Matrix a = randomMatrix(300, 257, 13), b = randomMatrix(257, 190, 14);
+        size_t threads = la::getNumThreads();
+        la::setNumThreads(1);
+        double serialNorm = a.frobeniusNorm();
+        Matrix serialProduct = a * b, serialSum = a * 2.0 + a;
+        la::setNumThreads(4);
+        check("frobeniusNorm does not depend on the thread count", a.frobeniusNorm() == serialNorm);
+        check("products and elementwise results do not depend on the thread count",
+              maxDifference(a * b, serialProduct) == 0.0 && maxDifference(a * 2.0 + a, serialSum) == 0.0);
+        la::setNumThreads(threads);
+    }
+    
+    // LU: P A = L U (blocked path past 64 columns), solves and inverse by their residuals,
+    // the determinant against the cofactor formula
+    {
+        Matrix a = randomMatrix(150, 150, 15), b = randomMatrix(150, 7, 16);
+        la::LU lu(a);
+        Matrix permuted = a;
+        for(size_t i=0; i<150; i++)
+            for(size_t j=0; j<150; j++) std::swap(permuted[i][j], permuted[lu.getPivots()[i]][j]);
+        check("LU: P A = L U", maxDifference(permuted, lu.lower() * lu.upper()) < 1e-12);
+        check("LU solve: A X = B", maxDifference(a * lu.solve(b), b) < 1e-10);
+        check("LU inverse: A A^-1 = I", maxDifference(a * lu.inverse(), Matrix::identity(150)) < 1e-10);
+        
+        double cofactor = mat[0][0] * (mat[1][1] * mat[2][2] - mat[1][2] * mat[2][1])
+                        - mat[0][1] * (mat[1][0] * mat[2][2] - mat[1][2] * mat[2][0])
+                        + mat[0][2] * (mat[1][0] * mat[2][1] - mat[1][1] * mat[2][0]);
+        check("determinant matches the cofactor formula", std::abs(mat.determinant() - cofactor) < 1e-9 * std::abs(cofactor));
+        
+        Matrix singular({{1, 2, 3}, {2, 4, 6}, {1, 0, 1}});
+        bool threw = false;
+        try{ singular.inverse(); }catch(const la::error::NonFatalException&){ threw = true; }
+        check("singular matrix: LU flags it and inverse() throws", la::LU(singular).isSingular() && singular.determinant() == 0.0 && threw);
+    }
+    
+    // la::solve through each method: residuals for square systems, normal equations for least squares
+    {
+        Matrix a = randomMatrix(90, 90, 17), b = randomMatrix(90, 4, 18);
+        Matrix spd = a.transpose() * a + Matrix::identity(90) * 90.0;
+        for(la::SolveMethod method : {la::SolveMethod::Auto, la::SolveMethod::LU, la::SolveMethod::Cholesky, la::SolveMethod::QR}){
+            const char* name = method == la::SolveMethod::Auto ? "Auto" : method == la::SolveMethod::LU ? "LU" : method == la::SolveMethod::Cholesky ? "Cholesky" : "QR";
+            check(std::string("solve(") + name + ") on a symmetric positive definite system", maxDifference(spd * la::solve(spd, b, method), b) < 1e-10);
+        }
+        check("solve(Auto) on a general square system", maxDifference(a * la::solve(a, b), b) < 1e-9);
+        
+        Matrix tall = randomMatrix(120, 30, 19), rhs = randomMatrix(120, 2, 20);
+        Matrix x = la::solve(tall, rhs);
+        check("least squares: A^T (A X - B) = 0", maxDifference(tall.transpose() * (tall * x - rhs), Matrix(2, 30)) < 1e-10);
+        
+        Matrix factors = a, solution = b;
+        la::solveInPlace(factors, solution);
+        check("solveInPlace matches solve", maxDifference(solution, la::solve(a, b)) < 1e-10);
+        Matrix left = randomMatrix(5, 90, 21);
+        check("A / B solves instead of inverting: (A / B) B = A", maxDifference((left / a) * a, left) < 1e-10);
+    }
+    
+    // Blocked Cholesky and QR (more columns than one 64/32-column panel): reconstructions
+    {
+        Matrix a = randomMatrix(150, 150, 22);
+        Matrix spd = a.transpose() * a + Matrix::identity(150);
+        la::Cholesky chol(spd);
+        Matrix l = chol.lower();
+        check("Cholesky: L L^T = A", chol.isPositiveDefinite() && maxDifference(l * l.transpose(), spd) < 1e-10);
+        Matrix inPlace = spd;
+        check("choleskyInPlace leaves L", la::choleskyInPlace(inPlace) && maxDifference(inPlace, l) < 1e-12);
+        check("Cholesky rejects an indefinite matrix", !la::Cholesky(Matrix({{1, 2}, {2, 1}})).isPositiveDefinite());
+        
+        Matrix tall = randomMatrix(200, 130, 23);
+        la::QR qr(tall);
+        Matrix q = qr.orthogonal(), r = qr.upper();
+        check("QR: Q R = A", qr.isFullRank() && maxDifference(q * r, tall) < 1e-12);
+        check("QR: Q^T Q = I", maxDifference(q.transpose() * q, Matrix::identity(130)) < 1e-12);
+        Matrix rOnly = tall;
+        la::qrInPlace(rOnly);
+        check("qrInPlace leaves R", maxDifference(Matrix(rOnly.block(0, 0, 130, 130)), r) < 1e-12);
+        check("QR flags a rank-deficient matrix", !la::QR(Matrix({{1, 2}, {2, 4}, {3, 6}})).isFullRank());
+    }
+    
+    // Eigen and singular value decompositions: reconstructions, full and truncated
+    {
+        auto diagonal = [](const std::vector<double>& values){
+            Matrix result(values.size(), values.size());
+            for(size_t i=0; i<values.size(); i++) result[i][i] = values[i];
+            return result;
+        };
+        
+        Matrix a = randomMatrix(80, 80, 24);
+        Matrix symmetric = a + a.transpose();
+        la::SymmetricEigen eigen(symmetric);
+        Matrix v = eigen.getEigenvectors();
+        check("SymmetricEigen: A V = V diag(lambda)", maxDifference(symmetric * v, v * diagonal(eigen.getEigenvalues())) < 1e-10);
+        check("SymmetricEigen: V^T V = I", maxDifference(v.transpose() * v, Matrix::identity(80)) < 1e-12);
+        la::SymmetricEigen leading(symmetric, 5);
+        Matrix w = leading.getEigenvectors();
+        check("SymmetricEigen(A, 5): leading pairs satisfy A v = lambda v", maxDifference(symmetric * w, w * diagonal(leading.getEigenvalues())) < 1e-10);
+        
+        for(Matrix b : {randomMatrix(120, 70, 25), randomMatrix(40, 90, 26)}){
+            la::SVD svd(b);
+            Matrix u = svd.getU(), right = svd.getV();
+            std::string shape = b.getColSize() > b.getRowSize() ? "tall" : "wide";
+            check("SVD (" + shape + "): U diag(sigma) V^T = A", maxDifference(u * diagonal(svd.getSingularValues()) * right.transpose(), b) < 1e-12);
+            check("SVD (" + shape + "): V^T V = I", maxDifference(right.transpose() * right, Matrix::identity(right.getRowSize())) < 1e-12);
+        }
+        
+        // Truncated: a rank-2 matrix keeps rank 2 (A^T A would leave sigma_3 near sqrt(eps) sigma_1)
+        Matrix lowRank = randomMatrix(50, 2, 27) * randomMatrix(2, 30, 28);
+        la::SVD truncated(lowRank, 5);
+        const std::vector<double>& sigma = truncated.getSingularValues();
+        check("SVD(A, 5) of a rank-2 matrix: rank 2, sigma_3 ~ 0", truncated.rank() == 2 && sigma[2] < 1e-12 * sigma[0]);
+        la::SVD full(lowRank);
+        check("SVD(A, 5) matches the full decomposition", std::abs(sigma[0] - full.getSingularValues()[0]) < 1e-12 * sigma[0]
+                                                          && std::abs(sigma[1] - full.getSingularValues()[1]) < 1e-12 * sigma[0]);
+        Matrix u = truncated.getU(), right = truncated.getV();
+        check("SVD(A, 5): A V = U diag(sigma)", maxDifference(lowRank * right, u * diagonal(sigma)) < 1e-12);
+    }
+    
+    // Transposes (recursive and register kernels, tile swaps, cycle following) against a plain loop
+    {
+        auto naiveTranspose = [](const Matrix& a){
+            Matrix result(a.getColSize(), a.getRowSize());
+            for(size_t i=0; i<a.getColSize(); i++)
+                for(size_t j=0; j<a.getRowSize(); j++) result[j][i] = a[i][j];
+            return result;
+        };
+        
+        for(Matrix a : {randomMatrix(123, 77, 29), randomMatrix(300, 200, 30), randomMatrix(1, 45, 31)}){
+            std::string shape = std::to_string(a.getColSize()) + "x" + std::to_string(a.getRowSize());
+            Matrix expected = naiveTranspose(a);
+            check("transpose " + shape, a.transpose() == expected);
+            Matrix inPlace = a;
+            inPlace.transposeInPlace();
+            check("transposeInPlace " + shape, inPlace == expected);
+        }
+        
+        Matrix square = randomMatrix(100, 100, 32);
+        Matrix inPlace = square;
+        inPlace.transposeInPlace();
+        check("transposeInPlace 100x100 (tile swaps)", inPlace == naiveTranspose(square));
+        Matrix out(3, 3);
+        square.transpose(out);
+        check("transpose(out) resizes out", out == naiveTranspose(square));
+        check("transpose of a temporary", (square * 1.0).eval().transpose() == naiveTranspose(square));
+        
+        la::FloatMatrix single = randomMatrix(45, 70, 33).cast<float>();
+        check("FloatMatrix transpose", single.transpose().cast<double>() == naiveTranspose(single.cast<double>()));
+    }
+    
+    // Views: writes land in the parent, reads match copies of the same block
+    {
+        Matrix a = randomMatrix(60, 50, 34), b = randomMatrix(40, 30, 35);
+        Matrix original = a;
+        a.block(5, 7, 40, 30) = b * 2.0;
+        bool inside = true, outside = true;
+        for(size_t i=0; i<60; i++)
+            for(size_t j=0; j<50; j++){
+                bool inBlock = i >= 5 && i < 45 && j >= 7 && j < 37;
+                if(inBlock) inside = inside && a[i][j] == b[i - 5][j - 7] * 2.0;
+                else outside = outside && a[i][j] == original[i][j];
+            }
+        check("assigning to a block writes only that block", inside && outside);
+        
+        a.block(5, 7, 40, 30) += b;
+        check("+= through a block", maxDifference(Matrix(a.block(5, 7, 40, 30)), b * 3.0) < 1e-15);
+        
+        Matrix left(a.block(0, 0, 30, 20)), right(a.block(10, 20, 20, 25));
+        check("product of two blocks", maxDifference(multiply(a.block(0, 0, 30, 20), a.block(10, 20, 20, 25)), naiveProduct(left, right)) < 1e-12);
+        Matrix target(30, 40);
+        multiply(left, right, target.block(3, 2, 30, 25));
+        check("product written into a block", maxDifference(Matrix(target.block(3, 2, 30, 25)), naiveProduct(left, right)) < 1e-12
+                                               && target[0][0] == 0.0 && target[39][29] == 0.0);
+        
+        la::MatrixView column = a.view().col(11);
+        bool columnMatches = column.rows() == 60 && column.cols() == 1;
+        for(size_t i=0; i<60; i++) columnMatches = columnMatches && column[i][0] == a[i][11];
+        check("col(j) view reads the column", columnMatches);
+        
+        Matrix shifted = a;
+        shifted.block(0, 0, 50, 40) = shifted.block(10, 10, 50, 40);
+        check("overlapping block assignment reads before writing", maxDifference(Matrix(shifted.block(0, 0, 50, 40)), Matrix(a.block(10, 10, 50, 40))) == 0.0);
+        
+        Matrix square = randomMatrix(70, 70, 36), rhs = randomMatrix(50, 3, 37);
+        Matrix copy(square.block(10, 10, 50, 50));
+        check("LU of a block matches LU of its copy", maxDifference(la::LU(square.block(10, 10, 50, 50)).solve(rhs), la::LU(copy).solve(rhs)) < 1e-12);
+        
+        bool threw = false;
+        try{ a.block(50, 0, 20, 10); }catch(const la::error::FatalException&){ threw = true; }
+        check("out-of-range block throws", threw);
+    }
+    
+    // FixedMatrix: closed forms and unrolled loops agree with Matrix
+    {
+        checkFixedMatrix<2>(38);
+        checkFixedMatrix<3>(40);
+        checkFixedMatrix<4>(42);
+        checkFixedMatrix<5>(44);
+        
+        // Evaluated at compile time
+        constexpr la::FixedMatrix<2, 2> rotation(0.0, -1.0, 1.0, 0.0);
+        static_assert((rotation * rotation * rotation * rotation) == la::FixedMatrix<2, 2>::identity(), "constexpr product");
+        static_assert(la::FixedMatrix<3, 3, int>(2, 0, 0, 0, 3, 0, 0, 0, 4).determinant() == 24.0, "constexpr determinant");
+        
+        bool threw = false;
+        try{ la::FixedMatrix<2, 2>(Matrix({{1, 2}, {2, 4}})).inverse(); }catch(const la::error::NonFatalException&){ threw = true; }
+        check("FixedMatrix singular inverse throws", threw);
+        threw = false;
+        try{ la::FixedMatrix<2, 2> wrong(randomMatrix(2, 3, 46)); }catch(const la::error::FatalException&){ threw = true; }
+        check("FixedMatrix from a Matrix of another shape throws", threw);
+    }
+    
+    // Element types: float and int against double, complex against a plain loop
+    {
+        Matrix a = randomMatrix(70, 90, 47), b = randomMatrix(90, 50, 48);
+        la::FloatMatrix product = a.cast<float>() * b.cast<float>();
+        check("FloatMatrix product (SIMD and GEMM float kernels)", maxDifference(product.cast<double>(), naiveProduct(a, b)) < 1e-4);
+        check("FloatMatrix elementwise", maxDifference(la::FloatMatrix(a.cast<float>() * 2.0f - a.cast<float>()).cast<double>(), a) < 1e-6);
+        Matrix square = randomMatrix(20, 20, 49) + Matrix::identity(20) * 3.0;
+        check("FloatMatrix determinant (computed in double)", std::abs(square.cast<float>().determinant() - square.determinant()) < 1e-5 * std::abs(square.determinant()));
+        
+        la::IntMatrix ints(40, 30), other(20, 40);
+        for(size_t i=0; i<30; i++) for(size_t j=0; j<40; j++) ints[i][j] = int((i * 7 + j * 3) % 11) - 5;
+        for(size_t i=0; i<40; i++) for(size_t j=0; j<20; j++) other[i][j] = int((i * 5 + j) % 9) - 4;
+        la::IntMatrix intProduct = ints * other;
+        bool exact = true;
+        for(size_t i=0; i<30; i++)
+            for(size_t j=0; j<20; j++){
+                int sum = 0;
+                for(size_t k=0; k<40; k++) sum += ints[i][k] * other[k][j];
+                exact = exact && intProduct[i][j] == sum;
+            }
+        check("IntMatrix product is exact", exact);
+        check("IntMatrix determinant is rounded", la::IntMatrix({{2, 1}, {7, 4}}).determinant() == 1);
+        
+        la::ComplexMatrix c(30, 25), d(20, 30);
+        for(size_t i=0; i<25; i++) for(size_t j=0; j<30; j++) c[i][j] = {a[i][j], a[i + 25][j]};
+        for(size_t i=0; i<30; i++) for(size_t j=0; j<20; j++) d[i][j] = {b[i][j], b[i + 30][j]};
+        la::ComplexMatrix complexProduct = c * d;
+        double complexError = 0.0;
+        for(size_t i=0; i<25; i++)
+            for(size_t j=0; j<20; j++){
+                std::complex<double> sum = 0.0;
+                for(size_t k=0; k<30; k++) sum += c[i][k] * d[k][j];
+                complexError = std::max(complexError, std::abs(complexProduct[i][j] - sum));
+            }
+        check("ComplexMatrix product", complexError < 1e-12);
+        la::ComplexMatrix z = square.cast<std::complex<double>>() * std::complex<double>(0.0, 1.0);
+        la::ComplexMatrix identity = z * z.inverse();
+        double inverseError = 0.0;
+        for(size_t i=0; i<20; i++)
+            for(size_t j=0; j<20; j++) inverseError = std::max(inverseError, std::abs(identity[i][j] - (i == j ? 1.0 : 0.0)));
+        check("ComplexMatrix inverse (Gauss-Jordan)", inverseError < 1e-10);
+    }
+    
+    // Sparse formats: round trips through dense, COO, CSR and CSC, and products against dense
+    {
+        Matrix dense = randomMatrix(120, 90, 50);
+        for(size_t i=0; i<120; i++)
+            for(size_t j=0; j<90; j++)
+                if((i * 31 + j * 17) % 10 != 0) dense[i][j] = 0.0;
+        
+        la::CSRMatrix csr(dense);
+        la::CSCMatrix csc(dense);
+        check("CSR round trip through dense", csr.toDense() == dense && csr.nonZeros() == 1080);
+        check("CSC round trip through dense", csc.toDense() == dense);
+        check("CSR -> CSC -> CSR", csr.toCSC().toDense() == dense && csc.toCSR().toDense() == dense);
+        check("CSR transpose", csr.transpose().toDense() == dense.transpose());
+        
+        la::COOMatrix coo(120, 90);
+        for(size_t i=0; i<120; i++)
+            for(size_t j=0; j<90; j++)
+                if(dense[i][j] != 0.0){
+                    coo.add(i, j, dense[i][j] * 0.25);      // duplicates are summed
+                    coo.add(i, j, dense[i][j] * 0.75);
+                }
+        check("COO with duplicates -> CSR and CSC", maxDifference(coo.toCSR().toDense(), dense) < 1e-15 && maxDifference(coo.toCSC().toDense(), dense) < 1e-15);
+        
+        Matrix x = randomMatrix(90, 1, 51), xt = randomMatrix(120, 1, 52), b = randomMatrix(90, 7, 53), left = randomMatrix(5, 120, 54);
+        Matrix y(1, 120), yc(1, 120), z(1, 90), zc(1, 90);
+        csr.multiply(x.getData(), y.getData());
+        csc.multiply(x.getData(), yc.getData());
+        check("SpMV (CSR and CSC)", maxDifference(y, naiveProduct(dense, x)) < 1e-12 && maxDifference(yc, naiveProduct(dense, x)) < 1e-12);
+        csr.multiplyTransposed(xt.getData(), z.getData());
+        csc.multiplyTransposed(xt.getData(), zc.getData());
+        check("transposed SpMV (CSR and CSC)", maxDifference(z, naiveProduct(dense.transpose(), xt)) < 1e-12 && maxDifference(zc, naiveProduct(dense.transpose(), xt)) < 1e-12);
+        check("sparse * dense and dense * sparse", maxDifference(csr * b, naiveProduct(dense, b)) < 1e-12 && maxDifference(left * csc, naiveProduct(left, dense)) < 1e-12);
+        
+        auto throwsFatal = [](auto build){
+            try{ build(); }catch(const la::error::FatalException&){ return true; }
+            return false;
+        };
+        std::vector<la::SparseIndex> rows = {0, 1, 2}, cols = {0, 1, 2};
+        std::vector<double> values = {1.0, 2.0, 3.0};
+        check("fromTriplets rejects an out-of-range index", throwsFatal([&]{ la::CSRMatrix::fromTriplets(3, 2, rows, cols, values); })
+                                                           && throwsFatal([&]{ la::CSCMatrix::fromTriplets(2, 3, rows, cols, values); }));
+        check("fromTriplets rejects arrays of different lengths", throwsFatal([&]{ la::CSRMatrix::fromTriplets(3, 3, rows, cols, {1.0, 2.0}); })
+                                                                 && throwsFatal([&]{ la::CSCMatrix::fromTriplets(3, 3, rows, {0, 1}, values); }));
+        check("fromTriplets rejects an empty shape", throwsFatal([&]{ la::CSRMatrix::fromTriplets(0, 3, {}, {}, {}); })
+                                                    && throwsFatal([&]{ la::CSCMatrix::fromTriplets(3, 0, {}, {}, {}); }));
+    }
+    
+    // Padded rows: aligned row starts, zero padding, and the same results as packed storage
+    {
+        Matrix packed = randomMatrix(37, 45, 55), other = randomMatrix(45, 29, 56);
+        Matrix padded(45, 37, la::Padding::AlignRows);
+        padded.view() = packed;
+        bool aligned = padded.getStride() % 8 == 0 && padded.getStride() >= 45;
+        for(size_t i=0; i<37; i++) aligned = aligned && reinterpret_cast<uintptr_t>(padded.getData() + i * padded.getStride()) % 64 == 0;
+        check("AlignRows: every row starts on a cache line", aligned);
+        
+        bool zeroPadding = true;
+        Matrix doubled(45, 37, la::Padding::AlignRows);
+        doubled = padded * 2.0;
+        for(size_t i=0; i<37; i++)
+            for(size_t j=45; j<padded.getStride(); j++)
+                zeroPadding = zeroPadding && padded.getData()[i * padded.getStride() + j] == 0.0 && doubled.getData()[i * doubled.getStride() + j] == 0.0;
+        check("AlignRows: padding stays zero when assigned an expression", zeroPadding && doubled == packed * 2.0);
+        
+        check("padded == packed", padded == packed && padded.toString() == packed.toString());
+        check("padded product", maxDifference(padded * other, naiveProduct(packed, other)) < 1e-12);
+        Matrix paddedT = padded.transpose();
+        check("padded transpose keeps the padding", paddedT == packed.transpose() && paddedT.getPadding() == la::Padding::AlignRows);
+        Matrix inPlace = padded;
+        inPlace.transposeInPlace();
+        check("padded transposeInPlace", inPlace == packed.transpose());
+        
+        Matrix square(45, 45, la::Padding::AlignRows), rhs = randomMatrix(45, 2, 57);
+        square.view() = randomMatrix(45, 45, 58);
+        check("LU of a padded matrix", maxDifference(square * la::LU(square).solve(rhs), rhs) < 1e-10);
+    }
+    
+    // Scratch pool: a loop that has run once allocates nothing more from the heap
+    {
+        Matrix a = randomMatrix(60, 60, 59) + Matrix::identity(60) * 4.0, b = randomMatrix(60, 3, 60);
+        auto iteration = [&]{
+            Matrix inverse = a.inverse();
+            Matrix product = a * inverse;
+            Matrix x = la::solve(a, b);
+            return product[0][0] + x[0][0];
+        };
+        double sum = iteration();
+        la::resetAllocationStats();
+        for(int i=0; i<10; i++) sum += iteration();
+        la::AllocationStats stats = la::getAllocationStats();
+        check("pooled loop: no heap allocations after the first iteration", stats.heapAllocations == 0 && stats.pooledAllocations > 0 && std::isfinite(sum));
+        check("pool holds the freed buffers", stats.cachedBytes > 0 && stats.cachedBytes <= la::getScratchPoolLimit());
+        
+        la::releaseScratchPool();
+        check("releaseScratchPool empties the pool", la::getAllocationStats().cachedBytes == 0);
+        
+        size_t limit = la::getScratchPoolLimit();
+        la::setScratchPoolLimit(0);
+        la::resetAllocationStats();
+        for(int i=0; i<3; i++) sum += iteration();
+        stats = la::getAllocationStats();
+        check("setScratchPoolLimit(0) turns pooling off", stats.pooledAllocations == 0 && stats.heapAllocations > 0 && stats.cachedBytes == 0);
+        
+        // The limit bounds what all threads' pools hold together
+        la::setScratchPoolLimit(96 * 1024);
+        std::atomic<size_t> mostCached{0};
+        std::vector<std::thread> threads;
+        for(int t=0; t<4; t++)
+            threads.emplace_back([&]{
+                for(int i=0; i<3; i++){
+                    iteration();
+                    size_t total = la::getAllocationStats().totalCachedBytes;
+                    size_t seen = mostCached;
+                    while(total > seen && !mostCached.compare_exchange_weak(seen, total)){}
+                }
+            });
+        for(std::thread& thread : threads) thread.join();
+        check("scratch pools of several threads stay under the shared limit", mostCached > 0 && mostCached <= 96 * 1024);
+        la::setScratchPoolLimit(limit);
+    }
+    
+    // Moves, and assignments whose operands read the matrix being assigned
+    {
+        Matrix a = randomMatrix(50, 40, 61);
+        Matrix copy = a;
+        const double* storage = a.getData();
+        Matrix moved = std::move(a);
+        check("move takes the storage", moved.getData() == storage && moved == copy);
+        
+        Matrix x = randomMatrix(2, 3, 62), y = randomMatrix(3, 2, 63);
+        Matrix b = randomMatrix(4, 4, 64);
+        Matrix expected = Matrix(b.block(0, 0, 2, 2)) + naiveProduct(x, y);
+        
+        // With pooling off, freed storage goes straight back to the heap, so a read after the free shows up
+        size_t limit = la::getScratchPoolLimit();
+        la::setScratchPoolLimit(0);
+        b = b.block(0, 0, 2, 2) + x * y;
+        la::setScratchPoolLimit(limit);
+        check("A = A.block(...) + X * Y reads the block before resizing", maxDifference(b, expected) < 1e-15);
+        
+        Matrix c = randomMatrix(30, 30, 65), d = randomMatrix(30, 30, 66);
+        Matrix sum = naiveProduct(c, d) + d;
+        Matrix e = c * d + d;
+        check("Matrix C = A * B + D", maxDifference(e, sum) < 1e-12);
+        d = c * d + d;
+        check("D = A * B + D", maxDifference(d, sum) < 1e-12);
+    }
+    
+    // Strassen-Winograd against the classic product (a low threshold forces several levels and odd fringes)
+    {
+        Matrix a = randomMatrix(203, 171, 67), b = randomMatrix(171, 259, 68);
+        Matrix reference = naiveProduct(a, b);
+        size_t threshold = la::getStrassenThreshold(), threads = la::getNumThreads();
+        la::setMultiplyAlgorithm(la::MultiplyAlgorithm::Strassen);
+        la::setStrassenThreshold(32);
+        
+        check("Strassen (parallel top level)", maxDifference(a * b, reference) < 1e-12);
+        la::setNumThreads(1);
+        check("Strassen (serial schedule)", maxDifference(a * b, reference) < 1e-12);
+        la::setNumThreads(threads);
+        
+        la::IntMatrix ints(96, 96), other(96, 96);
+        for(size_t i=0; i<96; i++)
+            for(size_t j=0; j<96; j++){
+                ints[i][j] = int((i * 13 + j * 7) % 19) - 9;
+                other[i][j] = int((i * 3 + j * 11) % 17) - 8;
+            }
+        la::IntMatrix strassenInts = ints * other;
+        la::setMultiplyAlgorithm(la::MultiplyAlgorithm::Classic);
+        check("Strassen IntMatrix product is exact", strassenInts == ints * other);
+        
+        la::setStrassenThreshold(threshold);
+        check("switching back to Classic", la::getMultiplyAlgorithm() == la::MultiplyAlgorithm::Classic && maxDifference(a * b, reference) < 1e-12);
+    }
+    
+    // Blocked row reduction (several 64-column panels) against plain elimination
+    {
+        Matrix lowRank = randomMatrix(140, 60, 69) * randomMatrix(60, 170, 70);
+        Matrix wide = randomMatrix(90, 200, 71);
+        check("rank of a 140x170 rank-60 matrix", lowRank.rank() == 60);
+        check("rank of a 90x200 matrix", wide.rank() == 90);
+        check("reducedREF (rank deficient) matches plain elimination", maxDifference(lowRank.reducedREF(), naiveReducedREF(lowRank)) < 1e-8);
+        check("reducedREF (wide) matches plain elimination", maxDifference(wide.reducedREF(), naiveReducedREF(wide)) < 1e-9);
+        
+        Matrix ref = wide.rowEchelonForm();
+        bool upper = true;
+        for(size_t i=0; i<90; i++)
+            for(size_t j=0; j<i; j++) upper = upper && std::abs(ref[i][j]) < 1e-12;
+        check("rowEchelonForm is upper triangular with the same reduced form", upper && maxDifference(ref.reducedREF(), wide.reducedREF()) < 1e-9);
+        
+        Matrix square = randomMatrix(100, 100, 72);
+        Matrix augmented = square.augment(Matrix::identity(100));
+        Matrix inverse(augmented.reducedREF().block(0, 100, 100, 100));
+        check("reducedREF of [A | I] gives A^-1", maxDifference(square * inverse, Matrix::identity(100)) < 1e-9);
+    }
+    
+    // Matrix batches: SIMD lanes across matrices (closed forms up to 3x3, lane LU up to 8x8, Matrix beyond)
+    {
+        uint32_t seed = 73;
+        for(size_t n : {1, 2, 3, 4, 6, 8, 9}){
+            checkBatch<double>(n, seed, 1e-10);
+            checkBatch<float>(n, seed, 1e-3);
+            seed += 100;
+        }
+        
+        la::MatrixBatch singular(9, 4, 4);
+        for(size_t b=0; b<9; b++) singular.set(b, Matrix::identity(4));
+        singular.set(5, Matrix(4, 4));
+        bool threw = false;
+        try{ singular.inverse(); }catch(const la::error::NonFatalException&){ threw = true; }
+        check("MatrixBatch inverse throws when one matrix is singular", threw && singular.determinants()[5] == 0.0 && singular.determinants()[4] == 1.0);
+    }
+    
+    // Binary files (float64, float32, float16, mapped) and CSV import: save, load, compare
+    {
+        const std::string binaryPath = "matrix-user.bin", csvPath = "matrix-user.csv";
+        Matrix a = randomMatrix(70, 45, 774);
+        
+        la::saveBinary(a, binaryPath);
+        check("float64 file round trip is exact", la::loadBinary(binaryPath) == a && maxDifference(la::loadBinary(binaryPath), a) == 0.0);
+        {
+            la::MappedMatrix mapped(binaryPath);
+            check("MappedMatrix view reads the file in place", mapped.rows() == 70 && mapped.cols() == 45 && maxDifference(Matrix(mapped.view()), a) == 0.0);
+        }
+        Matrix padded(45, 70, la::Padding::AlignRows);
+        padded.view() = a;
+        la::saveBinary(padded.block(10, 5, 30, 20), binaryPath);
+        check("saving a block of a padded matrix", la::loadBinary(binaryPath) == Matrix(a.block(10, 5, 30, 20)));
+        la::saveBinary(a * 2.0, binaryPath);
+        check("saving an expression", maxDifference(la::loadBinary(binaryPath), a * 2.0) == 0.0);
+        
+        la::saveBinary(a, binaryPath, la::BinaryElement::Float32);
+        check("float32 file holds the float values", la::loadBinary(binaryPath) == a.cast<float>().cast<double>()
+                                                     && la::loadBinary<float>(binaryPath) == a.cast<float>());
+        la::saveBinary(a, binaryPath, la::BinaryElement::Float16);
+        Matrix half = la::loadBinary(binaryPath);
+        double halfError = 0.0;
+        for(size_t i=0; i<70; i++)
+            for(size_t j=0; j<45; j++) halfError = std::max(halfError, std::abs(half[i][j] - a[i][j]) / std::max(std::abs(a[i][j]), std::ldexp(1.0, -14)));
+        check("float16 file rounds to 11 significant bits", halfError <= 1.0 / 2048.0);
+        la::saveBinary(Matrix({{70000.0, -1e-8}}), binaryPath, la::BinaryElement::Float16);
+        Matrix extremes = la::loadBinary(binaryPath);
+        check("float16 saturates to infinity and flushes tiny values toward zero", std::isinf(extremes[0][0]) && std::abs(extremes[0][1]) < 1e-7);
+        
+        la::saveBinary(a, binaryPath);
+        {
+            std::ifstream in(binaryPath, std::ios::binary);
+            std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+            std::ofstream(binaryPath, std::ios::binary | std::ios::trunc).write(bytes.data(), static_cast<std::streamsize>(bytes.size() / 2));
+        }
+        bool threw = false;
+        try{ la::loadBinary(binaryPath); }catch(const la::error::NonFatalException&){ threw = true; }
+        check("a truncated file throws", threw);
+        std::remove(binaryPath.c_str());
+        
+        {
+            std::ofstream file(csvPath);
+            file << std::setprecision(17) << "x,y,z\n";
+            for(size_t i=0; i<70; i++) file << a[i][0] << ',' << a[i][1] << ',' << a[i][2] << '\n';
+        }
+        Matrix imported = la::loadCSV(csvPath);
+        check("CSV import with a sniffed header row is exact", imported == Matrix(a.block(0, 0, 70, 3)) && maxDifference(imported, Matrix(a.block(0, 0, 70, 3))) == 0.0);
+        {
+            std::ofstream file(csvPath);
+            file << "1;2;3\n4;5\n";
+        }
+        threw = false;
+        try{ la::loadCSV(csvPath); }catch(const la::error::NonFatalException&){ threw = true; }
+        check("CSV import rejects a short row", threw);
+        std::remove(csvPath.c_str());
+    }
+    
+    std::cout << (failures == 0 ? "All checks passed." : "Some checks FAILED.") << std::endl;
+    return failures == 0 ? 0 : 1;
 }
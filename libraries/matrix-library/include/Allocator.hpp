@@ -0,0 +1,270 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+// Storage allocation for la::Matrix.
+// Every matrix buffer starts on a 64-byte boundary (one cache line, one
+// AVX-512 register), so the first row's SIMD loads never straddle two lines.
+// Matrices built with Padding::AlignRows also round their row stride up to a
+// whole number of cache lines, so every row starts aligned. Buffers of at
+// least getHugePageThreshold() bytes are aligned to 2 MiB and, on Linux,
+// advised to be backed by transparent huge pages, which cuts TLB misses when
+// streaming through very large matrices.
+//
+// Freed buffers go to a per-thread scratch pool instead of back to the heap,
+// and later allocations of the same size class take them from there. The
+// temporaries that inverse(), augment(), row reduction, products and the
+// factorizations create are therefore recycled: once a loop has run once,
+// further iterations with the same shapes do no heap allocation. All pools
+// together hold at most getScratchPoolLimit() bytes, however many threads
+// (thread-pool workers included) have freed buffers; getAllocationStats()
+// counts heap allocations and pool reuses.
+
+namespace la{
+namespace detail{
+
+constexpr size_t STORAGE_ALIGNMENT = 64;                // bytes
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;      // bytes
+
+inline std::atomic<size_t>& hugePageThreshold(){
+    static std::atomic<size_t> threshold{0};            // 0 = never use huge pages
+    return threshold;
+}
+
+inline std::atomic<size_t>& scratchPoolLimit(){
+    static std::atomic<size_t> limit{64 * 1024 * 1024}; // bytes cached across all threads
+    return limit;
+}
+
+inline std::atomic<size_t>& scratchPoolBytes(){
+    static std::atomic<size_t> bytes{0};                // bytes cached across all threads
+    return bytes;
+}
+
+struct AllocationCounters{
+    std::atomic<size_t> heapAllocations{0}, heapBytes{0}, pooledAllocations{0};
+};
+
+inline AllocationCounters& allocationCounters(){
+    static AllocationCounters counters;
+    return counters;
+}
+
+// Buffer sizes are rounded up to four classes per power of two (at most 25% slack),
+// in whole cache lines, so slightly different shapes still share pooled buffers
+constexpr size_t poolSizeClass(size_t bytes){
+    if(bytes <= STORAGE_ALIGNMENT) return STORAGE_ALIGNMENT;
+    size_t power = STORAGE_ALIGNMENT;
+    while(power * 2 < bytes) power *= 2;                // power < bytes <= 2 * power
+    size_t step = std::max(power / 4, STORAGE_ALIGNMENT);
+    return (bytes + step - 1) / step * step;
+}
+
+// Freed buffers of the calling thread, by size class. A thread only ever sees a
+// handful of distinct sizes, so the buckets are searched linearly.
+class ScratchPool{
+private:
+    struct Bucket{
+        size_t bytes;
+        std::vector<void*> blocks;
+    };
+    std::vector<Bucket> buckets;
+    size_t cached = 0;                                  // bytes held in the buckets
+
+    ScratchPool() = default;
+
+    // Set once the pool is destroyed at thread exit; buffers freed later (by other
+    // thread_local or static objects) go straight back to the heap
+    static bool& destroyed(){
+        thread_local bool flag = false;
+        return flag;
+    }
+
+public:
+    ScratchPool(const ScratchPool&) = delete;
+    ScratchPool& operator=(const ScratchPool&) = delete;
+
+    ~ScratchPool(){
+        release();
+        destroyed() = true;
+    }
+
+    // The calling thread's pool, or nullptr while the thread is shutting down
+    static ScratchPool* current(){
+        if(destroyed()) return nullptr;
+        thread_local ScratchPool pool;
+        return &pool;
+    }
+
+    // A cached buffer of exactly `bytes` (a size class), or nullptr
+    void* take(size_t bytes){
+        for(Bucket& bucket : buckets)
+            if(bucket.bytes == bytes && !bucket.blocks.empty()){
+                void* block = bucket.blocks.back();
+                bucket.blocks.pop_back();
+                cached -= bytes;
+                scratchPoolBytes().fetch_sub(bytes, std::memory_order_relaxed);
+                return block;
+            }
+        return nullptr;
+    }
+
+    // Keeps the buffer for reuse; false (the caller frees it) when the pools are full
+    bool give(void* block, size_t bytes){
+        // Reserve the bytes first so threads freeing at once cannot overshoot the limit together
+        std::atomic<size_t>& total = scratchPoolBytes();
+        if(total.fetch_add(bytes, std::memory_order_relaxed) + bytes > scratchPoolLimit()){
+            total.fetch_sub(bytes, std::memory_order_relaxed);
+            return false;
+        }
+
+        try{
+            auto bucket = std::find_if(buckets.begin(), buckets.end(), [&](const Bucket& b){ return b.bytes == bytes; });
+            if(bucket == buckets.end()){
+                buckets.push_back({bytes, {}});
+                bucket = buckets.end() - 1;
+            }
+            bucket->blocks.push_back(block);
+        }catch(...){
+            total.fetch_sub(bytes, std::memory_order_relaxed);
+            throw;
+        }
+        cached += bytes;
+        return true;
+    }
+
+    void release(){
+        for(Bucket& bucket : buckets)
+            for(void* block : bucket.blocks) std::free(block);
+        buckets.clear();
+        scratchPoolBytes().fetch_sub(cached, std::memory_order_relaxed);
+        cached = 0;
+    }
+
+    size_t cachedBytes() const { return cached; }
+};
+
+template<class T>
+struct AlignedAllocator{
+    using value_type = T;
+
+    AlignedAllocator() = default;
+    template<class U>
+    AlignedAllocator(const AlignedAllocator<U>&) noexcept {}
+
+    T* allocate(size_t count){
+        if(count > std::numeric_limits<size_t>::max() / 4 / sizeof(T))      // room to round up to a size class
+            throw std::bad_array_new_length();
+
+        size_t bytes = poolSizeClass(count * sizeof(T));
+        size_t threshold = hugePageThreshold();
+        bool huge = threshold != 0 && bytes >= threshold;
+
+        // Huge-page buffers need their 2 MiB alignment, so they always come from the heap
+        if(!huge)
+            if(ScratchPool* pool = ScratchPool::current())
+                if(void* block = pool->take(bytes)){
+                    allocationCounters().pooledAllocations.fetch_add(1, std::memory_order_relaxed);
+                    return static_cast<T*>(block);
+                }
+
+        // aligned_alloc wants a multiple of the alignment; a huge buffer never ends up
+        // smaller than its size class, so it can be pooled like any other once freed
+        size_t alignment = huge ? HUGE_PAGE_SIZE : STORAGE_ALIGNMENT;
+        bytes = (bytes + alignment - 1) / alignment * alignment;
+        void* memory = std::aligned_alloc(alignment, bytes);
+        if(!memory) throw std::bad_alloc();
+
+        allocationCounters().heapAllocations.fetch_add(1, std::memory_order_relaxed);
+        allocationCounters().heapBytes.fetch_add(bytes, std::memory_order_relaxed);
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+        if(huge) madvise(memory, bytes, MADV_HUGEPAGE);     // advice only; failure leaves normal pages
+#endif
+        return static_cast<T*>(memory);
+    }
+
+    void deallocate(T* pointer, size_t count) noexcept {
+        ScratchPool* pool = ScratchPool::current();
+        try{
+            if(pool && pool->give(pointer, poolSizeClass(count * sizeof(T)))) return;
+        }catch(...){}                                   // no room for the bookkeeping: free it instead
+        std::free(pointer);
+    }
+
+    friend bool operator==(const AlignedAllocator&, const AlignedAllocator&) { return true; }
+    friend bool operator!=(const AlignedAllocator&, const AlignedAllocator&) { return false; }
+};
+
+// Scratch buffers of the algorithms: aligned and recycled through the pool like matrix storage
+template<class T>
+using ScratchVector = std::vector<T, AlignedAllocator<T>>;
+
+// Smallest row stride >= cols (in elements of T) that keeps every row start on a cache line
+template<class T>
+constexpr size_t paddedStride(size_t cols){
+    constexpr size_t perLine = (STORAGE_ALIGNMENT % sizeof(T) == 0) ? STORAGE_ALIGNMENT / sizeof(T) : 1;
+    return (cols + perLine - 1) / perLine * perLine;
+}
+
+} // namespace detail
+
+// --- Public configuration ---
+
+// Matrix buffers of at least this many bytes use huge pages where the OS supports them; 0 (the default) disables
+inline void setHugePageThreshold(size_t bytes){
+    detail::hugePageThreshold() = bytes;
+}
+
+inline size_t getHugePageThreshold(){
+    return detail::hugePageThreshold();
+}
+
+// Most bytes of freed buffers kept for reuse, summed over all threads' pools; 0 disables pooling.
+// Lowering it does not free what is already cached (see releaseScratchPool()).
+inline void setScratchPoolLimit(size_t bytes){
+    detail::scratchPoolLimit() = bytes;
+}
+
+inline size_t getScratchPoolLimit(){
+    return detail::scratchPoolLimit();
+}
+
+// Returns the calling thread's cached buffers to the heap
+inline void releaseScratchPool(){
+    if(detail::ScratchPool* pool = detail::ScratchPool::current()) pool->release();
+}
+
+// Allocation counters across all threads since the start (or the last resetAllocationStats())
+struct AllocationStats{
+    size_t heapAllocations;         // buffers obtained from the heap
+    size_t heapBytes;
+    size_t pooledAllocations;       // buffers reused from a scratch pool
+    size_t cachedBytes;             // held by the calling thread's pool right now
+    size_t totalCachedBytes;        // held by all threads' pools right now
+};
+
+inline AllocationStats getAllocationStats(){
+    detail::AllocationCounters& counters = detail::allocationCounters();
+    detail::ScratchPool* pool = detail::ScratchPool::current();
+    return {counters.heapAllocations, counters.heapBytes, counters.pooledAllocations, pool ? pool->cachedBytes() : 0,
+            detail::scratchPoolBytes()};
+}
+
+inline void resetAllocationStats(){
+    detail::AllocationCounters& counters = detail::allocationCounters();
+    counters.heapAllocations = 0;
+    counters.heapBytes = 0;
+    counters.pooledAllocations = 0;
+}
+
+} // namespace la
@@ -0,0 +1,601 @@
+#pragma once
+
+// Batches of same-sized small matrices in structure-of-arrays layout.
+// Included by Matrix.hpp after the Matrix class; use it through Matrix.hpp.
+//
+// BasicMatrixBatch<T> (MatrixBatch, FloatMatrixBatch) holds count() matrices
+// of rows() x cols() in groups of one cache line of lanes (8 doubles, 16
+// floats). A group stores each element position of its matrices as one
+// aligned line, element by element in row-major order, so element (i, j) of
+// matrix b is at getData()[(b / L) * rows() * cols() * L + (i * cols() + j) * L
+// + b % L] with L = lanesPerGroup. Keeping a group's matrices together makes
+// every kernel stream through memory once, in order, whatever the count (one
+// array per element position would spread a group over rows() * cols()
+// distant lines that alias in the cache for power-of-two counts).
+//
+// multiply, inverse, determinants and solve map SIMD lanes to matrices: one
+// vector instruction performs the same step on 8 or 16 matrices, so small
+// matrices pay no per-object allocation, dispatch or short-loop overhead.
+// The kernels use GCC/Clang vector extensions and are compiled for AVX-512,
+// AVX2 and the baseline with per-function target attributes; the level
+// chosen in include/Simd.hpp picks one at runtime (other compilers get one
+// lane). Groups are split across the thread pool. Inverses and
+// solves pivot per lane; 2x2 and 3x3 inverses and determinants use closed
+// forms as FixedMatrix does. Matrices larger than 8x8 are inverted, solved and
+// reduced one at a time with the la::Matrix routines, in parallel.
+
+#include "Allocator.hpp"
+#include "Error.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace la{
+namespace detail{
+
+constexpr size_t BATCH_LINE = 64;                       // bytes of lanes per element position in a group (one cache line)
+constexpr size_t BATCH_STATIC_SIZE = 8;                 // largest n with n x n lane kernels
+constexpr double BATCH_SINGULAR_THRESHOLD = 1e-10;      // same tolerance as LU and FixedMatrix
+
+#if defined(__GNUC__)
+#define LA_BATCH_INLINE __attribute__((always_inline)) inline
+#define LA_BATCH_UNROLL _Pragma("GCC unroll 8")
+
+// Bytes / sizeof(T) lanes, one matrix each
+template<class T, size_t Bytes>
+struct LaneVectorOf{
+    typedef T type __attribute__((vector_size(Bytes)));
+};
+#else
+#define LA_BATCH_INLINE inline
+#define LA_BATCH_UNROLL
+
+template<class T, size_t Bytes>
+struct LaneVectorOf{
+    using type = T;
+};
+#endif
+
+template<class T, size_t Bytes>
+using LaneVector = typename LaneVectorOf<T, Bytes>::type;
+
+// Values are passed by reference: vector arguments would change the ABI between target levels
+template<class V, class T>
+LA_BATCH_INLINE void loadLanes(V& v, const T* p){
+    std::memcpy(&v, p, sizeof(V));
+}
+
+template<class V, class T>
+LA_BATCH_INLINE void storeLanes(T* p, const V& v){
+    std::memcpy(p, &v, sizeof(V));
+}
+
+// 1 if the lane of a comparison mask is set, else 0 (masked with & 1 rather than compared, which
+// GCC 12 would vectorize into a select it cannot expand for AVX-512)
+template<class M>
+LA_BATCH_INLINE unsigned char laneSet(const M& mask, size_t lane){
+    if constexpr(std::is_same<M, bool>::value) return mask;
+    else return static_cast<unsigned char>(mask[lane] & 1);
+}
+
+template<class V>
+using LaneMask = decltype(std::declval<V>() < std::declval<V>());
+
+// out = mask ? a : b per lane, blending the bit patterns: a lane of a comparison mask is all
+// ones or all zeros. (The vector ?: crashes GCC 12 at -O1 and with the sanitizers.)
+template<class M, class V>
+LA_BATCH_INLINE void selectLanes(V& out, const M& mask, const V& a, const V& b){
+    if constexpr(std::is_same<M, bool>::value) out = mask ? a : b;
+    else out = (V)((mask & (M)a) | (~mask & (M)b));
+}
+
+// |v| per lane, by clearing the sign bits (-V{} has only those set)
+template<class T, class V>
+LA_BATCH_INLINE void absLanes(V& out, const V& v){
+    if constexpr(std::is_same<V, T>::value) out = v < T(0) ? -v : v;
+    else out = (V)((LaneMask<V>)v & ~(LaneMask<V>)(-V{}));
+}
+
+// Partial-pivoting LU of one group of n x n matrices (a: n * n vectors, row-major). Whole rows
+// are swapped per lane with selectLanes; a ends up holding the unit lower factor below the diagonal
+// and U on and above it. pivot[k] is the row swapped into row k, inverseDiagonal[k] = 1 / U(k, k),
+// sign is the permutation's sign, and singular marks lanes with a pivot below the threshold.
+template<class T, class V, size_t N>
+LA_BATCH_INLINE void factorLanes(V* a, V* pivot, V* inverseDiagonal, V& sign, LaneMask<V>& singular){
+    sign = V{} + T(1);
+    singular = V{} != V{};
+
+    LA_BATCH_UNROLL
+    for(size_t k = 0; k < N; k++){
+        V best, row = V{} + T(k);
+        absLanes<T>(best, a[k * N + k]);
+        LA_BATCH_UNROLL
+        for(size_t r = k + 1; r < N; r++){
+            V candidate;
+            absLanes<T>(candidate, a[r * N + k]);
+            LaneMask<V> larger = candidate > best;
+            selectLanes(best, larger, candidate, best);
+            selectLanes(row, larger, V{} + T(r), row);
+        }
+        pivot[k] = row;
+        singular = singular | (best < T(BATCH_SINGULAR_THRESHOLD));
+        selectLanes(sign, row != T(k), -sign, sign);
+
+        LA_BATCH_UNROLL
+        for(size_t r = k + 1; r < N; r++){
+            LaneMask<V> swap = row == T(r);
+            LA_BATCH_UNROLL
+            for(size_t j = 0; j < N; j++){
+                V upper = a[k * N + j], lower = a[r * N + j];
+                selectLanes(a[k * N + j], swap, lower, upper);
+                selectLanes(a[r * N + j], swap, upper, lower);
+            }
+        }
+
+        inverseDiagonal[k] = T(1) / a[k * N + k];
+        LA_BATCH_UNROLL
+        for(size_t r = k + 1; r < N; r++){
+            V factor = a[r * N + k] * inverseDiagonal[k];
+            a[r * N + k] = factor;
+            LA_BATCH_UNROLL
+            for(size_t j = k + 1; j < N; j++) a[r * N + j] -= factor * a[k * N + j];
+        }
+    }
+}
+
+// Solves A x = b in place for one right-hand side (b: n vectors) with the factors of factorLanes
+template<class T, class V, size_t N>
+LA_BATCH_INLINE void substituteLanes(const V* a, const V* pivot, const V* inverseDiagonal, V* b){
+    LA_BATCH_UNROLL
+    for(size_t k = 0; k < N; k++)
+        LA_BATCH_UNROLL
+        for(size_t r = k + 1; r < N; r++){
+            LaneMask<V> swap = pivot[k] == T(r);
+            V upper = b[k], lower = b[r];
+            selectLanes(b[k], swap, lower, upper);
+            selectLanes(b[r], swap, upper, lower);
+        }
+
+    LA_BATCH_UNROLL
+    for(size_t r = 1; r < N; r++)
+        LA_BATCH_UNROLL
+        for(size_t k = 0; k < r; k++) b[r] -= a[r * N + k] * b[k];
+
+    LA_BATCH_UNROLL
+    for(size_t step = 0; step < N; step++){
+        size_t r = N - 1 - step;
+        LA_BATCH_UNROLL
+        for(size_t k = r + 1; k < N; k++) b[r] -= a[r * N + k] * b[k];
+        b[r] *= inverseDiagonal[r];
+    }
+}
+
+// Determinants of the 1x1, 2x2 and 3x3 matrices in one group (a: n * n vectors)
+template<class T, class V, size_t N>
+LA_BATCH_INLINE void closedFormDeterminant(const V* a, V& det){
+    if constexpr(N == 1) det = a[0];
+    else if constexpr(N == 2) det = a[0] * a[3] - a[1] * a[2];
+    else det = a[0] * (a[4] * a[8] - a[5] * a[7])
+             - a[1] * (a[3] * a[8] - a[5] * a[6])
+             + a[2] * (a[3] * a[7] - a[4] * a[6]);
+}
+
+// The kernels below run over groups [begin, end) of matrices stored as described at the top of the file,
+// each group as BATCH_LINE / sizeof(V) vectors of lanes
+
+template<class T, class V>
+LA_BATCH_INLINE void multiplyLanes(const T* a, const T* b, T* c, size_t rows, size_t inner, size_t cols,
+                                   size_t begin, size_t end){
+    constexpr size_t group = BATCH_LINE / sizeof(T), lanes = sizeof(V) / sizeof(T);
+    for(size_t g = begin; g < end; g++)
+        for(size_t v = 0; v < group; v += lanes){
+            const T* x = a + g * rows * inner * group + v;
+            const T* y = b + g * inner * cols * group + v;
+            T* z = c + g * rows * cols * group + v;
+            for(size_t i = 0; i < rows; i++)
+                for(size_t j = 0; j < cols; j++){
+                    V sum = V{}, left, right;
+                    for(size_t k = 0; k < inner; k++){
+                        loadLanes(left, x + (i * inner + k) * group);
+                        loadLanes(right, y + (k * cols + j) * group);
+                        sum += left * right;
+                    }
+                    storeLanes(z + (i * cols + j) * group, sum);
+                }
+        }
+}
+
+template<class T, class V, size_t N>
+LA_BATCH_INLINE void determinantLanes(const T* in, T* out, size_t begin, size_t end){
+    constexpr size_t group = BATCH_LINE / sizeof(T), lanes = sizeof(V) / sizeof(T);
+    for(size_t g = begin; g < end; g++)
+        for(size_t v = 0; v < group; v += lanes){
+            const T* source = in + g * N * N * group + v;
+            V a[N * N];
+            LA_BATCH_UNROLL
+            for(size_t p = 0; p < N * N; p++) loadLanes(a[p], source + p * group);
+
+            V det;
+            if constexpr(N <= 3){
+                closedFormDeterminant<T, V, N>(a, det);
+            }else{
+                // Product of the pivots; 0 for lanes LU marks singular, as LU::determinant() does
+                V pivot[N], inverseDiagonal[N], sign;
+                LaneMask<V> singular;
+                factorLanes<T, V, N>(a, pivot, inverseDiagonal, sign, singular);
+                det = sign;
+                LA_BATCH_UNROLL
+                for(size_t k = 0; k < N; k++) det *= a[k * N + k];
+                selectLanes(det, singular, V{}, det);
+            }
+            storeLanes(out + g * group + v, det);
+        }
+}
+
+template<class T, class V, size_t N>
+LA_BATCH_INLINE void inverseLanes(const T* in, T* out, unsigned char* singularLanes, size_t begin, size_t end){
+    constexpr size_t group = BATCH_LINE / sizeof(T), lanes = sizeof(V) / sizeof(T);
+    for(size_t g = begin; g < end; g++)
+        for(size_t v = 0; v < group; v += lanes){
+            const T* source = in + g * N * N * group + v;
+            T* target = out + g * N * N * group + v;
+            V a[N * N];
+            LA_BATCH_UNROLL
+            for(size_t p = 0; p < N * N; p++) loadLanes(a[p], source + p * group);
+
+            LaneMask<V> singular;
+            if constexpr(N <= 3){
+                // Adjugate over the determinant, singular when |det| is below the threshold
+                V det;
+                closedFormDeterminant<T, V, N>(a, det);
+                V magnitude;
+                absLanes<T>(magnitude, det);
+                singular = magnitude < T(BATCH_SINGULAR_THRESHOLD);
+                V scale = T(1) / det;
+                V inverse[N * N];
+                if constexpr(N == 1){
+                    inverse[0] = scale;
+                }else if constexpr(N == 2){
+                    inverse[0] = a[3] * scale;  inverse[1] = -a[1] * scale;
+                    inverse[2] = -a[2] * scale; inverse[3] = a[0] * scale;
+                }else{
+                    inverse[0] = (a[4] * a[8] - a[5] * a[7]) * scale;
+                    inverse[1] = (a[2] * a[7] - a[1] * a[8]) * scale;
+                    inverse[2] = (a[1] * a[5] - a[2] * a[4]) * scale;
+                    inverse[3] = (a[5] * a[6] - a[3] * a[8]) * scale;
+                    inverse[4] = (a[0] * a[8] - a[2] * a[6]) * scale;
+                    inverse[5] = (a[2] * a[3] - a[0] * a[5]) * scale;
+                    inverse[6] = (a[3] * a[7] - a[4] * a[6]) * scale;
+                    inverse[7] = (a[1] * a[6] - a[0] * a[7]) * scale;
+                    inverse[8] = (a[0] * a[4] - a[1] * a[3]) * scale;
+                }
+                LA_BATCH_UNROLL
+                for(size_t p = 0; p < N * N; p++) storeLanes(target + p * group, inverse[p]);
+            }else{
+                // Column c of the inverse solves A x = e_c
+                V pivot[N], inverseDiagonal[N], sign;
+                factorLanes<T, V, N>(a, pivot, inverseDiagonal, sign, singular);
+                LA_BATCH_UNROLL
+                for(size_t c = 0; c < N; c++){
+                    V x[N];
+                    LA_BATCH_UNROLL
+                    for(size_t r = 0; r < N; r++) x[r] = V{} + T(r == c ? 1 : 0);
+                    substituteLanes<T, V, N>(a, pivot, inverseDiagonal, x);
+                    LA_BATCH_UNROLL
+                    for(size_t r = 0; r < N; r++) storeLanes(target + (r * N + c) * group, x[r]);
+                }
+            }
+            for(size_t lane = 0; lane < lanes; lane++) singularLanes[g * group + v + lane] = laneSet(singular, lane);
+        }
+}
+
+// x (n x rhs per matrix) = A^-1 b; b and x may be the same batch
+template<class T, class V, size_t N>
+LA_BATCH_INLINE void solveLanes(const T* in, const T* b, T* x, size_t rhs, unsigned char* singularLanes,
+                                size_t begin, size_t end){
+    constexpr size_t group = BATCH_LINE / sizeof(T), lanes = sizeof(V) / sizeof(T);
+    for(size_t g = begin; g < end; g++)
+        for(size_t v = 0; v < group; v += lanes){
+            const T* source = in + g * N * N * group + v;
+            V a[N * N], pivot[N], inverseDiagonal[N], sign;
+            LaneMask<V> singular;
+            LA_BATCH_UNROLL
+            for(size_t p = 0; p < N * N; p++) loadLanes(a[p], source + p * group);
+            factorLanes<T, V, N>(a, pivot, inverseDiagonal, sign, singular);
+
+            const T* right = b + g * N * rhs * group + v;
+            T* solution = x + g * N * rhs * group + v;
+            for(size_t c = 0; c < rhs; c++){
+                V column[N];
+                LA_BATCH_UNROLL
+                for(size_t r = 0; r < N; r++) loadLanes(column[r], right + (r * rhs + c) * group);
+                substituteLanes<T, V, N>(a, pivot, inverseDiagonal, column);
+                LA_BATCH_UNROLL
+                for(size_t r = 0; r < N; r++) storeLanes(solution + (r * rhs + c) * group, column[r]);
+            }
+            for(size_t lane = 0; lane < lanes; lane++) singularLanes[g * group + v + lane] = laneSet(singular, lane);
+        }
+}
+
+// One instantiation of every lane kernel per instruction set; the tag selects the overload
+struct PortableLanes{ static constexpr size_t bytes = 16; };
+struct Avx2Lanes{ static constexpr size_t bytes = 32; };
+struct Avx512Lanes{ static constexpr size_t bytes = 64; };
+
+#define LA_BATCH_KERNELS(Tag, attribute)                                                                    \
+template<class T>                                                                                           \
+attribute void multiplyGroups(Tag, const T* a, const T* b, T* c, size_t rows, size_t inner, size_t cols,   \
+                              size_t begin, size_t end){                                                    \
+    multiplyLanes<T, LaneVector<T, Tag::bytes>>(a, b, c, rows, inner, cols, begin, end);                   \
+}                                                                                                           \
+template<class T, size_t N>                                                                                 \
+attribute void determinantGroups(Tag, const T* in, T* out, size_t begin, size_t end){                      \
+    determinantLanes<T, LaneVector<T, Tag::bytes>, N>(in, out, begin, end);                                \
+}                                                                                                           \
+template<class T, size_t N>                                                                                 \
+attribute void inverseGroups(Tag, const T* in, T* out, unsigned char* singular, size_t begin, size_t end){ \
+    inverseLanes<T, LaneVector<T, Tag::bytes>, N>(in, out, singular, begin, end);                          \
+}                                                                                                           \
+template<class T, size_t N>                                                                                 \
+attribute void solveGroups(Tag, const T* in, const T* b, T* x, size_t rhs, unsigned char* singular,        \
+                           size_t begin, size_t end){                                                       \
+    solveLanes<T, LaneVector<T, Tag::bytes>, N>(in, b, x, rhs, singular, begin, end);                      \
+}
+
+LA_BATCH_KERNELS(PortableLanes, )
+#if LA_SIMD_X86
+LA_BATCH_KERNELS(Avx2Lanes, __attribute__((target("avx2,fma"))))
+LA_BATCH_KERNELS(Avx512Lanes, __attribute__((target("avx512f"))))
+#endif
+
+#undef LA_BATCH_KERNELS
+#undef LA_BATCH_UNROLL
+#undef LA_BATCH_INLINE
+
+// f(tag) with the tag of the current SIMD level
+template<class F>
+inline void withLaneKernels(F&& f){
+#if LA_SIMD_X86
+    switch(getSimdLevel()){
+        case SimdLevel::AVX512: f(Avx512Lanes{}); return;
+        case SimdLevel::AVX2:   f(Avx2Lanes{});   return;
+        default: break;
+    }
+#endif
+    f(PortableLanes{});
+}
+
+// f(std::integral_constant<size_t, n>{}) for 1 <= n <= BATCH_STATIC_SIZE; false for other n
+template<class F>
+inline bool withStaticSize(size_t n, F&& f){
+    switch(n){
+        case 1: f(std::integral_constant<size_t, 1>{}); return true;
+        case 2: f(std::integral_constant<size_t, 2>{}); return true;
+        case 3: f(std::integral_constant<size_t, 3>{}); return true;
+        case 4: f(std::integral_constant<size_t, 4>{}); return true;
+        case 5: f(std::integral_constant<size_t, 5>{}); return true;
+        case 6: f(std::integral_constant<size_t, 6>{}); return true;
+        case 7: f(std::integral_constant<size_t, 7>{}); return true;
+        case 8: f(std::integral_constant<size_t, 8>{}); return true;
+        default: return false;
+    }
+}
+
+} // namespace detail
+
+template<class T>
+class BasicMatrixBatch{
+    static_assert(std::is_floating_point<T>::value, "Matrix batches hold float or double elements.");
+
+public:
+    using value_type = T;
+    static constexpr size_t lanesPerGroup = detail::BATCH_LINE / sizeof(T);
+
+private:
+    size_t numMatrices, numRows, numCols, numGroups;
+    std::vector<T, detail::AlignedAllocator<T>> data;       // lanes past count() stay zero
+
+    size_t elements() const { return numRows * numCols; }
+    size_t offset(size_t index, size_t row, size_t col) const{
+        return (index / lanesPerGroup * elements() + row * numCols + col) * lanesPerGroup + index % lanesPerGroup;
+    }
+
+    // body(begin, end) over ranges of groups on the thread pool
+    template<class F>
+    void forEachGroup(size_t workPerMatrix, F&& body) const{
+        detail::forEachBand(0, numGroups, lanesPerGroup * workPerMatrix, body);
+    }
+
+    void clearPadding(){
+        size_t used = numMatrices % lanesPerGroup;
+        if(used == 0) return;
+        T* last = data.data() + (numGroups - 1) * elements() * lanesPerGroup;
+        for(size_t p = 0; p < elements(); p++) std::fill(last + p * lanesPerGroup + used, last + (p + 1) * lanesPerGroup, T(0));
+    }
+
+    // Throws NonFatalException naming the first matrix the kernels marked singular
+    void checkSingular(const detail::ScratchVector<unsigned char>& singular, const char* action) const{
+        auto found = std::find(singular.begin(), singular.begin() + numMatrices, 1);
+        if(found != singular.begin() + numMatrices)
+            throw error::NonFatalException("Matrix " + std::to_string(found - singular.begin()) +
+                                           " of the batch is singular, cannot " + action + ".");
+    }
+
+    template<class U>
+    friend BasicMatrixBatch<U> solve(const BasicMatrixBatch<U>& a, const BasicMatrixBatch<U>& b);
+
+public:
+    // count matrices of rows x cols, all zero
+    BasicMatrixBatch(size_t count, size_t rows, size_t cols) : numMatrices(count), numRows(rows), numCols(cols){
+        if(count < 1 || rows < 1 || cols < 1)
+            throw error::FatalException("Batch size and matrix dimensions must be greater than 0");
+        numGroups = (count + lanesPerGroup - 1) / lanesPerGroup;
+        data.assign(numGroups * lanesPerGroup * elements(), T(0));
+    }
+
+    // count copies of one matrix
+    BasicMatrixBatch(size_t count, BasicMatrixView<const T> matrix) : BasicMatrixBatch(count, matrix.rows(), matrix.cols()){
+        for(size_t b = 0; b < count; b++) set(b, matrix);
+    }
+
+    size_t count() const { return numMatrices; }
+    size_t rows() const { return numRows; }
+    size_t cols() const { return numCols; }
+    size_t groups() const { return numGroups; }            // count() rounded up to whole groups
+    T* getData() { return data.data(); }
+    const T* getData() const { return data.data(); }
+
+    T& operator()(size_t index, size_t row, size_t col) { return data[offset(index, row, col)]; }
+    const T& operator()(size_t index, size_t row, size_t col) const { return data[offset(index, row, col)]; }
+
+    // Copies a matrix (or view) into slot index; throws FatalException if its shape differs
+    void set(size_t index, BasicMatrixView<const T> matrix){
+        if(matrix.rows() != numRows || matrix.cols() != numCols)
+            throw error::FatalException("Mismatching dimensions passed to matrix batch.");
+        T* target = data.data() + offset(index, 0, 0);
+        for(size_t i = 0; i < numRows; i++)
+            for(size_t j = 0; j < numCols; j++) target[(i * numCols + j) * lanesPerGroup] = matrix(i, j);
+    }
+
+    BasicMatrix<T> get(size_t index) const{
+        BasicMatrix<T> matrix(numCols, numRows);
+        const T* source = data.data() + offset(index, 0, 0);
+        for(size_t i = 0; i < numRows; i++)
+            for(size_t j = 0; j < numCols; j++) matrix[i][j] = source[(i * numCols + j) * lanesPerGroup];
+        return matrix;
+    }
+
+    // Throws NonFatalException if any matrix is singular (|det| below 1e-10 up to 3x3, a pivot beyond)
+    BasicMatrixBatch inverse() const{
+        if(numRows != numCols)
+            throw error::FatalException("Cannot invert a non-square matrix.");
+
+        BasicMatrixBatch result(numMatrices, numRows, numCols);
+        size_t n = numRows;
+        detail::ScratchVector<unsigned char> singular(numGroups * lanesPerGroup, 0);
+
+        bool vectorized = detail::withStaticSize(n, [&](auto size){
+            forEachGroup(n * n * n, [&](size_t begin, size_t end){
+                detail::withLaneKernels([&](auto lanes){
+                    detail::inverseGroups<T, decltype(size)::value>(lanes, data.data(), result.data.data(), singular.data(), begin, end);
+                });
+            });
+        });
+        if(!vectorized)
+            detail::forEachBand(0, numMatrices, n * n * n, [&](size_t low, size_t high){
+                for(size_t b = low; b < high; b++)
+                    try{
+                        result.set(b, get(b).inverse());
+                    }catch(const error::NonFatalException&){
+                        singular[b] = 1;
+                    }
+            });
+
+        checkSingular(singular, "invert matrix");
+        result.clearPadding();
+        return result;
+    }
+
+    // One determinant per matrix
+    std::vector<T> determinants() const{
+        if(numRows != numCols)
+            throw error::NonFatalException("Determinant only defined for square matrices");
+
+        size_t n = numRows;
+        detail::ScratchVector<T> values(numGroups * lanesPerGroup);
+        bool vectorized = detail::withStaticSize(n, [&](auto size){
+            forEachGroup(n * n * n, [&](size_t begin, size_t end){
+                detail::withLaneKernels([&](auto lanes){
+                    detail::determinantGroups<T, decltype(size)::value>(lanes, data.data(), values.data(), begin, end);
+                });
+            });
+        });
+        if(!vectorized)
+            detail::forEachBand(0, numMatrices, n * n * n, [&](size_t low, size_t high){
+                for(size_t b = low; b < high; b++) values[b] = static_cast<T>(get(b).determinant());
+            });
+
+        return std::vector<T>(values.begin(), values.begin() + numMatrices);
+    }
+};
+
+using MatrixBatch = BasicMatrixBatch<double>;
+using FloatMatrixBatch = BasicMatrixBatch<float>;
+
+// out[b] = a[b] * b[b] for every matrix; out is reshaped if needed and may be a or b
+template<class T>
+void multiply(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b, BasicMatrixBatch<T>& out){
+    if(a.count() != b.count())
+        throw error::NonFatalException("Unable to multiply batches holding different numbers of matrices.");
+    if(a.cols() != b.rows())
+        throw error::NonFatalException("Unable to multiply matrices, mismatching dimensions");
+
+    if(&out == &a || &out == &b || out.count() != a.count() || out.rows() != a.rows() || out.cols() != b.cols()){
+        BasicMatrixBatch<T> product(a.count(), a.rows(), b.cols());
+        multiply(a, b, product);
+        out = std::move(product);
+        return;
+    }
+
+    detail::forEachBand(0, a.groups(), BasicMatrixBatch<T>::lanesPerGroup * a.rows() * a.cols() * b.cols(), [&](size_t low, size_t high){
+        detail::withLaneKernels([&](auto lanes){
+            detail::multiplyGroups<T>(lanes, a.getData(), b.getData(), out.getData(), a.rows(), a.cols(), b.cols(), low, high);
+        });
+    });
+}
+
+template<class T>
+BasicMatrixBatch<T> multiply(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b){
+    BasicMatrixBatch<T> product(a.count(), a.rows(), b.cols());
+    multiply(a, b, product);
+    return product;
+}
+
+template<class T>
+BasicMatrixBatch<T> operator*(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b){
+    return multiply(a, b);
+}
+
+// X with a[i] X[i] = b[i] for every matrix (square a, any number of right-hand-side columns in b),
+// by LU with partial pivoting per lane; throws NonFatalException if any a[i] is singular
+template<class T>
+BasicMatrixBatch<T> solve(const BasicMatrixBatch<T>& a, const BasicMatrixBatch<T>& b){
+    if(a.rows() != a.cols())
+        throw error::FatalException("Cannot solve with a non-square matrix.");
+    if(a.count() != b.count() || a.rows() != b.rows())
+        throw error::NonFatalException("Unable to solve system, mismatching dimensions.");
+
+    BasicMatrixBatch<T> x(b.count(), b.rows(), b.cols());
+    size_t n = a.rows(), rhs = b.cols();
+    detail::ScratchVector<unsigned char> singular(a.groups() * BasicMatrixBatch<T>::lanesPerGroup, 0);
+
+    bool vectorized = detail::withStaticSize(n, [&](auto size){
+        a.forEachGroup(n * n * (n + rhs), [&](size_t begin, size_t end){
+            detail::withLaneKernels([&](auto lanes){
+                detail::solveGroups<T, decltype(size)::value>(lanes, a.getData(), b.getData(), x.getData(), rhs,
+                                                               singular.data(), begin, end);
+            });
+        });
+    });
+    if(!vectorized)
+        detail::forEachBand(0, a.count(), n * n * (n + rhs), [&](size_t low, size_t high){
+            for(size_t i = low; i < high; i++)
+                try{
+                    x.set(i, solve(a.get(i).template cast<double>(), b.get(i).template cast<double>(), SolveMethod::LU).template cast<T>());
+                }catch(const error::NonFatalException&){
+                    singular[i] = 1;
+                }
+        });
+
+    a.checkSingular(singular, "solve system");
+    x.clearPadding();
+    return x;
+}
+
+} // namespace la
@@ -0,0 +1,425 @@
+#pragma once
+
+// Binary matrix files: a 64-byte header followed by the elements in row-major order.
+// Included by Matrix.hpp after the Matrix class; use it through Matrix.hpp.
+//
+// saveBinary() streams a matrix (or view or expression) to disk, optionally
+// narrowing the elements to float32 or float16 (half the size, or a quarter;
+// float16 keeps about 3 significant digits and saturates to infinity above
+// 65504). MappedMatrix opens a file read-only through mmap (POSIX; elsewhere
+// the file is read into memory): nothing is read until it is used, view()
+// gives a zero-copy ConstMatrixView of a float64 file, and toMatrix()
+// converts any file to a Matrix, in parallel bands of rows. The header is
+// 64 bytes, so the mapped elements start on a cache line. Files use the
+// byte order of the machine that wrote them; loading one written with the
+// other byte order throws.
+
+#include "Allocator.hpp"
+#include "Error.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define LA_BINARY_MMAP 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#define LA_BINARY_MMAP 0
+#endif
+
+namespace la{
+
+// Element type stored in a binary matrix file
+enum class BinaryElement : uint32_t { Float64 = 0, Float32 = 1, Float16 = 2 };
+
+namespace detail{
+
+constexpr char BINARY_MAGIC[8] = {'L', 'A', 'M', 'A', 'T', 'R', 'I', 'X'};
+constexpr uint32_t BINARY_VERSION = 1;
+constexpr uint32_t BINARY_BYTE_ORDER = 0x01020304;     // reads back as 0x04030201 on the other byte order
+constexpr size_t BINARY_CHUNK_BYTES = 1 << 20;          // conversion buffer of saveBinary()
+
+struct BinaryHeader{
+    char magic[8];
+    uint32_t version;
+    uint32_t byteOrder;
+    uint32_t element;       // BinaryElement
+    uint32_t reserved;
+    uint64_t rows;
+    uint64_t cols;
+    unsigned char padding[24];
+};
+static_assert(sizeof(BinaryHeader) == 64, "The binary header must keep the elements cache-line aligned.");
+
+inline size_t binaryElementBytes(BinaryElement element){
+    switch(element){
+        case BinaryElement::Float64: return 8;
+        case BinaryElement::Float32: return 4;
+        case BinaryElement::Float16: return 2;
+    }
+    return 0;
+}
+
+// IEEE 754 binary16 <-> binary32, rounding to nearest even; overflow saturates to infinity
+inline uint16_t floatToHalf(float value){
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    uint32_t sign = (bits >> 16) & 0x8000, exponent = (bits >> 23) & 0xff, mantissa = bits & 0x7fffff;
+
+    if(exponent == 0xff) return static_cast<uint16_t>(sign | 0x7c00 | (mantissa ? 0x200 : 0));
+    int halfExponent = static_cast<int>(exponent) - 127 + 15;
+    if(halfExponent >= 31) return static_cast<uint16_t>(sign | 0x7c00);
+
+    uint32_t half, rest, halfway;
+    if(halfExponent <= 0){
+        // Subnormal: the implicit bit joins the mantissa, which is shifted below the exponent range
+        if(halfExponent < -10) return static_cast<uint16_t>(sign);
+        mantissa |= 0x800000;
+        uint32_t shift = static_cast<uint32_t>(14 - halfExponent);
+        half = mantissa >> shift;
+        rest = mantissa & ((1u << shift) - 1);
+        halfway = 1u << (shift - 1);
+    }else{
+        half = (static_cast<uint32_t>(halfExponent) << 10) | (mantissa >> 13);
+        rest = mantissa & 0x1fff;
+        halfway = 0x1000;
+    }
+    if(rest > halfway || (rest == halfway && (half & 1))) half++;      // a carry rounds up into the exponent
+    return static_cast<uint16_t>(sign | half);
+}
+
+inline float halfToFloat(uint16_t half){
+    uint32_t sign = static_cast<uint32_t>(half & 0x8000) << 16, exponent = (half >> 10) & 0x1f, mantissa = half & 0x3ff;
+    uint32_t bits;
+    if(exponent == 0x1f) bits = sign | 0x7f800000 | (mantissa << 13);
+    else if(exponent != 0) bits = sign | ((exponent + 112) << 23) | (mantissa << 13);
+    else{
+        float value = static_cast<float>(mantissa) * 5.9604644775390625e-8f;     // subnormal: mantissa * 2^-24
+        return sign ? -value : value;
+    }
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+#if LA_SIMD_X86
+// F16C converts 8 halves per instruction (same rounding as floatToHalf); every AVX2 CPU has it
+inline bool hasF16C(){
+    static const bool supported = __builtin_cpu_supports("f16c");
+    return supported;
+}
+
+template<class T>
+__attribute__((target("avx,f16c"))) void encodeHalvesF16C(const T* values, unsigned char* out, size_t count){
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        float block[8];
+        for(size_t k = 0; k < 8; k++) block[k] = static_cast<float>(values[i + k]);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i * 2), _mm256_cvtps_ph(_mm256_loadu_ps(block), _MM_FROUND_TO_NEAREST_INT));
+    }
+    for(; i < count; i++){
+        uint16_t value = floatToHalf(static_cast<float>(values[i]));
+        std::memcpy(out + i * 2, &value, 2);
+    }
+}
+
+template<class T>
+__attribute__((target("avx,f16c"))) void decodeHalvesF16C(const unsigned char* source, T* out, size_t count){
+    size_t i = 0;
+    for(; i + 8 <= count; i += 8){
+        float block[8];
+        _mm256_storeu_ps(block, _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(source + i * 2))));
+        for(size_t k = 0; k < 8; k++) out[i + k] = static_cast<T>(block[k]);
+    }
+    for(; i < count; i++){
+        uint16_t value;
+        std::memcpy(&value, source + i * 2, 2);
+        out[i] = static_cast<T>(halfToFloat(value));
+    }
+}
+#endif
+
+// count elements of source (stored as element) -> T
+template<class T>
+void decodeElements(const unsigned char* source, BinaryElement element, T* out, size_t count){
+    switch(element){
+        case BinaryElement::Float64:
+            for(size_t i = 0; i < count; i++){
+                double value;
+                std::memcpy(&value, source + i * 8, 8);
+                out[i] = static_cast<T>(value);
+            }
+            break;
+        case BinaryElement::Float32:
+            for(size_t i = 0; i < count; i++){
+                float value;
+                std::memcpy(&value, source + i * 4, 4);
+                out[i] = static_cast<T>(value);
+            }
+            break;
+        case BinaryElement::Float16:
+#if LA_SIMD_X86
+            if(hasF16C()){
+                decodeHalvesF16C(source, out, count);
+                break;
+            }
+#endif
+            for(size_t i = 0; i < count; i++){
+                uint16_t value;
+                std::memcpy(&value, source + i * 2, 2);
+                out[i] = static_cast<T>(halfToFloat(value));
+            }
+            break;
+    }
+}
+
+// count elements of T -> out (as element)
+template<class T>
+void encodeElements(const T* values, BinaryElement element, unsigned char* out, size_t count){
+    switch(element){
+        case BinaryElement::Float64:
+            for(size_t i = 0; i < count; i++){
+                double value = static_cast<double>(values[i]);
+                std::memcpy(out + i * 8, &value, 8);
+            }
+            break;
+        case BinaryElement::Float32:
+            for(size_t i = 0; i < count; i++){
+                float value = static_cast<float>(values[i]);
+                std::memcpy(out + i * 4, &value, 4);
+            }
+            break;
+        case BinaryElement::Float16:
+#if LA_SIMD_X86
+            if(hasF16C()){
+                encodeHalvesF16C(values, out, count);
+                break;
+            }
+#endif
+            for(size_t i = 0; i < count; i++){
+                uint16_t value = floatToHalf(static_cast<float>(values[i]));
+                std::memcpy(out + i * 2, &value, 2);
+            }
+            break;
+    }
+}
+
+template<class T>
+void writeBinary(BasicMatrixView<const T> view, const std::string& path, BinaryElement element){
+    size_t rows = view.rows(), cols = view.cols(), elementBytes = binaryElementBytes(element);
+    if(elementBytes == 0)
+        throw error::FatalException("Unknown binary element type.");
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if(!file)
+        throw error::FatalException("Unable to open \"" + path + "\" for writing.");
+
+    BinaryHeader header{};
+    std::memcpy(header.magic, BINARY_MAGIC, sizeof(header.magic));
+    header.version = BINARY_VERSION;
+    header.byteOrder = BINARY_BYTE_ORDER;
+    header.element = static_cast<uint32_t>(element);
+    header.rows = rows;
+    header.cols = cols;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    bool native = elementBytes == sizeof(T);
+    if(native && view.getStride() == cols){
+        file.write(reinterpret_cast<const char*>(view.getData()), static_cast<std::streamsize>(rows * cols * sizeof(T)));
+    }else if(native){
+        for(size_t r = 0; r < rows && file; r++)
+            file.write(reinterpret_cast<const char*>(view.getData() + r * view.getStride()), static_cast<std::streamsize>(cols * sizeof(T)));
+    }else{
+        // Narrowed rows are gathered into one buffer of about BINARY_CHUNK_BYTES per write
+        size_t rowBytes = cols * elementBytes, rowsPerChunk = std::max<size_t>(1, BINARY_CHUNK_BYTES / rowBytes);
+        ScratchVector<unsigned char> buffer(std::min(rows, rowsPerChunk) * rowBytes);
+        for(size_t r0 = 0; r0 < rows && file; r0 += rowsPerChunk){
+            size_t r1 = std::min(rows, r0 + rowsPerChunk);
+            forEachBand(r0, r1, cols, [&](size_t low, size_t high){
+                for(size_t r = low; r < high; r++)
+                    encodeElements(view.getData() + r * view.getStride(), element, buffer.data() + (r - r0) * rowBytes, cols);
+            });
+            file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>((r1 - r0) * rowBytes));
+        }
+    }
+
+    file.flush();
+    if(!file)
+        throw error::NonFatalException("Failed to write matrix to \"" + path + "\".");
+}
+
+} // namespace detail
+
+// Writes matrix (a Matrix, view or expression) to path, replacing the file, as element. Rows
+// already in the stored type go out without conversion; expressions are evaluated first.
+// Throws FatalException if the file cannot be opened and NonFatalException if a write fails.
+template<class E>
+void saveBinary(const MatrixExpr<E>& matrix, const std::string& path, BinaryElement element = BinaryElement::Float64){
+    using T = detail::ExprValueT<E>;
+    static_assert(std::is_floating_point<T>::value, "Binary matrix files hold float or double elements; use cast<double>() first.");
+    if constexpr(std::is_same<E, BasicMatrix<T>>::value || std::is_same<E, BasicMatrixView<T>>::value ||
+                 std::is_same<E, BasicMatrixView<const T>>::value)
+        detail::writeBinary(BasicMatrixView<const T>(matrix.derived()), path, element);
+    else
+        detail::writeBinary(BasicMatrixView<const T>(BasicMatrix<T>(matrix)), path, element);
+}
+
+// A binary matrix file opened read-only. The file is memory-mapped where mmap exists, so opening
+// costs no reads and pages come in as the elements are used; the mapping lives as long as the object.
+class MappedMatrix{
+private:
+    std::string path;
+    const unsigned char* bytes = nullptr;       // the whole file
+    size_t fileBytes = 0;
+#if !LA_BINARY_MMAP
+    detail::ScratchVector<unsigned char> contents;
+#endif
+    detail::BinaryHeader header{};
+
+    void release() noexcept{
+#if LA_BINARY_MMAP
+        if(bytes) munmap(const_cast<unsigned char*>(bytes), fileBytes);
+#endif
+        bytes = nullptr;
+        fileBytes = 0;
+    }
+
+    // Throws NonFatalException unless the file holds a complete matrix of a known element type
+    void validate(){
+        if(fileBytes < sizeof(header))
+            throw error::NonFatalException("\"" + path + "\" is too short to be a binary matrix file.");
+        std::memcpy(&header, bytes, sizeof(header));
+        if(std::memcmp(header.magic, detail::BINARY_MAGIC, sizeof(header.magic)) != 0)
+            throw error::NonFatalException("\"" + path + "\" is not a binary matrix file.");
+        if(header.byteOrder != detail::BINARY_BYTE_ORDER)
+            throw error::NonFatalException("\"" + path + "\" was written with a different byte order.");
+        if(header.version != detail::BINARY_VERSION || detail::binaryElementBytes(static_cast<BinaryElement>(header.element)) == 0)
+            throw error::NonFatalException("\"" + path + "\" uses an unsupported binary matrix format.");
+        if(header.rows < 1 || header.cols < 1)
+            throw error::NonFatalException("\"" + path + "\" holds an empty matrix.");
+        size_t elementBytes = detail::binaryElementBytes(element());
+        if(header.cols > (fileBytes - sizeof(header)) / elementBytes / header.rows)
+            throw error::NonFatalException("\"" + path + "\" is truncated.");
+    }
+
+public:
+    // Throws FatalException if the file cannot be opened and NonFatalException if it is not a valid matrix file
+    explicit MappedMatrix(const std::string& filePath) : path(filePath){
+#if LA_BINARY_MMAP
+        int descriptor = ::open(path.c_str(), O_RDONLY);
+        if(descriptor < 0)
+            throw error::FatalException("Unable to open \"" + path + "\" for reading.");
+        struct stat status;
+        if(fstat(descriptor, &status) != 0){
+            ::close(descriptor);
+            throw error::FatalException("Unable to read the size of \"" + path + "\".");
+        }
+        fileBytes = static_cast<size_t>(status.st_size);
+        if(fileBytes > 0){
+            void* mapping = mmap(nullptr, fileBytes, PROT_READ, MAP_PRIVATE, descriptor, 0);
+            if(mapping == MAP_FAILED){
+                ::close(descriptor);
+                throw error::FatalException("Unable to map \"" + path + "\" into memory.");
+            }
+            bytes = static_cast<const unsigned char*>(mapping);
+            madvise(mapping, fileBytes, MADV_SEQUENTIAL);    // advice only
+        }
+        ::close(descriptor);
+#else
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file)
+            throw error::FatalException("Unable to open \"" + path + "\" for reading.");
+        fileBytes = static_cast<size_t>(file.tellg());
+        contents.resize(fileBytes);
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(contents.data()), static_cast<std::streamsize>(fileBytes));
+        if(!file)
+            throw error::FatalException("Unable to read \"" + path + "\".");
+        bytes = contents.data();
+#endif
+        try{
+            validate();
+        }catch(...){
+            release();
+            throw;
+        }
+    }
+
+    MappedMatrix(const MappedMatrix&) = delete;
+    MappedMatrix& operator=(const MappedMatrix&) = delete;
+
+    MappedMatrix(MappedMatrix&& other) noexcept
+        : path(std::move(other.path)), bytes(other.bytes), fileBytes(other.fileBytes),
+#if !LA_BINARY_MMAP
+          contents(std::move(other.contents)),
+#endif
+          header(other.header){
+        other.bytes = nullptr;
+        other.fileBytes = 0;
+    }
+
+    MappedMatrix& operator=(MappedMatrix&& other) noexcept{
+        if(this != &other){
+            release();
+            path = std::move(other.path);
+            bytes = other.bytes;
+            fileBytes = other.fileBytes;
+#if !LA_BINARY_MMAP
+            contents = std::move(other.contents);
+#endif
+            header = other.header;
+            other.bytes = nullptr;
+            other.fileBytes = 0;
+        }
+        return *this;
+    }
+
+    ~MappedMatrix(){ release(); }
+
+    size_t rows() const { return static_cast<size_t>(header.rows); }
+    size_t cols() const { return static_cast<size_t>(header.cols); }
+    BinaryElement element() const { return static_cast<BinaryElement>(header.element); }
+    const void* getData() const { return bytes + sizeof(header); }     // row-major elements of element()
+
+    // Zero-copy view of a float64 file; throws FatalException for narrowed files (use toMatrix())
+    ConstMatrixView view() const{
+        if(element() != BinaryElement::Float64)
+            throw error::FatalException("Only float64 matrix files can be viewed in place; use toMatrix().");
+        return ConstMatrixView(reinterpret_cast<const double*>(bytes + sizeof(header)), rows(), cols());
+    }
+
+    // The file's matrix converted to T (float or double)
+    template<class T = double>
+    BasicMatrix<T> toMatrix() const{
+        static_assert(std::is_floating_point<T>::value, "Binary matrix files hold float or double elements.");
+        BasicMatrix<T> matrix(cols(), rows());
+        size_t rowBytes = cols() * detail::binaryElementBytes(element());
+        const unsigned char* source = bytes + sizeof(header);
+        T* out = matrix.getData();
+        detail::forEachBand(0, rows(), cols(), [&](size_t low, size_t high){
+            for(size_t r = low; r < high; r++)
+                detail::decodeElements(source + r * rowBytes, element(), out + r * matrix.getStride(), cols());
+        });
+        return matrix;
+    }
+};
+
+// Reads a binary matrix file into a new matrix
+template<class T = double>
+BasicMatrix<T> loadBinary(const std::string& path){
+    return MappedMatrix(path).toMatrix<T>();
+}
+
+} // namespace la
+
+#undef LA_BINARY_MMAP
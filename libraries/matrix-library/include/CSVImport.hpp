@@ -0,0 +1,98 @@
+#pragma once
+
+// Numeric CSV import through the csv-library (libraries/csv-library, which must sit next to this
+// library). Not included by Matrix.hpp, so the matrix library keeps no dependency on the csv
+// library: include this header instead of (or after) Matrix.hpp to use loadCSV().
+//
+// Rows are read with csv::Reader::readRowView(), which splits each line in place, and every
+// field is parsed with std::from_chars straight from the line buffer, so no string is built
+// per field or per row. Quoted fields, dialects (delimiter, whitespace runs, header row) and
+// line endings are handled by the reader.
+
+#include "../Matrix.hpp"
+#include "../../csv-library/CSV.hpp"
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <system_error>
+#include <vector>
+
+namespace la{
+namespace detail{
+
+// field -> value, ignoring surrounding spaces and tabs and a leading '+'; false unless the whole field is a number
+template<class T>
+bool parseCSVNumber(std::string_view field, T& value){
+    size_t begin = field.find_first_not_of(" \t");
+    if(begin == std::string_view::npos) return false;
+    field = field.substr(begin, field.find_last_not_of(" \t") - begin + 1);
+    if(field.front() == '+' && field.size() > 1 && field[1] != '-') field.remove_prefix(1);
+
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+    auto [end, status] = std::from_chars(field.data(), field.data() + field.size(), value);
+    return status == std::errc() && end == field.data() + field.size();
+#else
+    // strtod needs a terminated string; numbers longer than the buffer are not valid fields anyway
+    char buffer[128];
+    if(field.size() >= sizeof(buffer)) return false;
+    std::memcpy(buffer, field.data(), field.size());
+    buffer[field.size()] = '\0';
+    char* end;
+    value = static_cast<T>(std::strtod(buffer, &end));
+    return end == buffer + field.size();
+#endif
+}
+
+} // namespace detail
+
+// Reads a CSV file of numbers into a matrix, one matrix row per CSV row (blank lines are skipped,
+// the first row too when dialect.hasHeader). Throws csv exceptions if the file cannot be read and
+// NonFatalException for a row with a different number of fields or a field that is not a number.
+template<class T = double>
+BasicMatrix<T> loadCSV(const std::string& path, const csv::Dialect& dialect){
+    static_assert(std::is_floating_point<T>::value, "CSV import fills float or double matrices.");
+    csv::Reader reader(dialect);
+    reader.open(path);
+
+    std::vector<std::string_view> fields;
+    if(dialect.hasHeader) reader.readRowView(fields);
+
+    detail::ScratchVector<T> values;
+    size_t rows = 0, cols = 0;
+    while(reader.readRowView(fields)){
+        if(fields.size() == 1 && fields[0].find_first_not_of(" \t") == std::string_view::npos) continue;
+
+        if(rows == 0){
+            cols = fields.size();
+            values.reserve(static_cast<size_t>(reader.getNumRows()) * cols);
+        }else if(fields.size() != cols)
+            throw error::NonFatalException("Line " + std::to_string(reader.getRowNumber()) + " of \"" + path + "\" has " +
+                                           std::to_string(fields.size()) + " fields, expected " + std::to_string(cols) + ".");
+
+        for(size_t c = 0; c < cols; c++){
+            T value;
+            if(!detail::parseCSVNumber(fields[c], value))
+                throw error::NonFatalException("Field " + std::to_string(c + 1) + " on line " + std::to_string(reader.getRowNumber()) +
+                                               " of \"" + path + "\" is not a number: \"" + std::string(fields[c]) + "\".");
+            values.push_back(value);
+        }
+        rows++;
+    }
+    if(rows == 0)
+        throw error::NonFatalException("\"" + path + "\" holds no rows of numbers.");
+
+    BasicMatrix<T> matrix(cols, rows);
+    for(size_t r = 0; r < rows; r++)
+        std::copy(values.begin() + r * cols, values.begin() + (r + 1) * cols, matrix.getData() + r * matrix.getStride());
+    return matrix;
+}
+
+// As above, with the delimiter and header row detected by csv::sniffDialect()
+template<class T = double>
+BasicMatrix<T> loadCSV(const std::string& path){
+    return loadCSV<T>(path, csv::sniffDialect(path));
+}
+
+} // namespace la
@@ -0,0 +1,180 @@
+#pragma once
+
+// Cholesky factorization A = L L^T of a symmetric positive definite matrix.
+// Included by Matrix.hpp after the Matrix class; use it through Matrix.hpp.
+// Only the lower triangle of A is read and overwritten; the upper triangle is left as is.
+// The factorization is blocked: almost all of its work is the trailing update
+// A22 -= L21 L21^T, which runs through the parallel GEMM kernel.
+
+#include "Allocator.hpp"
+#include "Triangular.hpp"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace la{
+namespace detail{
+
+constexpr size_t CHOLESKY_BLOCK = 64;          // panel width
+constexpr size_t CHOLESKY_UPDATE_ROWS = 256;   // rows per trailing-update GEMM call
+
+// Unblocked Cholesky of the n x n matrix a (row-major, leading dimension lda).
+// Returns false if a non-positive pivot shows the matrix is not positive definite.
+inline bool choleskyFactorUnblocked(double* a, size_t n, size_t lda){
+    for(size_t j = 0; j < n; j++){
+        double* rowJ = a + j * lda;
+
+        double diagonal = rowJ[j];
+        for(size_t k = 0; k < j; k++) diagonal -= rowJ[k] * rowJ[k];
+        if(!(diagonal > 0.0)) return false;
+        diagonal = std::sqrt(diagonal);
+        rowJ[j] = diagonal;
+
+        forEachBand(j + 1, n, j, [&](size_t low, size_t high){
+            for(size_t i = low; i < high; i++){
+                double* rowI = a + i * lda;
+                double sum = rowI[j];
+                for(size_t k = 0; k < j; k++) sum -= rowI[k] * rowJ[k];
+                rowI[j] = sum / diagonal;
+            }
+        });
+    }
+    return true;
+}
+
+// In-place right-looking blocked Cholesky. Each CHOLESKY_BLOCK-wide diagonal block is
+// factored unblocked, the panel below it is found by substitution (L21 = A21 L11^-T)
+// and the trailing lower triangle is updated with A22 -= L21 L21^T through GEMM.
+// Returns false if the matrix is not positive definite.
+inline bool choleskyFactor(double* a, size_t n, size_t lda){
+    for(size_t k0 = 0; k0 < n; k0 += CHOLESKY_BLOCK){
+        size_t k1 = std::min(k0 + CHOLESKY_BLOCK, n), kb = k1 - k0;
+        const double* l11 = a + k0 * lda + k0;
+
+        if(!choleskyFactorUnblocked(a + k0 * lda + k0, kb, lda)) return false;
+        if(k1 == n) break;
+
+        // L21 = A21 L11^-T, each row independently
+        forEachBand(k1, n, kb * kb / 2, [&](size_t low, size_t high){
+            for(size_t i = low; i < high; i++){
+                double* row = a + i * lda + k0;
+                for(size_t j = 0; j < kb; j++){
+                    double sum = row[j];
+                    for(size_t k = 0; k < j; k++) sum -= row[k] * l11[j * lda + k];
+                    row[j] = sum / l11[j * lda + j];
+                }
+            }
+        });
+
+        // A22 -= L21 L21^T, on and below the diagonal only so the upper triangle stays untouched
+        for(size_t i0 = k1; i0 < n; i0 += CHOLESKY_UPDATE_ROWS){
+            size_t i1 = std::min(i0 + CHOLESKY_UPDATE_ROWS, n);
+
+            if(i0 > k1)
+                gemm(i1 - i0, i0 - k1, kb, -1.0,
+                     a + i0 * lda + k0, lda, 1,
+                     a + k1 * lda + k0, 1, lda,
+                     a + i0 * lda + k1, lda);
+
+            forEachBand(i0, i1, kb * (i1 - i0) / 2, [&](size_t low, size_t high){
+                for(size_t i = low; i < high; i++){
+                    const double* rowI = a + i * lda + k0;
+                    for(size_t j = i0; j <= i; j++){
+                        const double* rowJ = a + j * lda + k0;
+                        double dot = 0.0;
+                        for(size_t k = 0; k < kb; k++) dot += rowI[k] * rowJ[k];
+                        a[i * lda + j] -= dot;
+                    }
+                }
+            });
+        }
+    }
+    return true;
+}
+
+// Solve A X = B in place from the factor of choleskyFactor: L Y = B, then L^T X = Y
+inline void choleskySolve(const double* l, size_t n, size_t lda, double* b, size_t ldb, size_t numRhs){
+    triangularSolve(Triangle::Lower, false, false, n, l, lda, b, ldb, numRhs);
+    triangularSolve(Triangle::Lower, true, false, n, l, lda, b, ldb, numRhs);
+}
+
+} // namespace detail
+
+class Cholesky{
+private:
+    size_t n;
+    detail::ScratchVector<double> factors; // row-major n x n, L in the lower triangle
+    bool positiveDefinite;
+
+public:
+    // Throws FatalException for non-square input; a matrix that turns out not
+    // to be positive definite is reported by isPositiveDefinite()
+    explicit Cholesky(ConstMatrixView matrix) : n(matrix.cols()){
+        if(matrix.rows() != matrix.cols())
+            throw error::FatalException("Cholesky decomposition requires a square matrix.");
+
+        factors.resize(n * n);
+        matrix.copyTo(factors.data(), n);
+        positiveDefinite = detail::choleskyFactor(factors.data(), n, n);
+    }
+
+    size_t getSize() const { return n; }
+    bool isPositiveDefinite() const { return positiveDefinite; }
+
+    // Solve A X = B in place; b is row-major n x numRhs
+    void solveInPlace(double* b, size_t numRhs) const{
+        if(!positiveDefinite)
+            throw error::NonFatalException("Matrix is not positive definite, cannot solve system with Cholesky.");
+        detail::choleskySolve(factors.data(), n, n, b, numRhs, numRhs);
+    }
+
+    void solveInPlace(MatrixView rhs) const{
+        if(rhs.rows() != n)
+            throw error::NonFatalException("Unable to solve system, mismatching dimensions.");
+        if(!positiveDefinite)
+            throw error::NonFatalException("Matrix is not positive definite, cannot solve system with Cholesky.");
+        detail::choleskySolve(factors.data(), n, n, rhs.getData(), rhs.getStride(), rhs.cols());
+    }
+
+    Matrix solve(ConstMatrixView rhs) const{
+        Matrix solution(rhs);
+        solveInPlace(solution);
+        return solution;
+    }
+
+    // det(A) = product of L's diagonal, squared
+    double determinant() const{
+        if(!positiveDefinite) return 0.0;
+
+        double det = 1.0;
+        for(size_t i = 0; i < n; i++) det *= factors[i * n + i];
+        return det * det;
+    }
+
+    // Lower-triangular factor L
+    Matrix lower() const{
+        Matrix result(n, n);
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = 0; j <= i; j++)
+                result[i][j] = factors[i * n + j];
+        return result;
+    }
+};
+
+// Factor in place: on return the lower triangle of `matrix` holds L and the upper
+// triangle is zero. Returns false if the matrix is not positive definite, in which
+// case its contents are partially overwritten.
+inline bool choleskyInPlace(MatrixView matrix){
+    size_t n = matrix.cols(), lda = matrix.getStride();
+    if(n != matrix.rows())
+        throw error::FatalException("Cholesky decomposition requires a square matrix.");
+
+    double* a = matrix.getData();
+    if(!detail::choleskyFactor(a, n, lda)) return false;
+
+    for(size_t i = 0; i < n; i++)
+        std::fill(a + i * lda + i + 1, a + i * lda + n, 0.0);
+    return true;
+}
+
+}
@@ -4,7 +4,9 @@
 #include <stdexcept>
 #include <string>
 
-namespace error {
+// Inside namespace la, so that the matrix library can share a translation unit with
+// the csv and table libraries, which define their own ::error exceptions
+namespace la::error {
     
 class FatalException : public std::runtime_error{
 public:
@@ -18,4 +20,4 @@ public:
     :   std::runtime_error("NON-FATAL ERROR - " + errorMessage) {}
 };
 
-} // namespace error
\ No newline at end of file
+} // namespace la::error
\ No newline at end of file
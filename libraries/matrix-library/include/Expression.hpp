@@ -0,0 +1,367 @@
+#pragma once
+
+#include "Error.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+// Expression templates for the elementwise la::Matrix operators.
+// A + B * 2.0 - C builds a small tree of expression nodes instead of one
+// temporary Matrix per operator; the tree is evaluated in a single pass when
+// it is assigned to (or used to construct) a Matrix. Evaluation walks the
+// destination in EXPR_BLOCK-sized chunks: every node computes its chunk with
+// the SIMD kernels from Simd.hpp into a stack buffer that stays in L1, so the
+// result is written once and no full-size temporaries are allocated. Large
+// destinations are split into tiles across the shared thread pool.
+//
+// Nodes hold their Matrix operands by reference, so an expression must be
+// consumed in the full-expression that created it. Use eval() (or assign to a
+// Matrix) instead of keeping it in an `auto` variable past that point.
+// Temporary matrices (A * B, A.inverse(), ...) are moved into the node that
+// uses them instead; a Matrix constructed from (or resized by assigning) the
+// expression takes over such a temporary's storage and is evaluated in place,
+// so `C = A * B + D` allocates nothing beyond the product itself.
+//
+// Every node has a value_type (the element type of its operands); mixing
+// element types in one expression is a compile error.
+
+namespace la{
+
+template<class T>
+class BasicMatrix;
+
+using Matrix = BasicMatrix<double>;
+
+// CRTP base of every matrix-valued expression (including Matrix itself)
+template<class E>
+class MatrixExpr{
+public:
+    const E& derived() const { return static_cast<const E&>(*this); }
+    E& derived() { return static_cast<E&>(*this); }
+
+    auto eval() const;                          // BasicMatrix of the expression's element type
+
+    // Convenience forwards so (A + B).method() keeps working; each evaluates once
+    size_t getRowSize() const;
+    size_t getColSize() const;
+    auto transpose() const;
+    auto trace() const;
+    auto determinant() const;
+    double frobeniusNorm() const;
+    size_t rank() const;
+    auto inverse() const;
+    auto clean(double threshold=1e-10) const;
+    void print() const;
+    std::string toString(int precision = 2, int tabAmount = 1) const;
+};
+
+namespace detail{
+
+constexpr size_t EXPR_BLOCK = 256;      // elements per evaluation chunk (2 KiB of doubles)
+
+template<class E>
+using ExprValueT = typename E::value_type;
+
+// Leaf node referring to the row-major storage of a Matrix or view (stride = elements between row starts)
+template<class T>
+class MatrixRef : public MatrixExpr<MatrixRef<T>>{
+private:
+    const T* values;
+    size_t numRows, numCols, stride;
+
+public:
+    using value_type = T;
+
+    MatrixRef(const T* values, size_t numRows, size_t numCols, size_t stride)
+        : values(values), numRows(numRows), numCols(numCols), stride(stride) {}
+
+    size_t rows() const { return numRows; }
+    size_t cols() const { return numCols; }
+    bool overlaps(const T* begin, const T* end) const {
+        return values < end && begin < values + (numRows - 1) * stride + numCols;
+    }
+    BasicMatrix<T>* ownedMatrix() { return nullptr; }
+
+    // Contiguous whenever the chunk stays inside one row (or rows are packed); otherwise gathered into buffer
+    const T* block(size_t offset, size_t length, T* buffer) const {
+        size_t row = offset / numCols, col = offset % numCols;
+        if(stride == numCols || col + length <= numCols)
+            return values + row * stride + col;
+
+        for(size_t done = 0; done < length; row++, col = 0){
+            size_t count = std::min(numCols - col, length - done);
+            std::copy(values + row * stride + col, values + row * stride + col + count, buffer + done);
+            done += count;
+        }
+        return buffer;
+    }
+};
+
+// Leaf node that owns a temporary Matrix operand. The storage moves with the
+// matrix, so the reference into it stays valid when the node is moved.
+template<class T>
+class OwnedMatrix : public MatrixExpr<OwnedMatrix<T>>{
+private:
+    BasicMatrix<T> matrix;
+    MatrixRef<T> ref;
+
+    static MatrixRef<T> refTo(const BasicMatrix<T>& matrix){
+        return MatrixRef<T>(matrix.getData(), matrix.getColSize(), matrix.getRowSize(), matrix.getStride());
+    }
+
+public:
+    using value_type = T;
+
+    explicit OwnedMatrix(BasicMatrix<T>&& temporary) : matrix(std::move(temporary)), ref(refTo(matrix)) {}
+    OwnedMatrix(const OwnedMatrix& other) : matrix(other.matrix), ref(refTo(matrix)) {}
+    OwnedMatrix(OwnedMatrix&&) = default;
+    OwnedMatrix& operator=(const OwnedMatrix&) = delete;
+
+    size_t rows() const { return ref.rows(); }
+    size_t cols() const { return ref.cols(); }
+    bool overlaps(const T* begin, const T* end) const { return ref.overlaps(begin, end); }
+    const T* block(size_t offset, size_t length, T* buffer) const { return ref.block(offset, length, buffer); }
+
+    // The destination may take this storage; the node keeps reading it through ref
+    BasicMatrix<T>* ownedMatrix() { return &matrix; }
+};
+
+// How an operand is stored inside a node: Matrix lvalues by reference (MatrixRef),
+// Matrix temporaries by value (OwnedMatrix), nodes by value
+template<class E>
+struct ExprOperand{
+    static const E& wrap(const E& expr) { return expr; }
+    static E&& wrap(E&& expr) { return std::move(expr); }
+};
+
+template<class T>
+struct ExprOperand<BasicMatrix<T>>{
+    static MatrixRef<T> wrap(const BasicMatrix<T>& matrix){
+        return MatrixRef<T>(matrix.getData(), matrix.getColSize(), matrix.getRowSize(), matrix.getStride());
+    }
+    static OwnedMatrix<T> wrap(BasicMatrix<T>&& matrix){
+        return OwnedMatrix<T>(std::move(matrix));
+    }
+};
+
+template<class E>
+decltype(auto) wrapOperand(const MatrixExpr<E>& expr){
+    return ExprOperand<E>::wrap(expr.derived());
+}
+
+template<class E>
+decltype(auto) wrapOperand(MatrixExpr<E>&& expr){
+    return ExprOperand<E>::wrap(std::move(expr.derived()));
+}
+
+// Node type for an operand given as a forwarding reference (lvalue or temporary)
+template<class E>
+using ExprOperandT = std::decay_t<decltype(wrapOperand(std::declval<E>()))>;
+
+template<class E>
+constexpr bool IsMatrixExpr = std::is_base_of<MatrixExpr<std::decay_t<E>>, std::decay_t<E>>::value;
+
+template<class L, class R = L>
+using EnableIfMatrixExprs = std::enable_if_t<IsMatrixExpr<L> && IsMatrixExpr<R>>;
+
+// Elementwise operations, each forwarding to the dispatched SIMD kernel for T
+
+struct AddOp{
+    template<class T>
+    static void apply(const T* a, const T* b, T* out, size_t n){ simd<T>().addVV(a, b, out, n); }
+};
+struct SubOp{
+    template<class T>
+    static void apply(const T* a, const T* b, T* out, size_t n){ simd<T>().subVV(a, b, out, n); }
+};
+struct AddScalarOp{
+    template<class T>
+    static void apply(const T* a, T s, T* out, size_t n){ simd<T>().addVS(a, s, out, n); }
+};
+struct SubScalarOp{
+    template<class T>
+    static void apply(const T* a, T s, T* out, size_t n){ simd<T>().addVS(a, -s, out, n); }
+};
+struct ScalarSubOp{
+    template<class T>
+    static void apply(const T* a, T s, T* out, size_t n){ simd<T>().subSV(s, a, out, n); }
+};
+struct MulScalarOp{
+    template<class T>
+    static void apply(const T* a, T s, T* out, size_t n){ simd<T>().mulVS(a, s, out, n); }
+};
+struct DivScalarOp{
+    template<class T>
+    static void apply(const T* a, T s, T* out, size_t n){ simd<T>().divVS(a, s, out, n); }
+};
+
+// lhs (op) rhs, both matrix-valued
+template<class L, class R, class Op>
+class BinaryExpr : public MatrixExpr<BinaryExpr<L, R, Op>>{
+    static_assert(std::is_same<ExprValueT<L>, ExprValueT<R>>::value,
+                  "Matrix expressions cannot mix element types; convert one operand with cast<T>() first.");
+
+private:
+    L lhs;
+    R rhs;
+
+public:
+    using value_type = ExprValueT<L>;
+
+    BinaryExpr(L lhs, R rhs) : lhs(std::move(lhs)), rhs(std::move(rhs)) {}
+
+    size_t rows() const { return lhs.rows(); }
+    size_t cols() const { return lhs.cols(); }
+    bool overlaps(const value_type* begin, const value_type* end) const { return lhs.overlaps(begin, end) || rhs.overlaps(begin, end); }
+    BasicMatrix<value_type>* ownedMatrix() {
+        BasicMatrix<value_type>* owned = lhs.ownedMatrix();
+        return owned ? owned : rhs.ownedMatrix();
+    }
+
+    // The left operand may use the output buffer as scratch; the right one gets its own
+    const value_type* block(size_t offset, size_t length, value_type* buffer) const {
+        value_type rhsBuffer[EXPR_BLOCK];
+        const value_type* a = lhs.block(offset, length, buffer);
+        const value_type* b = rhs.block(offset, length, rhsBuffer);
+        Op::apply(a, b, buffer, length);
+        return buffer;
+    }
+};
+
+// expr (op) scalar
+template<class E, class Op>
+class ScalarExpr : public MatrixExpr<ScalarExpr<E, Op>>{
+public:
+    using value_type = ExprValueT<E>;
+
+private:
+    E expr;
+    value_type scalar;
+
+public:
+    ScalarExpr(E expr, value_type scalar) : expr(std::move(expr)), scalar(scalar) {}
+
+    size_t rows() const { return expr.rows(); }
+    size_t cols() const { return expr.cols(); }
+    bool overlaps(const value_type* begin, const value_type* end) const { return expr.overlaps(begin, end); }
+    BasicMatrix<value_type>* ownedMatrix() { return expr.ownedMatrix(); }
+
+    const value_type* block(size_t offset, size_t length, value_type* buffer) const {
+        const value_type* a = expr.block(offset, length, buffer);
+        Op::apply(a, scalar, buffer, length);
+        return buffer;
+    }
+};
+
+// out[0, size) = expr. When the expression reads the destination, each chunk
+// is computed in a scratch buffer first so no operand is overwritten early.
+// (An operand with the destination's shape that overlaps its storage can only
+// be the destination itself, so chunks never read each other's output.)
+template<class E>
+void evaluateInto(const E& expr, ExprValueT<E>* out, size_t size){
+    using T = ExprValueT<E>;
+    bool direct = !expr.overlaps(out, out + size);
+
+    forEachTile(size, [&](size_t low, size_t high){
+        T scratch[EXPR_BLOCK];
+        for(size_t offset = low; offset < high; offset += EXPR_BLOCK){
+            size_t length = std::min(EXPR_BLOCK, high - offset);
+            T* target = direct ? out + offset : scratch;
+            const T* result = expr.block(offset, length, target);
+            if(result != out + offset)
+                std::copy(result, result + length, out + offset);
+        }
+    });
+}
+
+// out[0, size) (op)= expr. All reads of a chunk finish before it is written,
+// so this is safe even when the expression refers to the destination.
+template<class Op, class E>
+void accumulateInto(const E& expr, ExprValueT<E>* out, size_t size){
+    using T = ExprValueT<E>;
+    forEachTile(size, [&](size_t low, size_t high){
+        T scratch[EXPR_BLOCK];
+        for(size_t offset = low; offset < high; offset += EXPR_BLOCK){
+            size_t length = std::min(EXPR_BLOCK, high - offset);
+            const T* result = expr.block(offset, length, scratch);
+            Op::apply(out + offset, result, out + offset, length);
+        }
+    });
+}
+
+template<class L, class R>
+void checkSameShape(const L& lhs, const R& rhs, const char* message){
+    if(lhs.rows() != rhs.rows() || lhs.cols() != rhs.cols())
+        throw error::NonFatalException(message);
+}
+
+} // namespace detail
+
+// --- Elementwise operators (evaluated lazily) ---
+// Operands are forwarded: lvalue matrices are referenced, temporaries moved into the node
+
+template<class L, class R, class = detail::EnableIfMatrixExprs<L, R>>
+detail::BinaryExpr<detail::ExprOperandT<L>, detail::ExprOperandT<R>, detail::AddOp>
+operator+(L&& lhs, R&& rhs){
+    detail::ExprOperandT<L> a = detail::wrapOperand(std::forward<L>(lhs));
+    detail::ExprOperandT<R> b = detail::wrapOperand(std::forward<R>(rhs));
+    detail::checkSameShape(a, b, "Unable to add matrices, mismatching dimensions.");
+    return {std::move(a), std::move(b)};
+}
+
+template<class L, class R, class = detail::EnableIfMatrixExprs<L, R>>
+detail::BinaryExpr<detail::ExprOperandT<L>, detail::ExprOperandT<R>, detail::SubOp>
+operator-(L&& lhs, R&& rhs){
+    detail::ExprOperandT<L> a = detail::wrapOperand(std::forward<L>(lhs));
+    detail::ExprOperandT<R> b = detail::wrapOperand(std::forward<R>(rhs));
+    detail::checkSameShape(a, b, "Unable to subtract matrices, mismatching dimensions");
+    return {std::move(a), std::move(b)};
+}
+
+// Matrix product; evaluated eagerly with GEMM (defined in Matrix.hpp)
+template<class L, class R>
+BasicMatrix<detail::ExprValueT<L>> operator*(const MatrixExpr<L>& lhs, const MatrixExpr<R>& rhs);
+
+template<class E, class = detail::EnableIfMatrixExprs<E>>
+detail::ScalarExpr<detail::ExprOperandT<E>, detail::AddScalarOp> operator+(E&& expr, detail::ExprValueT<std::decay_t<E>> scalar){
+    return {detail::wrapOperand(std::forward<E>(expr)), scalar};
+}
+
+template<class E, class = detail::EnableIfMatrixExprs<E>>
+detail::ScalarExpr<detail::ExprOperandT<E>, detail::AddScalarOp> operator+(detail::ExprValueT<std::decay_t<E>> scalar, E&& expr){
+    return {detail::wrapOperand(std::forward<E>(expr)), scalar};
+}
+
+template<class E, class = detail::EnableIfMatrixExprs<E>>
+detail::ScalarExpr<detail::ExprOperandT<E>, detail::SubScalarOp> operator-(E&& expr, detail::ExprValueT<std::decay_t<E>> scalar){
+    return {detail::wrapOperand(std::forward<E>(expr)), scalar};
+}
+
+template<class E, class = detail::EnableIfMatrixExprs<E>>
+detail::ScalarExpr<detail::ExprOperandT<E>, detail::ScalarSubOp> operator-(detail::ExprValueT<std::decay_t<E>> scalar, E&& expr){
+    return {detail::wrapOperand(std::forward<E>(expr)), scalar};
+}
+
+template<class E, class = detail::EnableIfMatrixExprs<E>>
+detail::ScalarExpr<detail::ExprOperandT<E>, detail::MulScalarOp> operator*(E&& expr, detail::ExprValueT<std::decay_t<E>> scalar){
+    return {detail::wrapOperand(std::forward<E>(expr)), scalar};
+}
+
+template<class E, class = detail::EnableIfMatrixExprs<E>>
+detail::ScalarExpr<detail::ExprOperandT<E>, detail::MulScalarOp> operator*(detail::ExprValueT<std::decay_t<E>> scalar, E&& expr){
+    return {detail::wrapOperand(std::forward<E>(expr)), scalar};
+}
+
+template<class E, class = detail::EnableIfMatrixExprs<E>>
+detail::ScalarExpr<detail::ExprOperandT<E>, detail::DivScalarOp> operator/(E&& expr, detail::ExprValueT<std::decay_t<E>> scalar){
+    if(std::abs(scalar) < 1e-10)
+        throw error::NonFatalException("Division by zero in matrix-scalar division.");
+    return {detail::wrapOperand(std::forward<E>(expr)), scalar};
+}
+
+}
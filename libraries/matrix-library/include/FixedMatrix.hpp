@@ -0,0 +1,351 @@
+#pragma once
+
+// Fixed-size matrices for small dimensions (2x2, 3x3 and 4x4 transforms and the like).
+// Included by Matrix.hpp after the Matrix class; use it through Matrix.hpp.
+//
+// FixedMatrix<Rows, Cols, T> keeps its elements in a std::array, so it never
+// allocates, and its shape is part of the type: adding or multiplying matrices of
+// mismatching shapes does not compile instead of throwing at runtime. Operations
+// are constexpr, the product loops are unrolled at compile time, and the
+// determinant and inverse use closed forms up to 4x4 (Gauss-Jordan elimination
+// with partial pivoting beyond that). toMatrix() and the view constructor convert
+// to and from a la::BasicMatrix of the same element type.
+
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+namespace la{
+namespace detail{
+
+// Calls f(std::integral_constant<size_t, I>{}) for I = 0 .. N - 1, expanded at compile time
+template<class F, size_t... I>
+constexpr void unrollImpl(F&& f, std::index_sequence<I...>){
+    (f(std::integral_constant<size_t, I>{}), ...);
+}
+
+template<size_t N, class F>
+constexpr void unroll(F&& f){
+    unrollImpl(f, std::make_index_sequence<N>{});
+}
+
+template<class T>
+constexpr T magnitude(T value){
+    return value < T(0) ? -value : value;
+}
+
+} // namespace detail
+
+template<size_t Rows, size_t Cols, class T = double>
+class FixedMatrix{
+    static_assert(Rows > 0 && Cols > 0, "Matrix dimensions must be greater than 0");
+    static_assert(std::is_arithmetic<T>::value, "FixedMatrix elements must be an arithmetic type.");
+
+private:
+    std::array<T, Rows * Cols> values{};        // row-major
+
+    // Real type the determinant and inverse are computed in (integers use double)
+    using Real = std::conditional_t<std::is_floating_point<T>::value, T, double>;
+
+    constexpr Real at(size_t row, size_t col) const { return static_cast<Real>(values[row * Cols + col]); }
+
+    // Determinant by elimination with partial pivoting, for sizes without a closed form
+    constexpr Real eliminationDeterminant() const{
+        std::array<Real, Rows * Cols> a{};
+        for(size_t i = 0; i < Rows * Cols; i++) a[i] = static_cast<Real>(values[i]);
+
+        Real det = 1;
+        for(size_t k = 0; k < Rows; k++){
+            size_t pivot = k;
+            for(size_t r = k + 1; r < Rows; r++)
+                if(detail::magnitude(a[r * Cols + k]) > detail::magnitude(a[pivot * Cols + k])) pivot = r;
+            if(a[pivot * Cols + k] == Real(0)) return 0;
+            if(pivot != k){
+                for(size_t c = 0; c < Cols; c++){
+                    Real swapped = a[k * Cols + c];
+                    a[k * Cols + c] = a[pivot * Cols + c];
+                    a[pivot * Cols + c] = swapped;
+                }
+                det = -det;
+            }
+
+            det *= a[k * Cols + k];
+            for(size_t r = k + 1; r < Rows; r++){
+                Real factor = a[r * Cols + k] / a[k * Cols + k];
+                for(size_t c = k + 1; c < Cols; c++) a[r * Cols + c] -= factor * a[k * Cols + c];
+            }
+        }
+        return det;
+    }
+
+public:
+    using value_type = T;
+
+    // All zeros
+    constexpr FixedMatrix() = default;
+
+    // Row-major element list, e.g. FixedMatrix<2, 2> m(1, 2, 3, 4); the count is checked at compile time
+    template<class... Args, std::enable_if_t<sizeof...(Args) == Rows * Cols &&
+                                             std::conjunction<std::is_arithmetic<Args>...>::value, int> = 0>
+    constexpr FixedMatrix(Args... elements) : values{static_cast<T>(elements)...} {}
+
+    // Copy of a Matrix or view of the same element type; throws FatalException if its shape differs
+    explicit FixedMatrix(BasicMatrixView<const T> matrix){
+        if(matrix.rows() != Rows || matrix.cols() != Cols)
+            throw error::FatalException("Mismatching dimensions passed to fixed-size matrix constructor.");
+
+        for(size_t row = 0; row < Rows; row++)
+            for(size_t col = 0; col < Cols; col++)
+                values[row * Cols + col] = matrix(row, col);
+    }
+
+    static constexpr FixedMatrix identity(){
+        static_assert(Rows == Cols, "Identity is only defined for square matrices.");
+        FixedMatrix result;
+        for(size_t i = 0; i < Rows; i++) result.values[i * Cols + i] = T(1);
+        return result;
+    }
+
+    static constexpr size_t rows() { return Rows; }
+    static constexpr size_t cols() { return Cols; }
+
+    constexpr T& operator()(size_t row, size_t col) { return values[row * Cols + col]; }
+    constexpr const T& operator()(size_t row, size_t col) const { return values[row * Cols + col]; }
+
+    constexpr T* operator[](size_t row) { return values.data() + row * Cols; }      // element access using [row][col]
+    constexpr const T* operator[](size_t row) const { return values.data() + row * Cols; }
+
+    constexpr T* getData() { return values.data(); }                                 // row-major storage
+    constexpr const T* getData() const { return values.data(); }
+
+    // Views for passing a FixedMatrix to the la algorithms without copying
+    BasicMatrixView<T> view() { return BasicMatrixView<T>(values.data(), Rows, Cols); }
+    BasicMatrixView<const T> view() const { return BasicMatrixView<const T>(values.data(), Rows, Cols); }
+
+    BasicMatrix<T> toMatrix() const{
+        return BasicMatrix<T>(view());
+    }
+
+    constexpr FixedMatrix& operator+=(const FixedMatrix& other){
+        for(size_t i = 0; i < Rows * Cols; i++) values[i] += other.values[i];
+        return *this;
+    }
+
+    constexpr FixedMatrix& operator-=(const FixedMatrix& other){
+        for(size_t i = 0; i < Rows * Cols; i++) values[i] -= other.values[i];
+        return *this;
+    }
+
+    constexpr FixedMatrix& operator*=(T scalar){
+        for(T& value : values) value *= scalar;
+        return *this;
+    }
+
+    constexpr FixedMatrix& operator/=(T scalar){
+        for(T& value : values) value /= scalar;
+        return *this;
+    }
+
+    constexpr FixedMatrix& operator*=(const FixedMatrix& other){
+        static_assert(Rows == Cols, "In-place multiplication requires a square matrix.");
+        return *this = *this * other;
+    }
+
+    constexpr FixedMatrix<Cols, Rows, T> transpose() const{
+        FixedMatrix<Cols, Rows, T> result;
+        detail::unroll<Rows>([&](auto row){
+            detail::unroll<Cols>([&](auto col){ result(col, row) = (*this)(row, col); });
+        });
+        return result;
+    }
+
+    constexpr T trace() const{
+        static_assert(Rows == Cols, "Trace is only defined for square matrices.");
+        T sum{};
+        for(size_t i = 0; i < Rows; i++) sum += values[i * Cols + i];
+        return sum;
+    }
+
+    constexpr Real determinant() const{
+        static_assert(Rows == Cols, "Determinant only defined for square matrices");
+
+        if constexpr(Rows == 1){
+            return at(0, 0);
+        }else if constexpr(Rows == 2){
+            return at(0, 0) * at(1, 1) - at(0, 1) * at(1, 0);
+        }else if constexpr(Rows == 3){
+            return at(0, 0) * (at(1, 1) * at(2, 2) - at(1, 2) * at(2, 1))
+                 - at(0, 1) * (at(1, 0) * at(2, 2) - at(1, 2) * at(2, 0))
+                 + at(0, 2) * (at(1, 0) * at(2, 1) - at(1, 1) * at(2, 0));
+        }else if constexpr(Rows == 4){
+            // Laplace expansion along the first two rows: 2x2 minors of the top and bottom halves
+            Real s0 = at(0, 0) * at(1, 1) - at(1, 0) * at(0, 1);
+            Real s1 = at(0, 0) * at(1, 2) - at(1, 0) * at(0, 2);
+            Real s2 = at(0, 0) * at(1, 3) - at(1, 0) * at(0, 3);
+            Real s3 = at(0, 1) * at(1, 2) - at(1, 1) * at(0, 2);
+            Real s4 = at(0, 1) * at(1, 3) - at(1, 1) * at(0, 3);
+            Real s5 = at(0, 2) * at(1, 3) - at(1, 2) * at(0, 3);
+            Real c0 = at(2, 0) * at(3, 1) - at(3, 0) * at(2, 1);
+            Real c1 = at(2, 0) * at(3, 2) - at(3, 0) * at(2, 2);
+            Real c2 = at(2, 0) * at(3, 3) - at(3, 0) * at(2, 3);
+            Real c3 = at(2, 1) * at(3, 2) - at(3, 1) * at(2, 2);
+            Real c4 = at(2, 1) * at(3, 3) - at(3, 1) * at(2, 3);
+            Real c5 = at(2, 2) * at(3, 3) - at(3, 2) * at(2, 3);
+            return s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+        }else{
+            return eliminationDeterminant();
+        }
+    }
+
+    // Throws NonFatalException if the matrix is singular (|det| or a pivot below threshold)
+    constexpr FixedMatrix inverse(double threshold = 1e-10) const{
+        static_assert(Rows == Cols, "Cannot invert a non-square matrix.");
+        static_assert(std::is_floating_point<T>::value, "Inverse requires a floating-point element type.");
+
+        FixedMatrix result;
+        if constexpr(Rows <= 4){
+            T det = determinant();
+            if(detail::magnitude(det) < threshold)
+                throw error::NonFatalException("Matrix is singular, cannot invert matrix.");
+            T scale = T(1) / det;
+
+            if constexpr(Rows == 1){
+                result(0, 0) = scale;
+            }else if constexpr(Rows == 2){
+                result = FixedMatrix( at(1, 1), -at(0, 1),
+                                     -at(1, 0),  at(0, 0)) * scale;
+            }else if constexpr(Rows == 3){
+                // Adjugate (transposed cofactors)
+                result = FixedMatrix(at(1, 1) * at(2, 2) - at(1, 2) * at(2, 1),
+                                     at(0, 2) * at(2, 1) - at(0, 1) * at(2, 2),
+                                     at(0, 1) * at(1, 2) - at(0, 2) * at(1, 1),
+                                     at(1, 2) * at(2, 0) - at(1, 0) * at(2, 2),
+                                     at(0, 0) * at(2, 2) - at(0, 2) * at(2, 0),
+                                     at(0, 2) * at(1, 0) - at(0, 0) * at(1, 2),
+                                     at(1, 0) * at(2, 1) - at(1, 1) * at(2, 0),
+                                     at(0, 1) * at(2, 0) - at(0, 0) * at(2, 1),
+                                     at(0, 0) * at(1, 1) - at(0, 1) * at(1, 0)) * scale;
+            }else{
+                // Same 2x2 minors as determinant(); each cofactor combines one top and one bottom minor
+                T s0 = at(0, 0) * at(1, 1) - at(1, 0) * at(0, 1);
+                T s1 = at(0, 0) * at(1, 2) - at(1, 0) * at(0, 2);
+                T s2 = at(0, 0) * at(1, 3) - at(1, 0) * at(0, 3);
+                T s3 = at(0, 1) * at(1, 2) - at(1, 1) * at(0, 2);
+                T s4 = at(0, 1) * at(1, 3) - at(1, 1) * at(0, 3);
+                T s5 = at(0, 2) * at(1, 3) - at(1, 2) * at(0, 3);
+                T c0 = at(2, 0) * at(3, 1) - at(3, 0) * at(2, 1);
+                T c1 = at(2, 0) * at(3, 2) - at(3, 0) * at(2, 2);
+                T c2 = at(2, 0) * at(3, 3) - at(3, 0) * at(2, 3);
+                T c3 = at(2, 1) * at(3, 2) - at(3, 1) * at(2, 2);
+                T c4 = at(2, 1) * at(3, 3) - at(3, 1) * at(2, 3);
+                T c5 = at(2, 2) * at(3, 3) - at(3, 2) * at(2, 3);
+
+                result = FixedMatrix( at(1, 1) * c5 - at(1, 2) * c4 + at(1, 3) * c3,
+                                     -at(0, 1) * c5 + at(0, 2) * c4 - at(0, 3) * c3,
+                                      at(3, 1) * s5 - at(3, 2) * s4 + at(3, 3) * s3,
+                                     -at(2, 1) * s5 + at(2, 2) * s4 - at(2, 3) * s3,
+                                     -at(1, 0) * c5 + at(1, 2) * c2 - at(1, 3) * c1,
+                                      at(0, 0) * c5 - at(0, 2) * c2 + at(0, 3) * c1,
+                                     -at(3, 0) * s5 + at(3, 2) * s2 - at(3, 3) * s1,
+                                      at(2, 0) * s5 - at(2, 2) * s2 + at(2, 3) * s1,
+                                      at(1, 0) * c4 - at(1, 1) * c2 + at(1, 3) * c0,
+                                     -at(0, 0) * c4 + at(0, 1) * c2 - at(0, 3) * c0,
+                                      at(3, 0) * s4 - at(3, 1) * s2 + at(3, 3) * s0,
+                                     -at(2, 0) * s4 + at(2, 1) * s2 - at(2, 3) * s0,
+                                     -at(1, 0) * c3 + at(1, 1) * c1 - at(1, 2) * c0,
+                                      at(0, 0) * c3 - at(0, 1) * c1 + at(0, 2) * c0,
+                                     -at(3, 0) * s3 + at(3, 1) * s1 - at(3, 2) * s0,
+                                      at(2, 0) * s3 - at(2, 1) * s1 + at(2, 2) * s0) * scale;
+            }
+        }else{
+            // Gauss-Jordan with partial pivoting on [A | I]
+            FixedMatrix a = *this;
+            result = identity();
+            for(size_t k = 0; k < Rows; k++){
+                size_t pivot = k;
+                for(size_t r = k + 1; r < Rows; r++)
+                    if(detail::magnitude(a(r, k)) > detail::magnitude(a(pivot, k))) pivot = r;
+                if(detail::magnitude(a(pivot, k)) < threshold)
+                    throw error::NonFatalException("Matrix is singular, cannot invert matrix.");
+                if(pivot != k)
+                    for(size_t c = 0; c < Cols; c++){
+                        T swapped = a(k, c); a(k, c) = a(pivot, c); a(pivot, c) = swapped;
+                        swapped = result(k, c); result(k, c) = result(pivot, c); result(pivot, c) = swapped;
+                    }
+
+                T scale = T(1) / a(k, k);
+                for(size_t c = 0; c < Cols; c++){
+                    a(k, c) *= scale;
+                    result(k, c) *= scale;
+                }
+                for(size_t r = 0; r < Rows; r++){
+                    if(r == k || a(r, k) == T(0)) continue;
+                    T factor = a(r, k);
+                    for(size_t c = 0; c < Cols; c++){
+                        a(r, c) -= factor * a(k, c);
+                        result(r, c) -= factor * result(k, c);
+                    }
+                }
+            }
+        }
+        return result;
+    }
+
+    Real frobeniusNorm() const{
+        Real sum = 0;
+        for(T value : values) sum += static_cast<Real>(value) * static_cast<Real>(value);
+        return std::sqrt(sum);
+    }
+
+    void print() const { toMatrix().print(); }
+    std::string toString(int precision = 2, int tabAmount = 1) const { return toMatrix().toString(precision, tabAmount); }
+
+    // Same 1e-10 tolerance as Matrix for floating-point elements, exact for integers
+    friend constexpr bool operator==(const FixedMatrix& lhs, const FixedMatrix& rhs){
+        for(size_t i = 0; i < Rows * Cols; i++){
+            if constexpr(std::is_floating_point<T>::value){
+                if(!(detail::magnitude(lhs.values[i] - rhs.values[i]) < T(1e-10))) return false;
+            }else{
+                if(lhs.values[i] != rhs.values[i]) return false;
+            }
+        }
+        return true;
+    }
+
+    friend constexpr bool operator!=(const FixedMatrix& lhs, const FixedMatrix& rhs){
+        return !(lhs == rhs);
+    }
+
+    friend constexpr FixedMatrix operator+(FixedMatrix lhs, const FixedMatrix& rhs) { return lhs += rhs; }
+    friend constexpr FixedMatrix operator-(FixedMatrix lhs, const FixedMatrix& rhs) { return lhs -= rhs; }
+    friend constexpr FixedMatrix operator-(FixedMatrix matrix) { return matrix *= T(-1); }
+    friend constexpr FixedMatrix operator*(FixedMatrix matrix, T scalar) { return matrix *= scalar; }
+    friend constexpr FixedMatrix operator*(T scalar, FixedMatrix matrix) { return matrix *= scalar; }
+    friend constexpr FixedMatrix operator/(FixedMatrix matrix, T scalar) { return matrix /= scalar; }
+};
+
+// (Rows x Inner) * (Inner x Cols); mismatching inner dimensions have no overload, so they fail to compile
+template<size_t Rows, size_t Inner, size_t Cols, class T>
+constexpr FixedMatrix<Rows, Cols, T> operator*(const FixedMatrix<Rows, Inner, T>& lhs, const FixedMatrix<Inner, Cols, T>& rhs){
+    FixedMatrix<Rows, Cols, T> result;
+    detail::unroll<Rows>([&](auto row){
+        detail::unroll<Cols>([&](auto col){
+            T sum{};
+            detail::unroll<Inner>([&](auto k){ sum += lhs(row, k) * rhs(k, col); });
+            result(row, col) = sum;
+        });
+    });
+    return result;
+}
+
+using Matrix2 = FixedMatrix<2, 2>;
+using Matrix3 = FixedMatrix<3, 3>;
+using Matrix4 = FixedMatrix<4, 4>;
+using Vector2 = FixedMatrix<2, 1>;
+using Vector3 = FixedMatrix<3, 1>;
+using Vector4 = FixedMatrix<4, 1>;
+
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "ThreadPool.hpp"
+#include <vector>
+#include <algorithm>
+#include <cstddef>
+
+// Blocked general matrix multiply (GEMM) used by la::Matrix::operator*.
+// Layout follows the usual Goto/BLIS scheme:
+//   - B is packed into KC x NC panels (sized for L3) stored as NR-wide micro-panels
+//   - A is packed into MC x KC blocks (sized for L2) stored as MR-tall micro-panels
+//   - an MR x NR register-tiled micro-kernel walks one micro-panel of each (in L1)
+// A and B are addressed through a row stride and a column stride (element
+// (i, j) is at i * rowStride + j * colStride), so transposed operands need no
+// copy; C is row-major with an explicit leading dimension.
+// Large products split the packing of B and the MC blocks of A across the
+// shared thread pool (include/ThreadPool.hpp).
+// The kernels are templates on the element type; GemmBlocking picks the tile
+// sizes (float gets a tile twice as wide, filling the same registers).
+
+namespace la{
+namespace detail{
+
+constexpr size_t GEMM_MR = 4;       // micro-tile rows (register tile height)
+constexpr size_t GEMM_NR = 8;       // micro-tile columns (register tile width)
+constexpr size_t GEMM_KC = 256;     // shared dimension of a packed block (L1: KC*NR doubles of B)
+constexpr size_t GEMM_MC = 96;      // rows of A per packed block (L2: MC*KC doubles)
+constexpr size_t GEMM_NC = 4096;    // columns of B per packed panel (L3: KC*NC doubles)
+
+template<class T>
+struct GemmBlocking{
+    static constexpr size_t MR = GEMM_MR, NR = 4, KC = GEMM_KC, MC = GEMM_MC, NC = GEMM_NC;
+};
+template<>
+struct GemmBlocking<double>{
+    static constexpr size_t MR = GEMM_MR, NR = GEMM_NR, KC = GEMM_KC, MC = GEMM_MC, NC = GEMM_NC;
+};
+template<>
+struct GemmBlocking<float>{
+    static constexpr size_t MR = GEMM_MR, NR = 2 * GEMM_NR, KC = GEMM_KC, MC = GEMM_MC, NC = GEMM_NC;
+};
+
+// Packing buffers are reused across calls so steady-state multiplies never allocate
+template<class T>
+inline std::vector<T>& gemmPackA(){
+    thread_local std::vector<T> buffer;
+    return buffer;
+}
+template<class T>
+inline std::vector<T>& gemmPackB(){
+    thread_local std::vector<T> buffer;
+    return buffer;
+}
+
+// Pack an mc x kc block of A into MR-row micro-panels, zero-padding the last one
+template<class T>
+inline void packA(size_t mc, size_t kc, const T* A, size_t rsA, size_t csA, T* packed){
+    constexpr size_t MR = GemmBlocking<T>::MR;
+    for(size_t i0 = 0; i0 < mc; i0 += MR){
+        size_t rows = std::min(MR, mc - i0);
+        for(size_t p = 0; p < kc; p++){
+            for(size_t i = 0; i < rows; i++)
+                packed[i] = A[(i0 + i) * rsA + p * csA];
+            for(size_t i = rows; i < MR; i++)
+                packed[i] = T(0);
+            packed += MR;
+        }
+    }
+}
+
+// Pack a kc x nc panel of B into NR-column micro-panels, zero-padding the last one
+template<class T>
+inline void packB(size_t kc, size_t nc, const T* B, size_t rsB, size_t csB, T* packed){
+    constexpr size_t NR = GemmBlocking<T>::NR;
+    for(size_t j0 = 0; j0 < nc; j0 += NR){
+        size_t cols = std::min(NR, nc - j0);
+        for(size_t p = 0; p < kc; p++){
+            const T* bRow = B + p * rsB + j0 * csB;
+            for(size_t j = 0; j < cols; j++)
+                packed[j] = bRow[j * csB];
+            for(size_t j = cols; j < NR; j++)
+                packed[j] = T(0);
+            packed += NR;
+        }
+    }
+}
+
+// MR x NR micro-kernel: acc = sum over p of a[:, p] * b[p, :], accumulated in
+// registers (fixed-size loops are fully unrolled and vectorised by the compiler)
+template<class T>
+inline void microKernel(size_t kc, const T* __restrict a, const T* __restrict b, T* __restrict acc){
+    constexpr size_t MR = GemmBlocking<T>::MR, NR = GemmBlocking<T>::NR;
+    T c[MR][NR] = {};
+
+    for(size_t p = 0; p < kc; p++){
+        for(size_t i = 0; i < MR; i++){
+            T aValue = a[i];
+            for(size_t j = 0; j < NR; j++)
+                c[i][j] += aValue * b[j];
+        }
+        a += MR;
+        b += NR;
+    }
+
+    for(size_t i = 0; i < MR; i++)
+        for(size_t j = 0; j < NR; j++)
+            acc[i * NR + j] = c[i][j];
+}
+
+// Multiply one packed MC x KC block of A by one packed KC x NC panel of B, adding alpha times the result to C
+template<class T>
+inline void gemmMacroKernel(size_t mc, size_t nc, size_t kc, T alpha, const T* packedA, const T* packedB, T* C, size_t ldc){
+    constexpr size_t MR = GemmBlocking<T>::MR, NR = GemmBlocking<T>::NR;
+    T acc[MR * NR];
+
+    for(size_t j0 = 0; j0 < nc; j0 += NR){
+        size_t cols = std::min(NR, nc - j0);
+        const T* bPanel = packedB + j0 * kc;
+
+        for(size_t i0 = 0; i0 < mc; i0 += MR){
+            size_t rows = std::min(MR, mc - i0);
+            microKernel(kc, packedA + i0 * kc, bPanel, acc);
+
+            T* cTile = C + i0 * ldc + j0;
+            for(size_t i = 0; i < rows; i++)
+                for(size_t j = 0; j < cols; j++)
+                    cTile[i * ldc + j] += alpha * acc[i * NR + j];
+        }
+    }
+}
+
+// C(m x n) += alpha * A(m x k) * B(k x n), with general strides for A and B
+template<class T>
+inline void gemm(size_t m, size_t n, size_t k, T alpha,
+                 const T* A, size_t rsA, size_t csA,
+                 const T* B, size_t rsB, size_t csB,
+                 T* C, size_t ldc){
+    constexpr size_t MR = GemmBlocking<T>::MR, NR = GemmBlocking<T>::NR;
+    constexpr size_t KC = GemmBlocking<T>::KC, MC = GemmBlocking<T>::MC, NC = GemmBlocking<T>::NC;
+    if(m == 0 || n == 0 || k == 0) return;
+
+    ThreadPool& pool = ThreadPool::instance();
+    bool parallel = pool.worthParallel(m * n) && m > MR;
+
+    // With several threads, shrink the row blocks so every thread gets at least one
+    size_t mcStep = MC;
+    if(parallel){
+        size_t perThread = (m + pool.getNumThreads() - 1) / pool.getNumThreads();
+        mcStep = std::min(MC, (perThread + MR - 1) / MR * MR);
+    }
+
+    std::vector<T>& bufferB = gemmPackB<T>();
+    size_t paddedMC = (std::min(mcStep, m) + MR - 1) / MR * MR;
+    size_t paddedNC = (std::min(NC, n) + NR - 1) / NR * NR;
+    size_t kcMax = std::min(KC, k);
+    if(bufferB.size() < paddedNC * kcMax) bufferB.resize(paddedNC * kcMax);
+
+    for(size_t jc = 0; jc < n; jc += NC){
+        size_t nc = std::min(NC, n - jc);
+
+        for(size_t pc = 0; pc < k; pc += KC){
+            size_t kc = std::min(KC, k - pc);
+            const T* bBlock = B + pc * rsB + jc * csB;
+            T* packedB = bufferB.data();
+
+            // Micro-panels of B are independent, so NR-aligned column ranges can be packed in parallel
+            auto packColumns = [&](size_t low, size_t high){
+                packB(kc, high - low, bBlock + low * csB, rsB, csB, packedB + low * kc);
+            };
+            if(parallel) pool.parallelFor(0, nc, NR * 16, packColumns);
+            else packColumns(0, nc);
+
+            // Each thread packs its MC blocks of A into its own thread_local buffer
+            auto multiplyRows = [&](size_t low, size_t high){
+                std::vector<T>& bufferA = gemmPackA<T>();
+                if(bufferA.size() < paddedMC * kcMax) bufferA.resize(paddedMC * kcMax);
+
+                for(size_t ic = low; ic < high; ic += mcStep){
+                    size_t mc = std::min(mcStep, high - ic);
+                    packA(mc, kc, A + ic * rsA + pc * csA, rsA, csA, bufferA.data());
+                    gemmMacroKernel(mc, nc, kc, alpha, bufferA.data(), packedB, C + ic * ldc + jc, ldc);
+                }
+            };
+            if(parallel) pool.parallelFor(0, m, mcStep, multiplyRows);
+            else multiplyRows(0, m);
+        }
+    }
+}
+
+// C(m x n) += alpha * A(m x k) * B(k x n), all row-major
+template<class T>
+inline void gemm(size_t m, size_t n, size_t k, T alpha, const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc){
+    gemm(m, n, k, alpha, A, lda, size_t(1), B, ldb, size_t(1), C, ldc);
+}
+
+// C(m x n) += A(m x k) * B(k x n), all row-major
+template<class T>
+inline void gemm(size_t m, size_t n, size_t k, const T* A, size_t lda, const T* B, size_t ldb, T* C, size_t ldc){
+    gemm(m, n, k, T(1), A, lda, size_t(1), B, ldb, size_t(1), C, ldc);
+}
+
+} // namespace detail
+} // namespace la
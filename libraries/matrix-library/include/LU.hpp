@@ -0,0 +1,248 @@
+#pragma once
+
+// LU factorization with partial pivoting, PA = LU.
+// Included by Matrix.hpp after the Matrix class; use it through Matrix.hpp.
+//
+// The factorization is computed once, in place, by a right-looking blocked
+// algorithm (detail::luFactor, also used directly on caller buffers by
+// la::solveInPlace). Afterwards determinant(), solve() for any number of
+// right-hand sides, inverse() and conditionNumber() only need O(n^2)
+// triangular solves per right-hand side.
+
+#include "Allocator.hpp"
+#include "Triangular.hpp"
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <algorithm>
+
+namespace la{
+namespace detail{
+
+constexpr size_t LU_BLOCK = 64;     // panel width
+
+// Unblocked factorization of columns [k0, k1) of the n x n matrix a (all rows from k0 down);
+// row swaps span the full width. Returns false if a pivot fell below the threshold.
+inline bool luFactorPanel(double* a, size_t n, size_t lda, size_t k0, size_t k1,
+                          size_t* pivots, int& pivotSign, double threshold){
+    bool regular = true;
+
+    for(size_t j = k0; j < k1; j++){
+        size_t pivotRow = j;
+        double maxVal = std::abs(a[j * lda + j]);
+        for(size_t r = j + 1; r < n; r++)
+            if(std::abs(a[r * lda + j]) > maxVal){
+                maxVal = std::abs(a[r * lda + j]);
+                pivotRow = r;
+            }
+        pivots[j] = pivotRow;
+
+        if(maxVal < threshold){
+            regular = false;
+            continue;
+        }
+
+        if(pivotRow != j){
+            std::swap_ranges(a + j * lda, a + j * lda + n, a + pivotRow * lda);
+            pivotSign = -pivotSign;
+        }
+
+        double pivot = a[j * lda + j];
+        forEachBand(j + 1, n, k1 - j, [&](size_t low, size_t high){
+            for(size_t r = low; r < high; r++){
+                double factor = a[r * lda + j] /= pivot;
+                for(size_t c = j + 1; c < k1; c++)
+                    a[r * lda + c] -= factor * a[j * lda + c];
+            }
+        });
+    }
+    return regular;
+}
+
+// In-place blocked LU with partial pivoting (PA = LU, unit L below the diagonal, U on and above).
+// Each LU_BLOCK-wide panel is factored, the block row of U is found with a
+// triangular solve and the trailing matrix is updated with one GEMM call.
+// Returns false if the matrix is singular to within the threshold.
+inline bool luFactor(double* a, size_t n, size_t lda, size_t* pivots, int& pivotSign, double threshold){
+    bool regular = true;
+    pivotSign = 1;
+
+    for(size_t k0 = 0; k0 < n; k0 += LU_BLOCK){
+        size_t k1 = std::min(k0 + LU_BLOCK, n);
+
+        regular &= luFactorPanel(a, n, lda, k0, k1, pivots, pivotSign, threshold);
+        if(k1 == n) break;
+
+        // U12 = L11^-1 * A12
+        triangularSolve(Triangle::Lower, false, true, k1 - k0, a + k0 * lda + k0, lda,
+                        a + k0 * lda + k1, lda, n - k1);
+
+        // A22 -= L21 * U12
+        gemm(n - k1, n - k1, k1 - k0, -1.0,
+             a + k1 * lda + k0, lda,
+             a + k0 * lda + k1, lda,
+             a + k1 * lda + k1, lda);
+    }
+    return regular;
+}
+
+// Solve A X = B in place from the factors of luFactor; B is n x numRhs
+inline void luSolve(const double* lu, size_t n, size_t lda, const size_t* pivots, double* b, size_t ldb, size_t numRhs){
+    for(size_t i = 0; i < n; i++)
+        if(pivots[i] != i)
+            std::swap_ranges(b + i * ldb, b + i * ldb + numRhs, b + pivots[i] * ldb);
+
+    triangularSolve(Triangle::Lower, false, true, n, lu, lda, b, ldb, numRhs);
+    triangularSolve(Triangle::Upper, false, false, n, lu, lda, b, ldb, numRhs);
+}
+
+// Solve A^T X = B in place: U^T V = B, L^T W = V, X = P^T W
+inline void luSolveTransposed(const double* lu, size_t n, size_t lda, const size_t* pivots, double* b, size_t ldb, size_t numRhs){
+    triangularSolve(Triangle::Upper, true, false, n, lu, lda, b, ldb, numRhs);
+    triangularSolve(Triangle::Lower, true, true, n, lu, lda, b, ldb, numRhs);
+
+    for(size_t i = n; i-- > 0;)
+        if(pivots[i] != i)
+            std::swap_ranges(b + i * ldb, b + i * ldb + numRhs, b + pivots[i] * ldb);
+}
+
+} // namespace detail
+
+class LU{
+private:
+    size_t n;
+    detail::ScratchVector<double> factors;          // row-major n x n: unit L below the diagonal, U on and above
+    detail::ScratchVector<size_t> pivots;           // row i was swapped with row pivots[i] at step i
+    int pivotSign = 1;                              // sign of the row permutation
+    bool singular = false;
+    double normA = 0.0;                             // 1-norm of A, for the condition estimate
+
+    double at(size_t row, size_t col) const { return factors[row * n + col]; }
+
+    void requireNonSingular() const{
+        if(singular)
+            throw error::NonFatalException("Matrix is singular, cannot solve system.");
+    }
+
+public:
+    // Throws FatalException for non-square input. Pivots smaller than the
+    // threshold mark the matrix singular (same 1e-10 default as the rest of la).
+    explicit LU(ConstMatrixView matrix, double threshold = 1e-10)
+        : n(matrix.cols()){
+        if(matrix.rows() != matrix.cols())
+            throw error::FatalException("LU decomposition requires a square matrix.");
+
+        factors.resize(n * n);
+        matrix.copyTo(factors.data(), n);
+        pivots.resize(n);
+
+        for(size_t col = 0; col < n; col++){
+            double sum = 0.0;
+            for(size_t row = 0; row < n; row++) sum += std::abs(at(row, col));
+            normA = std::max(normA, sum);
+        }
+
+        singular = !detail::luFactor(factors.data(), n, n, pivots.data(), pivotSign, threshold);
+    }
+
+    size_t getSize() const { return n; }
+    bool isSingular() const { return singular; }
+    const detail::ScratchVector<size_t>& getPivots() const { return pivots; }
+
+    double determinant() const{
+        if(singular) return 0.0;
+
+        double det = pivotSign;
+        for(size_t i = 0; i < n; i++) det *= at(i, i);
+        return det;
+    }
+
+    // Solve A X = B in place; b is row-major n x numRhs
+    void solveInPlace(double* b, size_t numRhs) const{
+        requireNonSingular();
+        detail::luSolve(factors.data(), n, n, pivots.data(), b, numRhs, numRhs);
+    }
+
+    void solveInPlace(MatrixView rhs) const{
+        if(rhs.rows() != n)
+            throw error::NonFatalException("Unable to solve system, mismatching dimensions.");
+        requireNonSingular();
+        detail::luSolve(factors.data(), n, n, pivots.data(), rhs.getData(), rhs.getStride(), rhs.cols());
+    }
+
+    // X = A^-1 B, one column of X per column of B
+    Matrix solve(ConstMatrixView rhs) const{
+        Matrix solution(rhs);
+        solveInPlace(solution);
+        return solution;
+    }
+
+    Matrix inverse() const{
+        Matrix result = Matrix::identity(n);
+        solveInPlace(result);
+        return result;
+    }
+
+    // Estimate of the 1-norm condition number ||A|| * ||A^-1|| (Hager/Higham
+    // estimator: a few solves with A and A^T instead of forming the inverse)
+    double conditionNumber() const{
+        if(singular) return std::numeric_limits<double>::infinity();
+
+        detail::ScratchVector<double> x(n, 1.0 / n), y(n), z(n);
+        double estimate = 0.0;
+
+        for(int iteration = 0; iteration < 5; iteration++){
+            y = x;
+            solveInPlace(y.data(), 1);
+
+            double norm = 0.0;
+            for(double value : y) norm += std::abs(value);
+            if(iteration > 0 && norm <= estimate) break;
+            estimate = norm;
+
+            for(size_t i = 0; i < n; i++) z[i] = (y[i] >= 0.0) ? 1.0 : -1.0;
+            detail::luSolveTransposed(factors.data(), n, n, pivots.data(), z.data(), 1, 1);
+
+            size_t maxIndex = 0;
+            double dot = 0.0;
+            for(size_t i = 0; i < n; i++){
+                if(std::abs(z[i]) > std::abs(z[maxIndex])) maxIndex = i;
+                dot += z[i] * x[i];
+            }
+            if(iteration > 0 && std::abs(z[maxIndex]) <= dot) break;
+
+            std::fill(x.begin(), x.end(), 0.0);
+            x[maxIndex] = 1.0;
+        }
+
+        // Alternating-sign test vector guards against the estimator's known bad cases
+        for(size_t i = 0; i < n; i++)
+            x[i] = ((i % 2) ? -1.0 : 1.0) * (1.0 + (n > 1 ? double(i) / (n - 1) : 0.0));
+        solveInPlace(x.data(), 1);
+        double alternate = 0.0;
+        for(double value : x) alternate += std::abs(value);
+        estimate = std::max(estimate, 2.0 * alternate / (3.0 * n));
+
+        return normA * estimate;
+    }
+
+    // Unit lower-triangular factor L
+    Matrix lower() const{
+        Matrix result = Matrix::identity(n);
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = 0; j < i; j++)
+                result[i][j] = at(i, j);
+        return result;
+    }
+
+    // Upper-triangular factor U
+    Matrix upper() const{
+        Matrix result(n, n);
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = i; j < n; j++)
+                result[i][j] = at(i, j);
+        return result;
+    }
+};
+
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include "Allocator.hpp"
+#include "Error.hpp"
+#include "Expression.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+// Non-owning views into row-major storage: a pointer, a shape and a stride
+// (the distance in elements between the starts of consecutive rows). A view
+// of a Matrix, one of its rows, columns or blocks, or of a view, never copies;
+// it stays valid as long as the storage it refers to is alive and not resized.
+//
+// Views are matrix expressions, so they mix with Matrix in the elementwise
+// operators and products, and every la algorithm that reads a matrix
+// (multiply, LU, Cholesky, QR, solve, SymmetricEigen, SVD) takes a
+// ConstMatrixView, which a Matrix converts to implicitly. Assigning to a
+// MatrixView writes through to the underlying storage.
+
+namespace la{
+
+template<class T>
+class BasicMatrixView;
+
+using MatrixView = BasicMatrixView<double>;                 // read-write
+using ConstMatrixView = BasicMatrixView<const double>;      // read-only
+
+namespace detail{
+
+template<class T>
+struct ExprOperand<BasicMatrixView<T>>{
+    static MatrixRef<std::remove_const_t<T>> wrap(const BasicMatrixView<T>& view){
+        return MatrixRef<std::remove_const_t<T>>(view.getData(), view.rows(), view.cols(), view.getStride());
+    }
+};
+
+// out (rows x cols, row stride `stride`) = expr. Row chunks are written straight into
+// the view unless the expression reads the same storage, which is evaluated first.
+template<class E>
+void evaluateIntoView(const E& expr, ExprValueT<E>* out, size_t rows, size_t cols, size_t stride){
+    using T = ExprValueT<E>;
+    if(expr.overlaps(out, out + (rows - 1) * stride + cols)){
+        ScratchVector<T> values(rows * cols);
+        evaluateInto(expr, values.data(), values.size());
+        for(size_t r = 0; r < rows; r++)
+            std::copy(values.begin() + r * cols, values.begin() + (r + 1) * cols, out + r * stride);
+        return;
+    }
+    if(stride == cols){
+        evaluateInto(expr, out, rows * cols);
+        return;
+    }
+
+    forEachBand(0, rows, cols, [&](size_t low, size_t high){
+        T scratch[EXPR_BLOCK];
+        for(size_t r = low; r < high; r++)
+            for(size_t c = 0; c < cols; c += EXPR_BLOCK){
+                size_t length = std::min(EXPR_BLOCK, cols - c);
+                const T* result = expr.block(r * cols + c, length, scratch);
+                std::copy(result, result + length, out + r * stride + c);
+            }
+    });
+}
+
+// out (op)= expr for a strided destination
+template<class Op, class E>
+void accumulateIntoView(const E& expr, ExprValueT<E>* out, size_t rows, size_t cols, size_t stride){
+    using T = ExprValueT<E>;
+    if(expr.overlaps(out, out + (rows - 1) * stride + cols)){
+        ScratchVector<T> values(rows * cols);
+        evaluateInto(expr, values.data(), values.size());
+        accumulateIntoView<Op>(MatrixRef<T>(values.data(), rows, cols, cols), out, rows, cols, stride);
+        return;
+    }
+
+    forEachBand(0, rows, cols, [&](size_t low, size_t high){
+        T scratch[EXPR_BLOCK];
+        for(size_t r = low; r < high; r++)
+            for(size_t c = 0; c < cols; c += EXPR_BLOCK){
+                size_t length = std::min(EXPR_BLOCK, cols - c);
+                const T* result = expr.block(r * cols + c, length, scratch);
+                T* target = out + r * stride + c;
+                Op::apply(target, result, target, length);
+            }
+    });
+}
+
+} // namespace detail
+
+template<class T>
+class BasicMatrixView : public MatrixExpr<BasicMatrixView<T>>{
+private:
+    T* values;
+    size_t numRows, numCols, stride;
+
+    void requireWritable() const {
+        static_assert(!std::is_const<T>::value, "Cannot assign through a ConstMatrixView.");
+    }
+
+public:
+    using value_type = std::remove_const_t<T>;
+
+    // Throws FatalException for an empty shape or a stride shorter than a row
+    BasicMatrixView(T* values, size_t numRows, size_t numCols, size_t stride)
+        : values(values), numRows(numRows), numCols(numCols), stride(stride){
+        if(numRows < 1 || numCols < 1)
+            throw error::FatalException("Matrix dimensions must be greater than 0");
+        if(stride < numCols)
+            throw error::FatalException("Matrix view stride must be at least the number of columns.");
+    }
+
+    BasicMatrixView(T* values, size_t numRows, size_t numCols)
+        : BasicMatrixView(values, numRows, numCols, numCols) {}
+
+    // The whole of a Matrix
+    BasicMatrixView(BasicMatrix<value_type>& matrix)
+        : BasicMatrixView(matrix.getData(), matrix.getColSize(), matrix.getRowSize(), matrix.getStride()) {}
+    template<class U = T, std::enable_if_t<std::is_const<U>::value, int> = 0>
+    BasicMatrixView(const BasicMatrix<value_type>& matrix)
+        : BasicMatrixView(matrix.getData(), matrix.getColSize(), matrix.getRowSize(), matrix.getStride()) {}
+
+    // MatrixView -> ConstMatrixView
+    template<class U, std::enable_if_t<std::is_const<T>::value && std::is_same<const U, T>::value, int> = 0>
+    BasicMatrixView(const BasicMatrixView<U>& other)
+        : values(other.getData()), numRows(other.rows()), numCols(other.cols()), stride(other.getStride()) {}
+
+    BasicMatrixView(const BasicMatrixView&) = default;
+
+    // Assignment copies elements into the viewed storage (shapes must match); it never rebinds the view
+    BasicMatrixView& operator=(const BasicMatrixView& other){
+        return *this = static_cast<const MatrixExpr<BasicMatrixView>&>(other);
+    }
+
+    template<class E>
+    BasicMatrixView& operator=(const MatrixExpr<E>& expr){
+        requireWritable();
+        const auto& operand = detail::wrapOperand(expr);
+        detail::checkSameShape(operand, *this, "Unable to assign to matrix view, mismatching dimensions.");
+        detail::evaluateIntoView(operand, values, numRows, numCols, stride);
+        return *this;
+    }
+
+    template<class E>
+    BasicMatrixView& operator+=(const MatrixExpr<E>& expr){
+        requireWritable();
+        const auto& operand = detail::wrapOperand(expr);
+        detail::checkSameShape(operand, *this, "Unable to add matrices, mismatching dimensions");
+        detail::accumulateIntoView<detail::AddOp>(operand, values, numRows, numCols, stride);
+        return *this;
+    }
+
+    template<class E>
+    BasicMatrixView& operator-=(const MatrixExpr<E>& expr){
+        requireWritable();
+        const auto& operand = detail::wrapOperand(expr);
+        detail::checkSameShape(operand, *this, "Unable to subtract matrices, mismatching dimensions");
+        detail::accumulateIntoView<detail::SubOp>(operand, values, numRows, numCols, stride);
+        return *this;
+    }
+
+    BasicMatrixView& operator*=(value_type scalar){
+        requireWritable();
+        for(size_t r = 0; r < numRows; r++)
+            detail::simd<value_type>().mulVS(values + r * stride, scalar, values + r * stride, numCols);
+        return *this;
+    }
+
+    void fill(value_type value){
+        requireWritable();
+        for(size_t r = 0; r < numRows; r++)
+            std::fill(values + r * stride, values + r * stride + numCols, value);
+    }
+
+    size_t rows() const { return numRows; }
+    size_t cols() const { return numCols; }
+    size_t getStride() const { return stride; }
+    T* getData() const { return values; }
+    bool isContiguous() const { return stride == numCols || numRows == 1; }
+
+    T* operator[](size_t row) const { return values + row * stride; }     // element access using [row][col]
+    T& operator()(size_t row, size_t col) const { return values[row * stride + col]; }
+
+    // Slices; all refer to the same storage
+    BasicMatrixView block(size_t row, size_t col, size_t blockRows, size_t blockCols) const{
+        if(row + blockRows > numRows || col + blockCols > numCols)
+            throw error::FatalException("Matrix view block out of range.");
+        return BasicMatrixView(values + row * stride + col, blockRows, blockCols, stride);
+    }
+
+    BasicMatrixView row(size_t row) const { return block(row, 0, 1, numCols); }
+    BasicMatrixView col(size_t col) const { return block(0, col, numRows, 1); }
+
+    // Copy into row-major storage with leading dimension ldo
+    void copyTo(value_type* out, size_t ldo) const{
+        for(size_t r = 0; r < numRows; r++)
+            std::copy(values + r * stride, values + r * stride + numCols, out + r * ldo);
+    }
+};
+
+}
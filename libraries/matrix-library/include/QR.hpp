@@ -0,0 +1,282 @@
+#pragma once
+
+// Householder QR factorization A = QR of an m x n matrix with m >= n, used
+// for least-squares problems. Included by Matrix.hpp after the Matrix class;
+// use it through Matrix.hpp.
+//
+// Storage follows LAPACK: R is kept on and above the diagonal, and the
+// Householder vector of step j (with an implicit leading 1) below it, so
+// Q = H_0 H_1 ... H_{n-1} with H_j = I - tau_j v_j v_j^T is never formed.
+// Reflectors are grouped QR_BLOCK at a time into the compact WY form
+// I - V T V^T, which both the factorization's trailing update and the
+// application of Q to right-hand sides apply with two GEMM calls.
+
+#include "Allocator.hpp"
+#include "Triangular.hpp"
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace la{
+namespace detail{
+
+// Apply H = I - tau v v^T (v[0] = 1 implicit, v[i] = a[(start + i) * lda + column]) to
+// rows [start, m) and columns [low, high) of b
+inline void applyHouseholder(const double* a, size_t lda, size_t m, size_t start, size_t column, double tau,
+                             double* b, size_t ldb, size_t low, size_t high){
+    if(tau == 0.0 || low >= high) return;
+
+    // w = v^T B, accumulated row by row so the inner loops are contiguous
+    ScratchVector<double> w(b + start * ldb + low, b + start * ldb + high);
+    for(size_t i = start + 1; i < m; i++){
+        double v = a[i * lda + column];
+        const double* bRow = b + i * ldb;
+        for(size_t c = low; c < high; c++) w[c - low] += v * bRow[c];
+    }
+
+    // B -= tau v w
+    double* firstRow = b + start * ldb;
+    for(size_t c = low; c < high; c++) firstRow[c] -= tau * w[c - low];
+    for(size_t i = start + 1; i < m; i++){
+        double scale = tau * a[i * lda + column];
+        double* bRow = b + i * ldb;
+        for(size_t c = low; c < high; c++) bRow[c] -= scale * w[c - low];
+    }
+}
+
+constexpr size_t QR_BLOCK = 32;    // Householder vectors per block reflector
+
+// Unblocked Householder QR of columns [k0, k1) of the m x n matrix a, all rows from k0 down;
+// reflectors are applied to the panel columns only
+inline void qrFactorPanel(double* a, size_t m, size_t lda, size_t k0, size_t k1, double* tau){
+    for(size_t j = k0; j < k1; j++){
+        double alpha = a[j * lda + j];
+        double sigma = 0.0;
+        for(size_t i = j + 1; i < m; i++) sigma += a[i * lda + j] * a[i * lda + j];
+
+        if(sigma == 0.0){
+            tau[j] = 0.0;
+            continue;
+        }
+
+        double beta = -std::copysign(std::sqrt(alpha * alpha + sigma), alpha);
+        tau[j] = (beta - alpha) / beta;
+        double scale = 1.0 / (alpha - beta);
+        for(size_t i = j + 1; i < m; i++) a[i * lda + j] *= scale;
+        a[j * lda + j] = beta;
+
+        applyHouseholder(a, lda, m, j, j, tau[j], a, lda, j + 1, k1);
+    }
+}
+
+// Compact WY form of the reflectors k0 .. k0 + kb - 1: H_k0 ... H_(k0+kb-1) = I - V T V^T.
+// v receives V explicitly ((m - k0) x kb, unit lower trapezoidal) and t the kb x kb upper-triangular T.
+inline void qrBlockReflector(const double* qr, size_t m, size_t lda, size_t k0, size_t kb, const double* tau,
+                             ScratchVector<double>& v, ScratchVector<double>& t){
+    size_t rows = m - k0;
+    v.assign(rows * kb, 0.0);
+    for(size_t i = 0; i < rows; i++)
+        for(size_t j = 0; j < kb && j <= i; j++)
+            v[i * kb + j] = (i == j) ? 1.0 : qr[(k0 + i) * lda + k0 + j];
+
+    // T(0:i, i) = -tau_i T(0:i, 0:i) V(:, 0:i)^T v_i, as in LAPACK's larft
+    t.assign(kb * kb, 0.0);
+    ScratchVector<double> z(kb);
+    for(size_t i = 0; i < kb; i++){
+        double tauI = tau[k0 + i];
+        t[i * kb + i] = tauI;
+        if(tauI == 0.0) continue;
+
+        std::fill(z.begin(), z.begin() + i, 0.0);
+        for(size_t r = i; r < rows; r++){
+            double vi = v[r * kb + i];
+            for(size_t j = 0; j < i; j++) z[j] += v[r * kb + j] * vi;
+        }
+        for(size_t p = 0; p < i; p++){
+            double sum = 0.0;
+            for(size_t q = p; q < i; q++) sum += t[p * kb + q] * z[q];
+            t[p * kb + i] = -tauI * sum;
+        }
+    }
+}
+
+// C := (I - V T V^T) C, or its transpose (I - V T^T V^T) C, for the rows x nc matrix c
+inline void applyBlockReflector(bool transposed, const double* v, const double* t, size_t rows, size_t kb,
+                                double* c, size_t ldc, size_t nc){
+    // W = V^T C
+    ScratchVector<double> w(kb * nc, 0.0);
+    gemm(kb, nc, rows, 1.0, v, 1, kb, c, ldc, 1, w.data(), nc);
+
+    // W := op(T) W, column bands in parallel; the loop order lets each row be overwritten in place
+    forEachBand(0, nc, kb * kb, [&](size_t low, size_t high){
+        if(transposed){
+            for(size_t i = kb; i-- > 0;){
+                double* wRow = w.data() + i * nc;
+                for(size_t col = low; col < high; col++) wRow[col] *= t[i * kb + i];
+                for(size_t p = 0; p < i; p++){
+                    double factor = t[p * kb + i];
+                    const double* source = w.data() + p * nc;
+                    for(size_t col = low; col < high; col++) wRow[col] += factor * source[col];
+                }
+            }
+        }else{
+            for(size_t i = 0; i < kb; i++){
+                double* wRow = w.data() + i * nc;
+                for(size_t col = low; col < high; col++) wRow[col] *= t[i * kb + i];
+                for(size_t p = i + 1; p < kb; p++){
+                    double factor = t[i * kb + p];
+                    const double* source = w.data() + p * nc;
+                    for(size_t col = low; col < high; col++) wRow[col] += factor * source[col];
+                }
+            }
+        }
+    });
+
+    // C -= V W
+    gemm(rows, nc, kb, -1.0, v, kb, 1, w.data(), nc, 1, c, ldc);
+}
+
+// In-place blocked Householder QR of the m x n matrix a (m >= n); tau receives n scalars.
+// Each QR_BLOCK-wide panel is factored unblocked and then applied to the trailing
+// columns at once as a block reflector, so the bulk of the work runs through GEMM.
+inline void qrFactor(double* a, size_t m, size_t n, size_t lda, double* tau){
+    ScratchVector<double> v, t;
+    for(size_t k0 = 0; k0 < n; k0 += QR_BLOCK){
+        size_t k1 = std::min(k0 + QR_BLOCK, n);
+
+        qrFactorPanel(a, m, lda, k0, k1, tau);
+        if(k1 == n) break;
+
+        qrBlockReflector(a, m, lda, k0, k1 - k0, tau, v, t);
+        applyBlockReflector(true, v.data(), t.data(), m - k0, k1 - k0, a + k0 * lda + k1, lda, n - k1);
+    }
+}
+
+// B := Q^T B for the m x numRhs matrix b
+inline void qrApplyQt(const double* qr, size_t m, size_t n, size_t lda, const double* tau, double* b, size_t ldb, size_t numRhs){
+    // Too few columns for block reflectors to pay off: one reflector at a time
+    if(numRhs < GEMM_NR){
+        for(size_t j = 0; j < n; j++)
+            applyHouseholder(qr, lda, m, j, j, tau[j], b, ldb, 0, numRhs);
+        return;
+    }
+
+    ScratchVector<double> v, t;
+    for(size_t k0 = 0; k0 < n; k0 += QR_BLOCK){
+        size_t kb = std::min(QR_BLOCK, n - k0);
+        qrBlockReflector(qr, m, lda, k0, kb, tau, v, t);
+        applyBlockReflector(true, v.data(), t.data(), m - k0, kb, b + k0 * ldb, ldb, numRhs);
+    }
+}
+
+// B := Q B for the m x numRhs matrix b
+inline void qrApplyQ(const double* qr, size_t m, size_t n, size_t lda, const double* tau, double* b, size_t ldb, size_t numRhs){
+    if(numRhs < GEMM_NR){
+        for(size_t j = n; j-- > 0;)
+            applyHouseholder(qr, lda, m, j, j, tau[j], b, ldb, 0, numRhs);
+        return;
+    }
+
+    ScratchVector<double> v, t;
+    for(size_t k1 = n; k1 > 0;){
+        size_t k0 = (k1 - 1) / QR_BLOCK * QR_BLOCK;
+        qrBlockReflector(qr, m, lda, k0, k1 - k0, tau, v, t);
+        applyBlockReflector(false, v.data(), t.data(), m - k0, k1 - k0, b + k0 * ldb, ldb, numRhs);
+        k1 = k0;
+    }
+}
+
+// Whether every |R_jj| reaches the threshold
+inline bool qrFullRank(const double* qr, size_t n, size_t lda, double threshold){
+    for(size_t j = 0; j < n; j++)
+        if(std::abs(qr[j * lda + j]) < threshold) return false;
+    return true;
+}
+
+// Least-squares solve min ||A X - B|| in place: B := Q^T B, then R X = (top n rows of B).
+// The solution ends up in the first n rows of b; the remaining m - n rows hold the residual components.
+inline void qrSolve(const double* qr, size_t m, size_t n, size_t lda, const double* tau, double* b, size_t ldb, size_t numRhs){
+    qrApplyQt(qr, m, n, lda, tau, b, ldb, numRhs);
+    triangularSolve(Triangle::Upper, false, false, n, qr, lda, b, ldb, numRhs);
+}
+
+} // namespace detail
+
+class QR{
+private:
+    size_t m, n;
+    detail::ScratchVector<double> factors; // row-major m x n: R on and above the diagonal, Householder vectors below
+    detail::ScratchVector<double> tau;
+    bool fullRank;
+
+public:
+    // Throws FatalException when A has fewer rows than columns. Diagonal
+    // entries of R below the threshold mark A as rank deficient.
+    explicit QR(ConstMatrixView matrix, double threshold = 1e-10)
+        : m(matrix.rows()), n(matrix.cols()){
+        if(m < n)
+            throw error::FatalException("QR decomposition requires at least as many rows as columns.");
+
+        factors.resize(m * n);
+        matrix.copyTo(factors.data(), n);
+        tau.resize(n);
+        detail::qrFactor(factors.data(), m, n, n, tau.data());
+        fullRank = detail::qrFullRank(factors.data(), n, n, threshold);
+    }
+
+    size_t getRows() const { return m; }
+    size_t getCols() const { return n; }
+    bool isFullRank() const { return fullRank; }
+
+    // Least-squares solution X (n x k) of A X = B for B with m rows
+    Matrix solve(ConstMatrixView rhs) const{
+        if(rhs.rows() != m)
+            throw error::NonFatalException("Unable to solve system, mismatching dimensions.");
+        if(!fullRank)
+            throw error::NonFatalException("Matrix is rank deficient, cannot solve least-squares system.");
+
+        size_t numRhs = rhs.cols();
+        detail::ScratchVector<double> work(m * numRhs);
+        rhs.copyTo(work.data(), numRhs);
+        detail::qrSolve(factors.data(), m, n, n, tau.data(), work.data(), numRhs, numRhs);
+
+        Matrix solution(numRhs, n);
+        std::copy(work.begin(), work.begin() + n * numRhs, solution.getData());
+        return solution;
+    }
+
+    // Upper-triangular factor R (n x n)
+    Matrix upper() const{
+        Matrix result(n, n);
+        for(size_t i = 0; i < n; i++)
+            for(size_t j = i; j < n; j++)
+                result[i][j] = factors[i * n + j];
+        return result;
+    }
+
+    // Orthonormal factor Q (m x n, thin form)
+    Matrix orthogonal() const{
+        Matrix result(n, m);
+        for(size_t i = 0; i < n; i++) result[i][i] = 1.0;
+        detail::qrApplyQ(factors.data(), m, n, n, tau.data(), result.getData(), n, n);
+        return result;
+    }
+};
+
+// Factor in place when only R is needed (for example R^T R = A^T A in covariance
+// computations): on return the first n rows of the m x n `matrix` hold R and the
+// rows below are zero. Use la::QR for Q or least-squares solves.
+inline void qrInPlace(MatrixView matrix){
+    size_t m = matrix.rows(), n = matrix.cols(), lda = matrix.getStride();
+    if(m < n)
+        throw error::FatalException("QR decomposition requires at least as many rows as columns.");
+
+    double* a = matrix.getData();
+    detail::ScratchVector<double> tau(n);
+    detail::qrFactor(a, m, n, lda, tau.data());
+
+    for(size_t i = 1; i < m; i++)
+        std::fill(a + i * lda, a + i * lda + std::min(i, n), 0.0);
+}
+
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include "Allocator.hpp"
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+// Row reduction behind rowEchelonForm() and reducedREF(), on row-major buffers.
+// Both passes are blocked and right-looking: a panel of ROW_REDUCTION_BLOCK
+// pivot columns is eliminated one pivot at a time, and its effect on the rest
+// of the matrix is then applied as a single rank-k update through the parallel
+// GEMM kernel, so almost all of the work is GEMM. Pivots, skipped columns and
+// the resulting forms are those of the one-pivot-at-a-time elimination; only
+// the order of the floating-point sums differs.
+
+namespace la{
+namespace detail{
+
+constexpr size_t ROW_REDUCTION_BLOCK = 64;                  // pivot columns per panel
+constexpr double ROW_REDUCTION_PIVOT_TOLERANCE = 1e-10;     // a column with no larger entry gets no pivot
+
+// Forward elimination of the rows x cols matrix a (leading dimension lda): for each
+// diagonal position i, the largest entry of column i at or below row i is swapped up,
+// row i is divided by it and column i is eliminated below it. Columns without an entry
+// above the tolerance are skipped and left as they are.
+template<class T>
+void rowEchelonInPlace(T* a, size_t rows, size_t cols, size_t lda){
+    size_t steps = std::min(rows, cols);
+    auto row = [&](size_t r){ return a + r * lda; };
+
+    ScratchVector<T> pivots(ROW_REDUCTION_BLOCK), multipliers;
+    ScratchVector<unsigned char> skipped(ROW_REDUCTION_BLOCK);
+
+    for(size_t p0 = 0; p0 < steps; p0 += ROW_REDUCTION_BLOCK){
+        size_t p1 = std::min(p0 + ROW_REDUCTION_BLOCK, steps), nb = p1 - p0;
+
+        // Panel columns [p0, p1): whole rows are swapped, but only the panel is normalized and
+        // eliminated. Each multiplier stays in the entry it eliminates until the panel is done.
+        for(size_t i = p0; i < p1; i++){
+            double maxVal = 0.0;
+            size_t pivotRow = i;
+            for(size_t r = i; r < rows; r++){
+                double currentValue = std::abs(row(r)[i]);
+                if(currentValue > maxVal){
+                    maxVal = currentValue;
+                    pivotRow = r;
+                }
+            }
+
+            skipped[i - p0] = maxVal < ROW_REDUCTION_PIVOT_TOLERANCE;
+            if(skipped[i - p0]) continue;
+
+            if(pivotRow != i) std::swap_ranges(row(i), row(i) + cols, row(pivotRow));
+
+            T* pivotRowData = row(i);
+            T pivot = pivotRowData[i];
+            pivots[i - p0] = pivot;
+            for(size_t j = i; j < p1; j++) pivotRowData[j] /= pivot;
+
+            forEachBand(i + 1, rows, p1 - i, [&](size_t low, size_t high){
+                for(size_t k = low; k < high; k++){
+                    T* rowK = row(k);
+                    T factor = rowK[i];
+                    for(size_t j = i + 1; j < p1; j++) rowK[j] -= factor * pivotRowData[j];
+                }
+            });
+        }
+
+        // Multipliers L (rows - p0) x nb, zero in skipped columns; the eliminated entries become zero
+        multipliers.assign((rows - p0) * nb, T(0));
+        for(size_t r = p0 + 1; r < rows; r++)
+            for(size_t c = 0; c < nb && p0 + c < r; c++)
+                if(!skipped[c]){
+                    multipliers[(r - p0) * nb + c] = row(r)[p0 + c];
+                    row(r)[p0 + c] = T(0);
+                }
+
+        if(p1 == cols) continue;
+
+        // Panel rows right of the panel: forward substitution with L11, then the pivot scaling.
+        // Column bands are independent.
+        forEachBand(p1, cols, nb, [&](size_t low, size_t high){
+            for(size_t i = p0; i < p1; i++){
+                T* rowI = row(i);
+                for(size_t p = p0; p < i; p++){
+                    if(skipped[p - p0]) continue;
+                    T factor = multipliers[(i - p0) * nb + (p - p0)];
+                    const T* rowP = row(p);
+                    for(size_t j = low; j < high; j++) rowI[j] -= factor * rowP[j];
+                }
+                if(!skipped[i - p0])
+                    for(size_t j = low; j < high; j++) rowI[j] /= pivots[i - p0];
+            }
+        });
+
+        // Rows below the panel: A22 -= L21 U12
+        if(p1 < rows)
+            gemm(rows - p1, cols - p1, nb, T(-1),
+                 multipliers.data() + (p1 - p0) * nb, nb,
+                 row(p0) + p1, lda,
+                 row(p1) + p1, lda);
+    }
+}
+
+// Back substitution of a row echelon form: from the last diagonal position i up to the
+// first, row i (from column i on) times the entry above it in column i is subtracted from
+// every row above. Panels run right to left; the rows above a panel get one GEMM update.
+template<class T>
+void backSubstituteInPlace(T* a, size_t rows, size_t cols, size_t lda){
+    size_t steps = std::min(rows, cols);
+    auto row = [&](size_t r){ return a + r * lda; };
+
+    ScratchVector<T> multipliers, pivotRows;
+
+    for(size_t p1 = steps; p1 > 0;){
+        size_t p0 = p1 > ROW_REDUCTION_BLOCK ? p1 - ROW_REDUCTION_BLOCK : 0, nb = p1 - p0;
+
+        // Within the panel, column i of the rows above i is only read by step i, so the
+        // multipliers can be taken up front and column bands run independently
+        multipliers.assign(nb * nb, T(0));
+        for(size_t k = p0; k < p1; k++)
+            for(size_t i = k + 1; i < p1; i++) multipliers[(k - p0) * nb + (i - p0)] = row(k)[i];
+
+        forEachBand(p0, cols, nb, [&](size_t low, size_t high){
+            for(size_t i = p1; i-- > p0;){
+                const T* rowI = row(i);
+                for(size_t k = p0; k < i; k++){
+                    T factor = multipliers[(k - p0) * nb + (i - p0)];
+                    T* rowK = row(k);
+                    for(size_t j = std::max(low, i); j < high; j++) rowK[j] -= factor * rowI[j];
+                }
+            }
+        });
+
+        // Rows above the panel: A[0:p0, p0:] -= C U, where C = A[0:p0, p0:p1] is copied (the update
+        // overwrites it) and row i of U is the final row i from column i on, zero left of it
+        if(p0 > 0){
+            size_t width = cols - p0;
+            multipliers.resize(p0 * nb);
+            for(size_t k = 0; k < p0; k++) std::copy(row(k) + p0, row(k) + p1, multipliers.data() + k * nb);
+
+            pivotRows.assign(nb * width, T(0));
+            for(size_t i = p0; i < p1; i++) std::copy(row(i) + i, row(i) + cols, pivotRows.data() + (i - p0) * width + (i - p0));
+
+            gemm(p0, width, nb, T(-1), multipliers.data(), nb, pivotRows.data(), width, row(0) + p0, lda);
+        }
+        p1 = p0;
+    }
+}
+
+} // namespace detail
+} // namespace la
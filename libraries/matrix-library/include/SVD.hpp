@@ -0,0 +1,293 @@
+#pragma once
+
+// Singular value decomposition A = U diag(sigma) V^T.
+// Included by Matrix.hpp after the Matrix class; use it through Matrix.hpp.
+//
+// The full decomposition uses one-sided Jacobi: pairs of columns are rotated
+// until all are mutually orthogonal, which gives singular values to high
+// relative accuracy. Tall matrices are first reduced with the blocked QR so
+// Jacobi only works on the n x n factor R, and each sweep visits the column
+// pairs in round-robin order so the disjoint pairs of a round run in parallel.
+//
+// With a `count` smaller than min(m, n) only the leading singular triplets are
+// computed, by block subspace iteration: a basis of count + SVD_OVERSAMPLE
+// columns is alternately multiplied by A and A^T and re-orthonormalized with QR,
+// and the Jacobi SVD of the small projected matrix gives the triplets. A itself
+// is never squared (as A^T A would be), so singular values are accurate to about
+// 1e-12 of the largest; if the iteration stalls on a flat spectrum the full
+// decomposition is computed and truncated instead.
+
+#include "QR.hpp"
+#include <vector>
+#include <cstdint>
+#include <cmath>
+#include <atomic>
+#include <numeric>
+#include <algorithm>
+
+namespace la{
+namespace detail{
+
+constexpr size_t SVD_OVERSAMPLE = 10;     // extra basis columns in the truncated SVD's subspace iteration
+
+// One-sided Jacobi on the n rows (length len) of g, accumulating the same rotations on
+// the n rows (length n) of vt. On return the rows of g are mutually orthogonal.
+// Returns false if the sweeps failed to converge.
+inline bool jacobiOrthogonalize(double* g, size_t n, size_t len, double* vt){
+    const double tolerance = 1e-15;
+    size_t players = n + (n % 2);           // round-robin needs an even count; index n is a bye
+
+    for(int sweep = 0; sweep < 60; sweep++){
+        std::atomic<bool> rotated{false};
+
+        for(size_t round = 0; round + 1 < players; round++){
+            // Circle method: player players - 1 stays fixed, the others rotate
+            auto pairAt = [&](size_t index, size_t& p, size_t& q){
+                if(index == 0){
+                    p = round;
+                    q = players - 1;
+                }else{
+                    p = (round + index) % (players - 1);
+                    q = (round + players - 1 - index) % (players - 1);
+                }
+            };
+
+            forEachBand(0, players / 2, 2 * (len + n), [&](size_t low, size_t high){
+                for(size_t index = low; index < high; index++){
+                    size_t p, q;
+                    pairAt(index, p, q);
+                    if(p >= n || q >= n) continue;
+
+                    double* gp = g + p * len;
+                    double* gq = g + q * len;
+                    double alpha = 0.0, beta = 0.0, gamma = 0.0;
+                    for(size_t i = 0; i < len; i++){
+                        alpha += gp[i] * gp[i];
+                        beta += gq[i] * gq[i];
+                        gamma += gp[i] * gq[i];
+                    }
+                    if(std::abs(gamma) <= tolerance * std::sqrt(alpha * beta)) continue;
+                    rotated = true;
+
+                    double zeta = (beta - alpha) / (2.0 * gamma);
+                    double t = std::copysign(1.0, zeta) / (std::abs(zeta) + std::sqrt(1.0 + zeta * zeta));
+                    double c = 1.0 / std::sqrt(1.0 + t * t);
+                    double s = c * t;
+
+                    auto rotate = [&](double* x, double* y, size_t length){
+                        for(size_t i = 0; i < length; i++){
+                            double xi = x[i], yi = y[i];
+                            x[i] = c * xi - s * yi;
+                            y[i] = s * xi + c * yi;
+                        }
+                    };
+                    rotate(gp, gq, len);
+                    rotate(vt + p * n, vt + q * n, n);
+                }
+            });
+        }
+        if(!rotated) return true;
+    }
+    return false;
+}
+
+} // namespace detail
+
+class SVD{
+private:
+    size_t m, n;
+    std::vector<double> values;         // descending
+    std::vector<double> left;           // row-major m x count, left singular vectors as columns
+    std::vector<double> right;          // row-major n x count, right singular vectors as columns
+
+    // Full decomposition of a tall (rows >= cols) row-major matrix into u (rows x cols) and v (cols x cols)
+    static void jacobiSVD(const double* a, size_t rows, size_t cols,
+                          std::vector<double>& sigma, std::vector<double>& u, std::vector<double>& v){
+        // Reduce to the cols x cols R factor when there are extra rows
+        std::vector<double> qr, tau;
+        std::vector<double> g(cols * cols);         // columns of the matrix being orthogonalized, one per row
+        bool reduced = rows > cols;
+        if(reduced){
+            qr.assign(a, a + rows * cols);
+            tau.resize(cols);
+            detail::qrFactor(qr.data(), rows, cols, cols, tau.data());
+            for(size_t i = 0; i < cols; i++)
+                for(size_t j = i; j < cols; j++) g[j * cols + i] = qr[i * cols + j];
+        }else{
+            for(size_t i = 0; i < rows; i++)
+                for(size_t j = 0; j < cols; j++) g[j * cols + i] = a[i * cols + j];
+        }
+
+        std::vector<double> vt(cols * cols, 0.0);
+        for(size_t i = 0; i < cols; i++) vt[i * cols + i] = 1.0;
+        if(!detail::jacobiOrthogonalize(g.data(), cols, cols, vt.data()))
+            throw error::NonFatalException("Singular value iteration did not converge.");
+
+        std::vector<double> norms(cols);
+        for(size_t j = 0; j < cols; j++){
+            double sum = 0.0;
+            for(size_t i = 0; i < cols; i++) sum += g[j * cols + i] * g[j * cols + i];
+            norms[j] = std::sqrt(sum);
+        }
+        std::vector<size_t> order(cols);
+        std::iota(order.begin(), order.end(), 0);
+        std::sort(order.begin(), order.end(), [&](size_t i, size_t j){ return norms[i] > norms[j]; });
+
+        sigma.resize(cols);
+        u.assign(rows * cols, 0.0);
+        v.resize(cols * cols);
+        for(size_t k = 0; k < cols; k++){
+            size_t j = order[k];
+            sigma[k] = norms[j];
+            double scale = (norms[j] > 0.0) ? 1.0 / norms[j] : 0.0;
+            for(size_t i = 0; i < cols; i++){
+                u[i * cols + k] = g[j * cols + i] * scale;
+                v[i * cols + k] = vt[j * cols + i];
+            }
+        }
+
+        // U = Q [U_R; 0]
+        if(reduced)
+            detail::qrApplyQ(qr.data(), rows, cols, cols, tau.data(), u.data(), cols, cols);
+    }
+
+    // Overwrite the row-major rows x cols matrix y (rows >= cols) with an orthonormal basis of its columns
+    static void orthonormalize(double* y, size_t rows, size_t cols){
+        std::vector<double> qr(y, y + rows * cols), tau(cols);
+        detail::qrFactor(qr.data(), rows, cols, cols, tau.data());
+        std::fill(y, y + rows * cols, 0.0);
+        for(size_t j = 0; j < cols; j++) y[j * cols + j] = 1.0;
+        detail::qrApplyQ(qr.data(), rows, cols, cols, tau.data(), y, cols, cols);
+    }
+
+    // Leading `count` triplets of a tall (rows >= cols) matrix by block subspace iteration
+    static void subspaceSVD(const Matrix& matrix, size_t rows, size_t cols, size_t count,
+                            std::vector<double>& sigma, std::vector<double>& u, std::vector<double>& v){
+        size_t width = std::min(cols, count + detail::SVD_OVERSAMPLE);
+        const double* a = matrix.getData();
+        size_t stride = matrix.getStride();
+
+        // Deterministic pseudo-random start so results are reproducible
+        std::vector<double> z(cols * width);
+        uint64_t state = 0x9E3779B97F4A7C15ull;
+        for(double& value : z){
+            state = state * 6364136223846793005ull + 1442695040888963407ull;
+            value = double(state >> 11) * (2.0 / 9007199254740992.0) - 1.0;
+        }
+
+        std::vector<double> y(rows * width), q, bt(cols * width), ub, vb;
+        std::vector<double> values, left;
+
+        // Each iteration costs about 4 rows * cols * width flops against roughly
+        // 2 rows * cols^2 for the QR that starts the full decomposition
+        size_t iterations = std::max<size_t>(8, cols / width);
+        for(size_t iteration = 0; iteration < iterations; iteration++){
+            // Y = A Z, where Z holds the current right vectors
+            std::fill(y.begin(), y.end(), 0.0);
+            detail::gemm(rows, width, cols, a, stride, z.data(), width, y.data(), width);
+
+            // Since A^T U = V diag(sigma) holds exactly, ||A v_k - sigma_k u_k|| bounds the error of triplet k
+            if(iteration > 0){
+                double residual = 0.0;
+                for(size_t k = 0; k < count; k++){
+                    double sum = 0.0;
+                    for(size_t i = 0; i < rows; i++){
+                        double d = y[i * width + k] - values[k] * left[i * width + k];
+                        sum += d * d;
+                    }
+                    residual = std::max(residual, std::sqrt(sum));
+                }
+                if(residual <= 1e-12 * values[0]){
+                    sigma.assign(values.begin(), values.begin() + count);
+                    u.resize(rows * count);
+                    v.resize(cols * count);
+                    for(size_t i = 0; i < rows; i++)
+                        std::copy(left.begin() + i * width, left.begin() + i * width + count, u.begin() + i * count);
+                    for(size_t i = 0; i < cols; i++)
+                        std::copy(z.begin() + i * width, z.begin() + i * width + count, v.begin() + i * count);
+                    return;
+                }
+            }
+
+            // Q = orth(Y); B^T = A^T Q = U_B diag(sigma) V_B^T, so A ~ Q B = (Q V_B) diag(sigma) U_B^T
+            q = y;
+            orthonormalize(q.data(), rows, width);
+            std::fill(bt.begin(), bt.end(), 0.0);
+            detail::gemm(cols, width, rows, 1.0, a, size_t(1), stride, q.data(), width, size_t(1), bt.data(), width);
+            jacobiSVD(bt.data(), cols, width, values, ub, vb);
+
+            left.assign(rows * width, 0.0);
+            detail::gemm(rows, width, width, q.data(), width, vb.data(), width, left.data(), width);
+            z = ub;
+        }
+
+        // Stalled (nearly equal singular values around count): fall back to the full decomposition
+        std::vector<double> fullU, fullV;
+        jacobiSVD(a, rows, cols, sigma, fullU, fullV);
+        sigma.resize(count);
+        u.resize(rows * count);
+        v.resize(cols * count);
+        for(size_t i = 0; i < rows; i++)
+            std::copy(fullU.begin() + i * cols, fullU.begin() + i * cols + count, u.begin() + i * count);
+        for(size_t i = 0; i < cols; i++)
+            std::copy(fullV.begin() + i * cols, fullV.begin() + i * cols + count, v.begin() + i * count);
+    }
+
+public:
+    // count = 0 computes the full (thin) decomposition with min(m, n) singular values;
+    // a smaller count computes only the leading ones (see above). Throws NonFatalException
+    // if the iteration fails to converge.
+    explicit SVD(ConstMatrixView matrix, size_t count = 0)
+        : m(matrix.rows()), n(matrix.cols()){
+        size_t size = std::min(m, n);
+        if(count == 0 || count > size) count = size;
+
+        // Work on the transpose of wide matrices and swap the factors afterwards
+        bool wide = m < n;
+        Matrix tall(matrix);
+        if(wide) tall.transposeInPlace();
+        size_t rows = std::max(m, n), cols = size;
+
+        std::vector<double>& u = wide ? right : left;
+        std::vector<double>& v = wide ? left : right;
+
+        if(count == size)
+            jacobiSVD(tall.getData(), rows, cols, values, u, v);
+        else
+            subspaceSVD(tall, rows, cols, count, values, u, v);
+    }
+
+    size_t getRows() const { return m; }
+    size_t getCols() const { return n; }
+    size_t getCount() const { return values.size(); }
+
+    // Singular values in descending order
+    const std::vector<double>& getSingularValues() const { return values; }
+
+    // m x count matrix of left singular vectors (columns)
+    Matrix getU() const{
+        Matrix result(values.size(), m);
+        std::copy(left.begin(), left.end(), result.getData());
+        return result;
+    }
+
+    // n x count matrix of right singular vectors (columns)
+    Matrix getV() const{
+        Matrix result(values.size(), n);
+        std::copy(right.begin(), right.end(), result.getData());
+        return result;
+    }
+
+    // Number of singular values above threshold * largest singular value. A truncated
+    // decomposition counts only its `count` values, and its small values are accurate
+    // to about 1e-12 of the largest, so keep the threshold above that.
+    size_t rank(double threshold = 1e-10) const{
+        if(values.empty()) return 0;
+        size_t count = 0;
+        for(double value : values)
+            if(value > threshold * values[0]) count++;
+        return count;
+    }
+};
+
+}
@@ -0,0 +1,640 @@
+#pragma once
+
+#include <cstddef>
+#include <cmath>
+#include <complex>
+#include <type_traits>
+
+// Elementwise and transpose kernels for la::Matrix with runtime CPU dispatch.
+// Each kernel exists as a portable scalar loop and, on x86 with GCC/Clang,
+// as AVX2 and AVX-512 versions compiled with per-function target attributes.
+// The best version the CPU supports is picked once on first use, so the
+// library itself needs no -mavx2/-march flags. Outputs may alias inputs.
+// double and float have vector kernels (4/8 and 8/16 lanes); other element
+// types (complex, integers) use the scalar templates.
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define LA_SIMD_X86 1
+#include <immintrin.h>
+#else
+#define LA_SIMD_X86 0
+#endif
+
+namespace la{
+namespace detail{
+
+enum class SimdLevel{
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+inline const char* toString(SimdLevel level){
+    switch(level){
+        case SimdLevel::Scalar: return "scalar";
+        case SimdLevel::AVX2:   return "AVX2";
+        case SimdLevel::AVX512: return "AVX-512";
+    }
+    return "unknown";
+}
+
+// Function table for one instruction set and element type
+template<class T>
+struct ElementwiseKernels{
+    void (*addVV)(const T* a, const T* b, T* out, size_t n);                    // out = a + b
+    void (*subVV)(const T* a, const T* b, T* out, size_t n);                    // out = a - b
+    void (*addVS)(const T* a, T s, T* out, size_t n);                           // out = a + s
+    void (*subSV)(T s, const T* a, T* out, size_t n);                           // out = s - a
+    void (*mulVS)(const T* a, T s, T* out, size_t n);                           // out = a * s
+    void (*divVS)(const T* a, T s, T* out, size_t n);                           // out = a / s
+    double (*sumSquares)(const T* a, size_t n);                                 // sum of |a[i]|^2, accumulated in double
+    void (*clean)(const T* a, T* out, size_t n, double threshold);              // |a| < threshold -> 0
+    bool (*allClose)(const T* a, const T* b, size_t n, double threshold);       // all |a - b| < threshold
+    void (*transpose)(const T* a, size_t lda, T* out, size_t ldo,
+                      size_t rows, size_t cols);                                // out[j][i] = a[i][j], out must not overlap a
+};
+
+// --- Portable scalar kernels ---
+
+namespace scalar{
+
+template<class T>
+inline double squaredMagnitude(const T& value){ return static_cast<double>(value) * static_cast<double>(value); }
+template<class T>
+inline double squaredMagnitude(const std::complex<T>& value){ return std::norm(std::complex<double>(value)); }
+
+template<class T> inline void addVV(const T* a, const T* b, T* out, size_t n){ for(size_t i=0; i<n; i++) out[i] = a[i] + b[i]; }
+template<class T> inline void subVV(const T* a, const T* b, T* out, size_t n){ for(size_t i=0; i<n; i++) out[i] = a[i] - b[i]; }
+template<class T> inline void addVS(const T* a, T s, T* out, size_t n){ for(size_t i=0; i<n; i++) out[i] = a[i] + s; }
+template<class T> inline void subSV(T s, const T* a, T* out, size_t n){ for(size_t i=0; i<n; i++) out[i] = s - a[i]; }
+template<class T> inline void mulVS(const T* a, T s, T* out, size_t n){ for(size_t i=0; i<n; i++) out[i] = a[i] * s; }
+template<class T> inline void divVS(const T* a, T s, T* out, size_t n){ for(size_t i=0; i<n; i++) out[i] = a[i] / s; }
+
+template<class T>
+inline double sumSquares(const T* a, size_t n){
+    double sum = 0.0;
+    for(size_t i=0; i<n; i++) sum += squaredMagnitude(a[i]);
+    return sum;
+}
+
+template<class T>
+inline void clean(const T* a, T* out, size_t n, double threshold){
+    for(size_t i=0; i<n; i++) out[i] = (std::abs(a[i]) < threshold) ? T(0) : a[i];
+}
+
+template<class T>
+inline bool allClose(const T* a, const T* b, size_t n, double threshold){
+    for(size_t i=0; i<n; i++)
+        if(!(std::abs(a[i] - b[i]) < threshold)) return false;
+    return true;
+}
+
+template<class T>
+inline void transpose(const T* a, size_t lda, T* out, size_t ldo, size_t rows, size_t cols){
+    for(size_t i=0; i<rows; i++)
+        for(size_t j=0; j<cols; j++) out[j * ldo + i] = a[i * lda + j];
+}
+
+} // namespace scalar
+
+#if LA_SIMD_X86
+
+// --- AVX2 kernels (4 doubles per register) ---
+
+namespace avx2{
+
+#define LA_AVX2 __attribute__((target("avx2,fma")))
+
+// out[i] = OP(a[i], b[i]) over full registers, scalar tail
+#define LA_AVX2_BINARY(name, vecOp, op)                                                 \
+LA_AVX2 inline void name(const double* a, const double* b, double* out, size_t n){     \
+    size_t i = 0;                                                                       \
+    for(; i + 4 <= n; i += 4)                                                           \
+        _mm256_storeu_pd(out + i, vecOp(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i))); \
+    for(; i < n; i++) out[i] = a[i] op b[i];                                            \
+}
+
+LA_AVX2_BINARY(addVV, _mm256_add_pd, +)
+LA_AVX2_BINARY(subVV, _mm256_sub_pd, -)
+
+LA_AVX2 inline void addVS(const double* a, double s, double* out, size_t n){
+    __m256d vs = _mm256_set1_pd(s);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_add_pd(_mm256_loadu_pd(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] + s;
+}
+
+LA_AVX2 inline void subSV(double s, const double* a, double* out, size_t n){
+    __m256d vs = _mm256_set1_pd(s);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_sub_pd(vs, _mm256_loadu_pd(a + i)));
+    for(; i < n; i++) out[i] = s - a[i];
+}
+
+LA_AVX2 inline void mulVS(const double* a, double s, double* out, size_t n){
+    __m256d vs = _mm256_set1_pd(s);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_mul_pd(_mm256_loadu_pd(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] * s;
+}
+
+LA_AVX2 inline void divVS(const double* a, double s, double* out, size_t n){
+    __m256d vs = _mm256_set1_pd(s);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4) _mm256_storeu_pd(out + i, _mm256_div_pd(_mm256_loadu_pd(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] / s;
+}
+
+LA_AVX2 inline double sumSquares(const double* a, size_t n){
+    // Two independent accumulators hide FMA latency
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m256d x0 = _mm256_loadu_pd(a + i), x1 = _mm256_loadu_pd(a + i + 4);
+        acc0 = _mm256_fmadd_pd(x0, x0, acc0);
+        acc1 = _mm256_fmadd_pd(x1, x1, acc1);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for(; i < n; i++) sum += a[i] * a[i];
+    return sum;
+}
+
+LA_AVX2 inline void clean(const double* a, double* out, size_t n, double threshold){
+    __m256d vt = _mm256_set1_pd(threshold);
+    __m256d signMask = _mm256_set1_pd(-0.0);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        __m256d x = _mm256_loadu_pd(a + i);
+        __m256d small = _mm256_cmp_pd(_mm256_andnot_pd(signMask, x), vt, _CMP_LT_OQ);
+        _mm256_storeu_pd(out + i, _mm256_andnot_pd(small, x));
+    }
+    for(; i < n; i++) out[i] = (std::abs(a[i]) < threshold) ? 0.0 : a[i];
+}
+
+LA_AVX2 inline bool allClose(const double* a, const double* b, size_t n, double threshold){
+    __m256d vt = _mm256_set1_pd(threshold);
+    __m256d signMask = _mm256_set1_pd(-0.0);
+    size_t i = 0;
+    for(; i + 4 <= n; i += 4){
+        __m256d diff = _mm256_andnot_pd(signMask, _mm256_sub_pd(_mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i)));
+        if(_mm256_movemask_pd(_mm256_cmp_pd(diff, vt, _CMP_LT_OQ)) != 0xF) return false;
+    }
+    for(; i < n; i++)
+        if(!(std::abs(a[i] - b[i]) < threshold)) return false;
+    return true;
+}
+
+// Full 4x4 register blocks, scalar edges
+LA_AVX2 inline void transpose(const double* a, size_t lda, double* out, size_t ldo, size_t rows, size_t cols){
+    size_t i = 0;
+    for(; i + 4 <= rows; i += 4){
+        const double* src = a + i * lda;
+        size_t j = 0;
+        for(; j + 4 <= cols; j += 4){
+            __m256d r0 = _mm256_loadu_pd(src + j);
+            __m256d r1 = _mm256_loadu_pd(src + lda + j);
+            __m256d r2 = _mm256_loadu_pd(src + 2 * lda + j);
+            __m256d r3 = _mm256_loadu_pd(src + 3 * lda + j);
+
+            __m256d t0 = _mm256_unpacklo_pd(r0, r1);        // a00 a10 a02 a12
+            __m256d t1 = _mm256_unpackhi_pd(r0, r1);        // a01 a11 a03 a13
+            __m256d t2 = _mm256_unpacklo_pd(r2, r3);        // a20 a30 a22 a32
+            __m256d t3 = _mm256_unpackhi_pd(r2, r3);        // a21 a31 a23 a33
+
+            double* dst = out + j * ldo + i;
+            _mm256_storeu_pd(dst, _mm256_permute2f128_pd(t0, t2, 0x20));
+            _mm256_storeu_pd(dst + ldo, _mm256_permute2f128_pd(t1, t3, 0x20));
+            _mm256_storeu_pd(dst + 2 * ldo, _mm256_permute2f128_pd(t0, t2, 0x31));
+            _mm256_storeu_pd(dst + 3 * ldo, _mm256_permute2f128_pd(t1, t3, 0x31));
+        }
+        for(size_t r = i; r < i + 4; r++)
+            for(size_t c = j; c < cols; c++) out[c * ldo + r] = a[r * lda + c];
+    }
+    for(; i < rows; i++)
+        for(size_t j = 0; j < cols; j++) out[j * ldo + i] = a[i * lda + j];
+}
+
+// float versions (8 per register); sumSquares widens to double before accumulating
+
+#define LA_AVX2_BINARY_F(name, vecOp, op)                                               \
+LA_AVX2 inline void name(const float* a, const float* b, float* out, size_t n){        \
+    size_t i = 0;                                                                       \
+    for(; i + 8 <= n; i += 8)                                                           \
+        _mm256_storeu_ps(out + i, vecOp(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i))); \
+    for(; i < n; i++) out[i] = a[i] op b[i];                                            \
+}
+
+LA_AVX2_BINARY_F(addVV, _mm256_add_ps, +)
+LA_AVX2_BINARY_F(subVV, _mm256_sub_ps, -)
+
+LA_AVX2 inline void addVS(const float* a, float s, float* out, size_t n){
+    __m256 vs = _mm256_set1_ps(s);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_add_ps(_mm256_loadu_ps(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] + s;
+}
+
+LA_AVX2 inline void subSV(float s, const float* a, float* out, size_t n){
+    __m256 vs = _mm256_set1_ps(s);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_sub_ps(vs, _mm256_loadu_ps(a + i)));
+    for(; i < n; i++) out[i] = s - a[i];
+}
+
+LA_AVX2 inline void mulVS(const float* a, float s, float* out, size_t n){
+    __m256 vs = _mm256_set1_ps(s);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_mul_ps(_mm256_loadu_ps(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] * s;
+}
+
+LA_AVX2 inline void divVS(const float* a, float s, float* out, size_t n){
+    __m256 vs = _mm256_set1_ps(s);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) _mm256_storeu_ps(out + i, _mm256_div_ps(_mm256_loadu_ps(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] / s;
+}
+
+LA_AVX2 inline double sumSquares(const float* a, size_t n){
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m256d x0 = _mm256_cvtps_pd(_mm_loadu_ps(a + i)), x1 = _mm256_cvtps_pd(_mm_loadu_ps(a + i + 4));
+        acc0 = _mm256_fmadd_pd(x0, x0, acc0);
+        acc1 = _mm256_fmadd_pd(x1, x1, acc1);
+    }
+    double lanes[4];
+    _mm256_storeu_pd(lanes, _mm256_add_pd(acc0, acc1));
+    double sum = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for(; i < n; i++) sum += double(a[i]) * a[i];
+    return sum;
+}
+
+LA_AVX2 inline void clean(const float* a, float* out, size_t n, double threshold){
+    __m256 vt = _mm256_set1_ps(float(threshold));
+    __m256 signMask = _mm256_set1_ps(-0.0f);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m256 x = _mm256_loadu_ps(a + i);
+        __m256 small = _mm256_cmp_ps(_mm256_andnot_ps(signMask, x), vt, _CMP_LT_OQ);
+        _mm256_storeu_ps(out + i, _mm256_andnot_ps(small, x));
+    }
+    for(; i < n; i++) out[i] = (std::abs(a[i]) < float(threshold)) ? 0.0f : a[i];
+}
+
+LA_AVX2 inline bool allClose(const float* a, const float* b, size_t n, double threshold){
+    __m256 vt = _mm256_set1_ps(float(threshold));
+    __m256 signMask = _mm256_set1_ps(-0.0f);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m256 diff = _mm256_andnot_ps(signMask, _mm256_sub_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i)));
+        if(_mm256_movemask_ps(_mm256_cmp_ps(diff, vt, _CMP_LT_OQ)) != 0xFF) return false;
+    }
+    for(; i < n; i++)
+        if(!(std::abs(a[i] - b[i]) < float(threshold))) return false;
+    return true;
+}
+
+// Full 8x8 register blocks, scalar edges (also used by the AVX-512 table)
+LA_AVX2 inline void transpose(const float* a, size_t lda, float* out, size_t ldo, size_t rows, size_t cols){
+    size_t i = 0;
+    for(; i + 8 <= rows; i += 8){
+        const float* src = a + i * lda;
+        size_t j = 0;
+        for(; j + 8 <= cols; j += 8){
+            __m256 r[8], t[8], u[8];
+            for(int k = 0; k < 8; k++) r[k] = _mm256_loadu_ps(src + k * lda + j);
+
+            // Interleave row pairs, then pick 64-bit halves: u[4h + c] holds column pairs of rows 4h .. 4h + 3
+            for(int k = 0; k < 4; k++){
+                t[2 * k] = _mm256_unpacklo_ps(r[2 * k], r[2 * k + 1]);
+                t[2 * k + 1] = _mm256_unpackhi_ps(r[2 * k], r[2 * k + 1]);
+            }
+            for(int h = 0; h < 2; h++){
+                u[4 * h + 0] = _mm256_shuffle_ps(t[4 * h + 0], t[4 * h + 2], _MM_SHUFFLE(1, 0, 1, 0));
+                u[4 * h + 1] = _mm256_shuffle_ps(t[4 * h + 0], t[4 * h + 2], _MM_SHUFFLE(3, 2, 3, 2));
+                u[4 * h + 2] = _mm256_shuffle_ps(t[4 * h + 1], t[4 * h + 3], _MM_SHUFFLE(1, 0, 1, 0));
+                u[4 * h + 3] = _mm256_shuffle_ps(t[4 * h + 1], t[4 * h + 3], _MM_SHUFFLE(3, 2, 3, 2));
+            }
+
+            float* dst = out + j * ldo + i;
+            for(int k = 0; k < 4; k++){
+                _mm256_storeu_ps(dst + k * ldo, _mm256_permute2f128_ps(u[k], u[k + 4], 0x20));
+                _mm256_storeu_ps(dst + (k + 4) * ldo, _mm256_permute2f128_ps(u[k], u[k + 4], 0x31));
+            }
+        }
+        for(size_t r = i; r < i + 8; r++)
+            for(size_t c = j; c < cols; c++) out[c * ldo + r] = a[r * lda + c];
+    }
+    for(; i < rows; i++)
+        for(size_t j = 0; j < cols; j++) out[j * ldo + i] = a[i * lda + j];
+}
+
+#undef LA_AVX2_BINARY_F
+#undef LA_AVX2_BINARY
+#undef LA_AVX2
+
+} // namespace avx2
+
+// --- AVX-512 kernels (8 doubles per register) ---
+
+namespace avx512{
+
+#define LA_AVX512 __attribute__((target("avx512f")))
+
+#define LA_AVX512_BINARY(name, vecOp, op)                                               \
+LA_AVX512 inline void name(const double* a, const double* b, double* out, size_t n){   \
+    size_t i = 0;                                                                       \
+    for(; i + 8 <= n; i += 8)                                                           \
+        _mm512_storeu_pd(out + i, vecOp(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i))); \
+    for(; i < n; i++) out[i] = a[i] op b[i];                                            \
+}
+
+LA_AVX512_BINARY(addVV, _mm512_add_pd, +)
+LA_AVX512_BINARY(subVV, _mm512_sub_pd, -)
+
+LA_AVX512 inline void addVS(const double* a, double s, double* out, size_t n){
+    __m512d vs = _mm512_set1_pd(s);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) _mm512_storeu_pd(out + i, _mm512_add_pd(_mm512_loadu_pd(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] + s;
+}
+
+LA_AVX512 inline void subSV(double s, const double* a, double* out, size_t n){
+    __m512d vs = _mm512_set1_pd(s);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) _mm512_storeu_pd(out + i, _mm512_sub_pd(vs, _mm512_loadu_pd(a + i)));
+    for(; i < n; i++) out[i] = s - a[i];
+}
+
+LA_AVX512 inline void mulVS(const double* a, double s, double* out, size_t n){
+    __m512d vs = _mm512_set1_pd(s);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) _mm512_storeu_pd(out + i, _mm512_mul_pd(_mm512_loadu_pd(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] * s;
+}
+
+LA_AVX512 inline void divVS(const double* a, double s, double* out, size_t n){
+    __m512d vs = _mm512_set1_pd(s);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8) _mm512_storeu_pd(out + i, _mm512_div_pd(_mm512_loadu_pd(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] / s;
+}
+
+LA_AVX512 inline double sumSquares(const double* a, size_t n){
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16){
+        __m512d x0 = _mm512_loadu_pd(a + i), x1 = _mm512_loadu_pd(a + i + 8);
+        acc0 = _mm512_fmadd_pd(x0, x0, acc0);
+        acc1 = _mm512_fmadd_pd(x1, x1, acc1);
+    }
+    double lanes[8];
+    _mm512_storeu_pd(lanes, _mm512_add_pd(acc0, acc1));
+    double sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    for(; i < n; i++) sum += a[i] * a[i];
+    return sum;
+}
+
+LA_AVX512 inline void clean(const double* a, double* out, size_t n, double threshold){
+    __m512d vt = _mm512_set1_pd(threshold);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m512d x = _mm512_loadu_pd(a + i);
+        __mmask8 keep = _mm512_cmp_pd_mask(_mm512_abs_pd(x), vt, _CMP_NLT_UQ);
+        _mm512_storeu_pd(out + i, _mm512_maskz_mov_pd(keep, x));
+    }
+    for(; i < n; i++) out[i] = (std::abs(a[i]) < threshold) ? 0.0 : a[i];
+}
+
+LA_AVX512 inline bool allClose(const double* a, const double* b, size_t n, double threshold){
+    __m512d vt = _mm512_set1_pd(threshold);
+    size_t i = 0;
+    for(; i + 8 <= n; i += 8){
+        __m512d diff = _mm512_abs_pd(_mm512_sub_pd(_mm512_loadu_pd(a + i), _mm512_loadu_pd(b + i)));
+        if(_mm512_cmp_pd_mask(diff, vt, _CMP_LT_OQ) != 0xFF) return false;
+    }
+    for(; i < n; i++)
+        if(!(std::abs(a[i] - b[i]) < threshold)) return false;
+    return true;
+}
+
+// GCC 12 reports _mm512_undefined_pd() inside the unpack/shuffle intrinsics as
+// uninitialized (GCC bug 105593, fixed in GCC 13); the value is never read.
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+// Full 8x8 register blocks, scalar edges
+LA_AVX512 inline void transpose(const double* a, size_t lda, double* out, size_t ldo, size_t rows, size_t cols){
+    size_t i = 0;
+    for(; i + 8 <= rows; i += 8){
+        const double* src = a + i * lda;
+        size_t j = 0;
+        for(; j + 8 <= cols; j += 8){
+            __m512d r[8], t[8], u[8];
+            for(int k = 0; k < 8; k++) r[k] = _mm512_loadu_pd(src + k * lda + j);
+
+            // Interleave row pairs: t[2k] holds even columns, t[2k+1] odd columns of rows 2k, 2k+1
+            for(int k = 0; k < 4; k++){
+                t[2 * k] = _mm512_unpacklo_pd(r[2 * k], r[2 * k + 1]);
+                t[2 * k + 1] = _mm512_unpackhi_pd(r[2 * k], r[2 * k + 1]);
+            }
+            // Gather 128-bit lanes: u[k] / u[k + 4] hold columns (k, k + 4) of rows 0-3 / 4-7
+            for(int h = 0; h < 2; h++){
+                u[4 * h + 0] = _mm512_shuffle_f64x2(t[4 * h + 0], t[4 * h + 2], 0x88);
+                u[4 * h + 1] = _mm512_shuffle_f64x2(t[4 * h + 1], t[4 * h + 3], 0x88);
+                u[4 * h + 2] = _mm512_shuffle_f64x2(t[4 * h + 0], t[4 * h + 2], 0xDD);
+                u[4 * h + 3] = _mm512_shuffle_f64x2(t[4 * h + 1], t[4 * h + 3], 0xDD);
+            }
+
+            double* dst = out + j * ldo + i;
+            for(int k = 0; k < 4; k++){
+                _mm512_storeu_pd(dst + k * ldo, _mm512_shuffle_f64x2(u[k], u[k + 4], 0x88));
+                _mm512_storeu_pd(dst + (k + 4) * ldo, _mm512_shuffle_f64x2(u[k], u[k + 4], 0xDD));
+            }
+        }
+        for(size_t r = i; r < i + 8; r++)
+            for(size_t c = j; c < cols; c++) out[c * ldo + r] = a[r * lda + c];
+    }
+    for(; i < rows; i++)
+        for(size_t j = 0; j < cols; j++) out[j * ldo + i] = a[i * lda + j];
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+// float versions (16 per register)
+
+#define LA_AVX512_BINARY_F(name, vecOp, op)                                             \
+LA_AVX512 inline void name(const float* a, const float* b, float* out, size_t n){      \
+    size_t i = 0;                                                                       \
+    for(; i + 16 <= n; i += 16)                                                         \
+        _mm512_storeu_ps(out + i, vecOp(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i))); \
+    for(; i < n; i++) out[i] = a[i] op b[i];                                            \
+}
+
+LA_AVX512_BINARY_F(addVV, _mm512_add_ps, +)
+LA_AVX512_BINARY_F(subVV, _mm512_sub_ps, -)
+
+LA_AVX512 inline void addVS(const float* a, float s, float* out, size_t n){
+    __m512 vs = _mm512_set1_ps(s);
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, _mm512_add_ps(_mm512_loadu_ps(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] + s;
+}
+
+LA_AVX512 inline void subSV(float s, const float* a, float* out, size_t n){
+    __m512 vs = _mm512_set1_ps(s);
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, _mm512_sub_ps(vs, _mm512_loadu_ps(a + i)));
+    for(; i < n; i++) out[i] = s - a[i];
+}
+
+LA_AVX512 inline void mulVS(const float* a, float s, float* out, size_t n){
+    __m512 vs = _mm512_set1_ps(s);
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, _mm512_mul_ps(_mm512_loadu_ps(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] * s;
+}
+
+LA_AVX512 inline void divVS(const float* a, float s, float* out, size_t n){
+    __m512 vs = _mm512_set1_ps(s);
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16) _mm512_storeu_ps(out + i, _mm512_div_ps(_mm512_loadu_ps(a + i), vs));
+    for(; i < n; i++) out[i] = a[i] / s;
+}
+
+// _mm512_cvtps_pd() hits the same GCC 12 false positive as the transpose above
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+LA_AVX512 inline double sumSquares(const float* a, size_t n){
+    __m512d acc0 = _mm512_setzero_pd(), acc1 = _mm512_setzero_pd();
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16){
+        __m512d x0 = _mm512_cvtps_pd(_mm256_loadu_ps(a + i)), x1 = _mm512_cvtps_pd(_mm256_loadu_ps(a + i + 8));
+        acc0 = _mm512_fmadd_pd(x0, x0, acc0);
+        acc1 = _mm512_fmadd_pd(x1, x1, acc1);
+    }
+    double lanes[8];
+    _mm512_storeu_pd(lanes, _mm512_add_pd(acc0, acc1));
+    double sum = ((lanes[0] + lanes[1]) + (lanes[2] + lanes[3])) + ((lanes[4] + lanes[5]) + (lanes[6] + lanes[7]));
+    for(; i < n; i++) sum += double(a[i]) * a[i];
+    return sum;
+}
+
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC diagnostic pop
+#endif
+
+LA_AVX512 inline void clean(const float* a, float* out, size_t n, double threshold){
+    __m512 vt = _mm512_set1_ps(float(threshold));
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16){
+        __m512 x = _mm512_loadu_ps(a + i);
+        __mmask16 keep = _mm512_cmp_ps_mask(_mm512_abs_ps(x), vt, _CMP_NLT_UQ);
+        _mm512_storeu_ps(out + i, _mm512_maskz_mov_ps(keep, x));
+    }
+    for(; i < n; i++) out[i] = (std::abs(a[i]) < float(threshold)) ? 0.0f : a[i];
+}
+
+LA_AVX512 inline bool allClose(const float* a, const float* b, size_t n, double threshold){
+    __m512 vt = _mm512_set1_ps(float(threshold));
+    size_t i = 0;
+    for(; i + 16 <= n; i += 16){
+        __m512 diff = _mm512_abs_ps(_mm512_sub_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i)));
+        if(_mm512_cmp_ps_mask(diff, vt, _CMP_LT_OQ) != 0xFFFF) return false;
+    }
+    for(; i < n; i++)
+        if(!(std::abs(a[i] - b[i]) < float(threshold))) return false;
+    return true;
+}
+
+// The AVX2 8x8 float blocks already keep the transpose memory-bound
+inline void transpose(const float* a, size_t lda, float* out, size_t ldo, size_t rows, size_t cols){
+    avx2::transpose(a, lda, out, ldo, rows, cols);
+}
+
+#undef LA_AVX512_BINARY_F
+#undef LA_AVX512_BINARY
+#undef LA_AVX512
+
+} // namespace avx512
+
+#endif // LA_SIMD_X86
+
+// --- Dispatch ---
+
+// Best instruction set supported by the running CPU
+inline SimdLevel detectSimdLevel(){
+#if LA_SIMD_X86
+    __builtin_cpu_init();
+    if(__builtin_cpu_supports("avx512f")) return SimdLevel::AVX512;
+    if(__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return SimdLevel::AVX2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+template<class T>
+inline ElementwiseKernels<T> kernelsFor(SimdLevel level){
+#if LA_SIMD_X86
+    if constexpr(std::is_same<T, double>::value || std::is_same<T, float>::value){
+        if(level == SimdLevel::AVX512)
+            return {avx512::addVV, avx512::subVV, avx512::addVS, avx512::subSV, avx512::mulVS,
+                    avx512::divVS, avx512::sumSquares, avx512::clean, avx512::allClose, avx512::transpose};
+        if(level == SimdLevel::AVX2)
+            return {avx2::addVV, avx2::subVV, avx2::addVS, avx2::subSV, avx2::mulVS,
+                    avx2::divVS, avx2::sumSquares, avx2::clean, avx2::allClose, avx2::transpose};
+    }
+#endif
+    (void)level;
+    return {scalar::addVV<T>, scalar::subVV<T>, scalar::addVS<T>, scalar::subSV<T>, scalar::mulVS<T>,
+            scalar::divVS<T>, scalar::sumSquares<T>, scalar::clean<T>, scalar::allClose<T>, scalar::transpose<T>};
+}
+
+struct SimdState{
+    SimdLevel level;
+    ElementwiseKernels<double> kernels;
+    ElementwiseKernels<float> floatKernels;
+};
+
+inline SimdState& simdState(){
+    static SimdState state{detectSimdLevel(), kernelsFor<double>(detectSimdLevel()), kernelsFor<float>(detectSimdLevel())};
+    return state;
+}
+
+// Kernels used by la::BasicMatrix<T>; element types without vector kernels get the scalar table
+template<class T = double>
+inline const ElementwiseKernels<T>& simd(){
+    if constexpr(std::is_same<T, double>::value){
+        return simdState().kernels;
+    }else if constexpr(std::is_same<T, float>::value){
+        return simdState().floatKernels;
+    }else{
+        static const ElementwiseKernels<T> kernels = kernelsFor<T>(SimdLevel::Scalar);
+        return kernels;
+    }
+}
+
+inline SimdLevel getSimdLevel(){
+    return simdState().level;
+}
+
+// Force a lower instruction set (e.g. for benchmarking); requests above what
+// the CPU supports are clamped to the detected level. Not thread-safe.
+inline SimdLevel setSimdLevel(SimdLevel level){
+    SimdLevel supported = detectSimdLevel();
+    if(static_cast<int>(level) > static_cast<int>(supported)) level = supported;
+    simdState() = SimdState{level, kernelsFor<double>(level), kernelsFor<float>(level)};
+    return level;
+}
+
+} // namespace detail
+} // namespace la
@@ -0,0 +1,116 @@
+#pragma once
+
+// Linear system solvers: X = solve(A, B) without forming A^-1.
+// Included by Matrix.hpp after the factorization headers; use it through Matrix.hpp.
+//
+// SolveMethod::Auto picks
+//   - Cholesky for square symmetric matrices with a positive diagonal (falling
+//     back to LU if the factorization shows A is not positive definite),
+//   - LU with partial pivoting for other square matrices,
+//   - Householder QR (least squares) when A has more rows than columns.
+
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace la{
+
+enum class SolveMethod{
+    Auto,
+    LU,
+    Cholesky,
+    QR
+};
+
+namespace detail{
+
+inline bool looksSymmetricPositive(const double* a, size_t n, size_t lda){
+    for(size_t i = 0; i < n; i++){
+        if(!(a[i * lda + i] > 0.0)) return false;
+        for(size_t j = 0; j < i; j++){
+            double upper = a[j * lda + i], lower = a[i * lda + j];
+            if(std::abs(upper - lower) > 1e-10 * (1.0 + std::max(std::abs(upper), std::abs(lower))))
+                return false;
+        }
+    }
+    return true;
+}
+
+// Solve A X = B with A (rows x cols, leading dimension lda) and B (rows x numRhs, leading
+// dimension ldb) given as row-major buffers. A is overwritten by its factorization; X
+// replaces the first cols rows of B.
+inline void solveBuffers(double* a, size_t rows, size_t cols, size_t lda, double* b, size_t ldb, size_t numRhs, SolveMethod method){
+    if(rows < cols)
+        throw error::NonFatalException("Unable to solve system, more unknowns than equations.");
+    if(rows != cols && method != SolveMethod::Auto && method != SolveMethod::QR)
+        throw error::NonFatalException("Only QR can solve a system with more equations than unknowns.");
+
+    if(method == SolveMethod::Auto)
+        method = (rows != cols) ? SolveMethod::QR
+               : looksSymmetricPositive(a, cols, lda) ? SolveMethod::Cholesky
+               : SolveMethod::LU;
+
+    size_t n = cols;
+
+    if(method == SolveMethod::Cholesky){
+        // choleskyFactor overwrites the diagonal and lower triangle only; keep the
+        // diagonal so A can be restored from its upper triangle for the LU fallback
+        ScratchVector<double> diagonal(n);
+        for(size_t i = 0; i < n; i++) diagonal[i] = a[i * lda + i];
+
+        if(choleskyFactor(a, n, lda)){
+            choleskySolve(a, n, lda, b, ldb, numRhs);
+            return;
+        }
+        for(size_t i = 0; i < n; i++){
+            a[i * lda + i] = diagonal[i];
+            for(size_t j = 0; j < i; j++) a[i * lda + j] = a[j * lda + i];
+        }
+        method = SolveMethod::LU;
+    }
+
+    if(method == SolveMethod::LU){
+        ScratchVector<size_t> pivots(n);
+        int pivotSign;
+        if(!luFactor(a, n, lda, pivots.data(), pivotSign, 1e-10))
+            throw error::NonFatalException("Matrix is singular, cannot solve system.");
+        luSolve(a, n, lda, pivots.data(), b, ldb, numRhs);
+        return;
+    }
+
+    ScratchVector<double> tau(n);
+    qrFactor(a, rows, n, lda, tau.data());
+    if(!qrFullRank(a, n, lda, 1e-10))
+        throw error::NonFatalException("Matrix is rank deficient, cannot solve least-squares system.");
+    qrSolve(a, rows, n, lda, tau.data(), b, ldb, numRhs);
+}
+
+} // namespace detail
+
+// X = A^-1 B (or the least-squares solution when A has more rows than columns)
+inline Matrix solve(ConstMatrixView A, ConstMatrixView B, SolveMethod method = SolveMethod::Auto){
+    size_t rows = A.rows(), cols = A.cols(), numRhs = B.cols();
+    if(B.rows() != rows)
+        throw error::NonFatalException("Unable to solve system, mismatching dimensions.");
+
+    detail::ScratchVector<double> factors(rows * cols), work(rows * numRhs);
+    A.copyTo(factors.data(), cols);
+    B.copyTo(work.data(), numRhs);
+    detail::solveBuffers(factors.data(), rows, cols, cols, work.data(), numRhs, numRhs, method);
+
+    Matrix solution(numRhs, cols);
+    std::copy(work.begin(), work.begin() + cols * numRhs, solution.getData());
+    return solution;
+}
+
+// In-place variant on the caller's storage: A is overwritten by its factorization
+// and B by the solution. For least squares (more rows than columns) the solution
+// fills the first A.cols() rows of B, as in LAPACK's gels.
+inline void solveInPlace(MatrixView A, MatrixView B, SolveMethod method = SolveMethod::Auto){
+    if(B.rows() != A.rows())
+        throw error::NonFatalException("Unable to solve system, mismatching dimensions.");
+
+    detail::solveBuffers(A.getData(), A.rows(), A.cols(), A.getStride(), B.getData(), B.getStride(), B.cols(), method);
+}
+
+}
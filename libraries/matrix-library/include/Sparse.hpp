@@ -0,0 +1,497 @@
+#pragma once
+
+// Sparse matrices in compressed row (CSR) and compressed column (CSC) form,
+// built from coordinate (COO) triplets or from a dense matrix.
+// Included by Matrix.hpp after the Matrix class; use it through Matrix.hpp.
+//
+// Only the nonzeros are stored: one double and one 32-bit index each, plus
+// one offset per row (CSR) or column (CSC), so a 1M x 1M graph with 10M edges
+// takes about 128 MB. CSR is the format for A x: each output row gathers its
+// own nonzeros, so rows are split across the thread pool. CSC gathers for
+// A^T x instead; the scattering direction of either format runs on the
+// calling thread (or over bands of right-hand-side columns for products with
+// a dense matrix). transpose() and the CSR <-> CSC conversions are one
+// counting sort, O(nonzeros + rows + columns).
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+namespace la{
+
+using SparseIndex = uint32_t;       // row/column index of a stored element
+
+class CSRMatrix;
+class CSCMatrix;
+
+namespace detail{
+
+// Compressed storage shared by CSR (major = row) and CSC (major = column):
+// the nonzeros of major line i are index/values[start[i], start[i + 1]), sorted by index
+struct CompressedStorage{
+    std::vector<size_t> start;
+    std::vector<SparseIndex> index;
+    std::vector<double> values;
+};
+
+inline void checkSparseShape(size_t rows, size_t cols){
+    if(rows < 1 || cols < 1)
+        throw error::FatalException("Matrix dimensions must be greater than 0");
+    if(rows > std::numeric_limits<SparseIndex>::max() || cols > std::numeric_limits<SparseIndex>::max())
+        throw error::FatalException("Sparse matrix dimensions must fit in 32-bit indices.");
+}
+
+// Throws FatalException unless the triplet arrays have equal lengths and every entry lies inside rows x cols
+inline void checkTriplets(size_t rows, size_t cols, const std::vector<SparseIndex>& rowIndex,
+                          const std::vector<SparseIndex>& colIndex, const std::vector<double>& values){
+    checkSparseShape(rows, cols);
+    if(rowIndex.size() != values.size() || colIndex.size() != values.size())
+        throw error::FatalException("Sparse triplet arrays must have the same length.");
+    for(size_t p = 0; p < values.size(); p++)
+        if(rowIndex[p] >= rows || colIndex[p] >= cols)
+            throw error::FatalException("Sparse matrix entry out of range.");
+}
+
+// Throws FatalException unless the offsets are monotonic and every line's indices are in range and increasing
+inline void validateCompressed(const CompressedStorage& storage, size_t numMajor, size_t numMinor){
+    const std::vector<size_t>& start = storage.start;
+    if(start.size() != numMajor + 1 || start[0] != 0 || start.back() != storage.index.size()
+       || storage.index.size() != storage.values.size())
+        throw error::FatalException("Invalid compressed sparse structure.");
+
+    for(size_t i = 0; i < numMajor; i++){
+        if(start[i + 1] < start[i])
+            throw error::FatalException("Invalid compressed sparse structure.");
+        for(size_t p = start[i]; p < start[i + 1]; p++)
+            if(storage.index[p] >= numMinor || (p > start[i] && storage.index[p] <= storage.index[p - 1]))
+                throw error::FatalException("Invalid compressed sparse structure.");
+    }
+}
+
+// Triplets -> compressed form: bucket by major index, sort each line by minor index, sum duplicates
+inline CompressedStorage compressTriplets(size_t numMajor, const std::vector<SparseIndex>& major,
+                                          const std::vector<SparseIndex>& minor, const std::vector<double>& values){
+    CompressedStorage storage;
+    storage.start.assign(numMajor + 1, 0);
+    for(SparseIndex m : major) storage.start[m + 1]++;
+    for(size_t i = 0; i < numMajor; i++) storage.start[i + 1] += storage.start[i];
+
+    storage.index.resize(values.size());
+    storage.values.resize(values.size());
+    std::vector<size_t> next(storage.start.begin(), storage.start.end() - 1);
+    for(size_t p = 0; p < values.size(); p++){
+        size_t slot = next[major[p]]++;
+        storage.index[slot] = minor[p];
+        storage.values[slot] = values[p];
+    }
+
+    // Lines are independent; each band sorts its own lines through one reused buffer
+    size_t perLine = std::max<size_t>(1, values.size() / numMajor);
+    forEachBand(0, numMajor, perLine * 8, [&](size_t low, size_t high){
+        std::vector<std::pair<SparseIndex, double>> line;
+        for(size_t i = low; i < high; i++){
+            size_t begin = storage.start[i], end = storage.start[i + 1];
+            if(end - begin < 2) continue;
+
+            line.clear();
+            for(size_t p = begin; p < end; p++) line.emplace_back(storage.index[p], storage.values[p]);
+            std::stable_sort(line.begin(), line.end(), [](const auto& a, const auto& b){ return a.first < b.first; });
+            for(size_t p = begin; p < end; p++){
+                storage.index[p] = line[p - begin].first;
+                storage.values[p] = line[p - begin].second;
+            }
+        }
+    });
+
+    // Merge duplicates, compacting the arrays in place
+    size_t out = 0;
+    for(size_t i = 0; i < numMajor; i++){
+        size_t begin = storage.start[i], end = storage.start[i + 1];
+        storage.start[i] = out;
+        for(size_t p = begin; p < end; p++){
+            if(out > storage.start[i] && storage.index[out - 1] == storage.index[p])
+                storage.values[out - 1] += storage.values[p];
+            else{
+                storage.index[out] = storage.index[p];
+                storage.values[out] = storage.values[p];
+                out++;
+            }
+        }
+    }
+    storage.start[numMajor] = out;
+    storage.index.resize(out);
+    storage.values.resize(out);
+    storage.index.shrink_to_fit();
+    storage.values.shrink_to_fit();
+    return storage;
+}
+
+// Same nonzeros with the roles of major and minor swapped (CSR of A -> CSR of A^T = CSC of A).
+// Walking the old lines in order leaves every new line sorted.
+inline CompressedStorage transposeCompressed(const CompressedStorage& storage, size_t numMajor, size_t numMinor){
+    CompressedStorage result;
+    result.start.assign(numMinor + 1, 0);
+    for(SparseIndex m : storage.index) result.start[m + 1]++;
+    for(size_t j = 0; j < numMinor; j++) result.start[j + 1] += result.start[j];
+
+    result.index.resize(storage.index.size());
+    result.values.resize(storage.values.size());
+    std::vector<size_t> next(result.start.begin(), result.start.end() - 1);
+    for(size_t i = 0; i < numMajor; i++)
+        for(size_t p = storage.start[i]; p < storage.start[i + 1]; p++){
+            size_t slot = next[storage.index[p]]++;
+            result.index[slot] = static_cast<SparseIndex>(i);
+            result.values[slot] = storage.values[p];
+        }
+    return result;
+}
+
+// Nonzeros of a dense matrix with |value| > threshold, row by row
+inline CompressedStorage compressDense(ConstMatrixView dense, double threshold){
+    CompressedStorage storage;
+    storage.start.assign(dense.rows() + 1, 0);
+    for(size_t i = 0; i < dense.rows(); i++){
+        for(size_t j = 0; j < dense.cols(); j++)
+            if(std::abs(dense(i, j)) > threshold){
+                storage.index.push_back(static_cast<SparseIndex>(j));
+                storage.values.push_back(dense(i, j));
+            }
+        storage.start[i + 1] = storage.index.size();
+    }
+    return storage;
+}
+
+inline size_t averagePerLine(const CompressedStorage& storage){
+    size_t lines = storage.start.size() - 1;
+    return std::max<size_t>(1, storage.index.size() / std::max<size_t>(lines, 1));
+}
+
+// y (numMajor x p) = S x, where line i of S holds the nonzeros of output row i
+// (CSR times a dense matrix, or CSC transposed). Output rows are independent.
+inline void gatherProduct(const CompressedStorage& storage, size_t numMajor,
+                          const double* x, size_t ldx, double* y, size_t ldy, size_t p){
+    forEachBand(0, numMajor, averagePerLine(storage) * p, [&](size_t low, size_t high){
+        for(size_t i = low; i < high; i++){
+            double* out = y + i * ldy;
+            if(p == 1){
+                double sum = 0.0;
+                for(size_t q = storage.start[i]; q < storage.start[i + 1]; q++)
+                    sum += storage.values[q] * x[storage.index[q] * ldx];
+                out[0] = sum;
+                continue;
+            }
+
+            std::fill(out, out + p, 0.0);
+            for(size_t q = storage.start[i]; q < storage.start[i + 1]; q++){
+                double value = storage.values[q];
+                const double* row = x + storage.index[q] * ldx;
+                for(size_t c = 0; c < p; c++) out[c] += value * row[c];
+            }
+        }
+    });
+}
+
+// y (numMinor x p) = S^T x, where line i of S scatters into the output rows it indexes
+// (CSC times a dense matrix, or CSR transposed). Bands of right-hand-side columns are independent.
+inline void scatterProduct(const CompressedStorage& storage, size_t numMajor, size_t numMinor,
+                           const double* x, size_t ldx, double* y, size_t ldy, size_t p){
+    for(size_t r = 0; r < numMinor; r++) std::fill(y + r * ldy, y + r * ldy + p, 0.0);
+
+    forEachBand(0, p, storage.index.size(), [&](size_t low, size_t high){
+        for(size_t i = 0; i < numMajor; i++){
+            const double* in = x + i * ldx;
+            for(size_t q = storage.start[i]; q < storage.start[i + 1]; q++){
+                double value = storage.values[q];
+                double* out = y + storage.index[q] * ldy;
+                for(size_t c = low; c < high; c++) out[c] += value * in[c];
+            }
+        }
+    });
+}
+
+} // namespace detail
+
+// Coordinate-format builder: collect (row, col, value) triplets in any order,
+// then compress. Duplicate entries are summed.
+class COOMatrix{
+private:
+    size_t numRows, numCols;
+    std::vector<SparseIndex> rowIndex, colIndex;
+    std::vector<double> values;
+
+public:
+    COOMatrix(size_t rows, size_t cols) : numRows(rows), numCols(cols){
+        detail::checkSparseShape(rows, cols);
+    }
+
+    void reserve(size_t nonZeros){
+        rowIndex.reserve(nonZeros);
+        colIndex.reserve(nonZeros);
+        values.reserve(nonZeros);
+    }
+
+    void add(size_t row, size_t col, double value){
+        if(row >= numRows || col >= numCols)
+            throw error::FatalException("Sparse matrix entry out of range.");
+        rowIndex.push_back(static_cast<SparseIndex>(row));
+        colIndex.push_back(static_cast<SparseIndex>(col));
+        values.push_back(value);
+    }
+
+    size_t rows() const { return numRows; }
+    size_t cols() const { return numCols; }
+    size_t nonZeros() const { return values.size(); }      // before duplicates are merged
+
+    CSRMatrix toCSR() const;
+    CSCMatrix toCSC() const;
+};
+
+class CSRMatrix{
+private:
+    size_t numRows, numCols;
+    detail::CompressedStorage storage;
+
+    friend class CSCMatrix;
+
+    CSRMatrix(size_t rows, size_t cols, detail::CompressedStorage storage)
+        : numRows(rows), numCols(cols), storage(std::move(storage)) {}
+
+public:
+    // All zeros
+    CSRMatrix(size_t rows, size_t cols) : numRows(rows), numCols(cols){
+        detail::checkSparseShape(rows, cols);
+        storage.start.assign(rows + 1, 0);
+    }
+
+    // From raw CSR arrays; throws FatalException unless they describe a valid rows x cols matrix
+    CSRMatrix(size_t rows, size_t cols, std::vector<size_t> rowStart,
+              std::vector<SparseIndex> colIndex, std::vector<double> values)
+        : numRows(rows), numCols(cols){
+        detail::checkSparseShape(rows, cols);
+        storage = {std::move(rowStart), std::move(colIndex), std::move(values)};
+        detail::validateCompressed(storage, rows, cols);
+    }
+
+    // Elements of a dense matrix with |value| > threshold
+    explicit CSRMatrix(ConstMatrixView dense, double threshold = 0.0)
+        : numRows(dense.rows()), numCols(dense.cols()){
+        detail::checkSparseShape(numRows, numCols);
+        storage = detail::compressDense(dense, threshold);
+    }
+
+    // Triplets in any order, duplicates summed; throws FatalException for mismatched lengths or out-of-range indices
+    static CSRMatrix fromTriplets(size_t rows, size_t cols, const std::vector<SparseIndex>& rowIndex,
+                                  const std::vector<SparseIndex>& colIndex, const std::vector<double>& values){
+        detail::checkTriplets(rows, cols, rowIndex, colIndex, values);
+        return CSRMatrix(rows, cols, detail::compressTriplets(rows, rowIndex, colIndex, values));
+    }
+
+    size_t rows() const { return numRows; }
+    size_t cols() const { return numCols; }
+    size_t nonZeros() const { return storage.values.size(); }
+    size_t memoryBytes() const {
+        return storage.start.size() * sizeof(size_t) + storage.index.size() * sizeof(SparseIndex)
+             + storage.values.size() * sizeof(double);
+    }
+
+    const std::vector<size_t>& getRowStart() const { return storage.start; }
+    const std::vector<SparseIndex>& getColIndex() const { return storage.index; }
+    const std::vector<double>& getValues() const { return storage.values; }
+
+    // Element lookup (binary search within the row); 0 for entries that are not stored
+    double operator()(size_t row, size_t col) const{
+        auto begin = storage.index.begin() + storage.start[row], end = storage.index.begin() + storage.start[row + 1];
+        auto found = std::lower_bound(begin, end, static_cast<SparseIndex>(col));
+        return (found != end && *found == col) ? storage.values[found - storage.index.begin()] : 0.0;
+    }
+
+    Matrix toDense() const{
+        Matrix dense(numCols, numRows);
+        double* out = dense.getData();
+        for(size_t i = 0; i < numRows; i++)
+            for(size_t p = storage.start[i]; p < storage.start[i + 1]; p++)
+                out[i * numCols + storage.index[p]] = storage.values[p];
+        return dense;
+    }
+
+    CSRMatrix transpose() const{
+        return CSRMatrix(numCols, numRows, detail::transposeCompressed(storage, numRows, numCols));
+    }
+
+    CSCMatrix toCSC() const;
+
+    // y = A x for raw vectors (x has cols() elements, y has rows()); rows run in parallel
+    void multiply(const double* x, double* y) const{
+        detail::gatherProduct(storage, numRows, x, 1, y, 1, 1);
+    }
+
+    // y = A^T x (x has rows() elements, y has cols())
+    void multiplyTransposed(const double* x, double* y) const{
+        detail::scatterProduct(storage, numRows, numCols, x, 1, y, 1, 1);
+    }
+
+    // A B for a dense B with rows() == B.rows(); a single column is SpMV
+    Matrix multiply(ConstMatrixView dense) const{
+        if(dense.rows() != numCols)
+            throw error::NonFatalException("Unable to multiply matrices, mismatching dimensions");
+        Matrix result(dense.cols(), numRows);
+        detail::gatherProduct(storage, numRows, dense.getData(), dense.getStride(), result.getData(), dense.cols(), dense.cols());
+        return result;
+    }
+
+    // B A for a dense B: row i of the result accumulates B(i, k) times row k of A
+    Matrix multiplyLeft(ConstMatrixView dense) const{
+        if(dense.cols() != numRows)
+            throw error::NonFatalException("Unable to multiply matrices, mismatching dimensions");
+        Matrix result(numCols, dense.rows());
+        double* out = result.getData();
+        detail::forEachBand(0, dense.rows(), nonZeros(), [&](size_t low, size_t high){
+            for(size_t i = low; i < high; i++)
+                for(size_t k = 0; k < numRows; k++){
+                    double scale = dense(i, k);
+                    if(scale == 0.0) continue;
+                    for(size_t p = storage.start[k]; p < storage.start[k + 1]; p++)
+                        out[i * numCols + storage.index[p]] += scale * storage.values[p];
+                }
+        });
+        return result;
+    }
+};
+
+class CSCMatrix{
+private:
+    size_t numRows, numCols;
+    detail::CompressedStorage storage;
+
+    friend class CSRMatrix;
+
+    CSCMatrix(size_t rows, size_t cols, detail::CompressedStorage storage)
+        : numRows(rows), numCols(cols), storage(std::move(storage)) {}
+
+public:
+    // All zeros
+    CSCMatrix(size_t rows, size_t cols) : numRows(rows), numCols(cols){
+        detail::checkSparseShape(rows, cols);
+        storage.start.assign(cols + 1, 0);
+    }
+
+    // From raw CSC arrays; throws FatalException unless they describe a valid rows x cols matrix
+    CSCMatrix(size_t rows, size_t cols, std::vector<size_t> colStart,
+              std::vector<SparseIndex> rowIndex, std::vector<double> values)
+        : numRows(rows), numCols(cols){
+        detail::checkSparseShape(rows, cols);
+        storage = {std::move(colStart), std::move(rowIndex), std::move(values)};
+        detail::validateCompressed(storage, cols, rows);
+    }
+
+    // Elements of a dense matrix with |value| > threshold
+    explicit CSCMatrix(ConstMatrixView dense, double threshold = 0.0)
+        : numRows(dense.rows()), numCols(dense.cols()){
+        detail::checkSparseShape(numRows, numCols);
+        storage = detail::transposeCompressed(detail::compressDense(dense, threshold), numRows, numCols);
+    }
+
+    // Triplets in any order, duplicates summed; throws FatalException for mismatched lengths or out-of-range indices
+    static CSCMatrix fromTriplets(size_t rows, size_t cols, const std::vector<SparseIndex>& rowIndex,
+                                  const std::vector<SparseIndex>& colIndex, const std::vector<double>& values){
+        detail::checkTriplets(rows, cols, rowIndex, colIndex, values);
+        return CSCMatrix(rows, cols, detail::compressTriplets(cols, colIndex, rowIndex, values));
+    }
+
+    size_t rows() const { return numRows; }
+    size_t cols() const { return numCols; }
+    size_t nonZeros() const { return storage.values.size(); }
+    size_t memoryBytes() const {
+        return storage.start.size() * sizeof(size_t) + storage.index.size() * sizeof(SparseIndex)
+             + storage.values.size() * sizeof(double);
+    }
+
+    const std::vector<size_t>& getColStart() const { return storage.start; }
+    const std::vector<SparseIndex>& getRowIndex() const { return storage.index; }
+    const std::vector<double>& getValues() const { return storage.values; }
+
+    // Element lookup (binary search within the column); 0 for entries that are not stored
+    double operator()(size_t row, size_t col) const{
+        auto begin = storage.index.begin() + storage.start[col], end = storage.index.begin() + storage.start[col + 1];
+        auto found = std::lower_bound(begin, end, static_cast<SparseIndex>(row));
+        return (found != end && *found == row) ? storage.values[found - storage.index.begin()] : 0.0;
+    }
+
+    Matrix toDense() const{
+        Matrix dense(numCols, numRows);
+        double* out = dense.getData();
+        for(size_t j = 0; j < numCols; j++)
+            for(size_t p = storage.start[j]; p < storage.start[j + 1]; p++)
+                out[storage.index[p] * numCols + j] = storage.values[p];
+        return dense;
+    }
+
+    CSCMatrix transpose() const{
+        return CSCMatrix(numCols, numRows, detail::transposeCompressed(storage, numCols, numRows));
+    }
+
+    CSRMatrix toCSR() const{
+        return CSRMatrix(numRows, numCols, detail::transposeCompressed(storage, numCols, numRows));
+    }
+
+    // y = A x for raw vectors (x has cols() elements, y has rows())
+    void multiply(const double* x, double* y) const{
+        detail::scatterProduct(storage, numCols, numRows, x, 1, y, 1, 1);
+    }
+
+    // y = A^T x (x has rows() elements, y has cols()); columns run in parallel
+    void multiplyTransposed(const double* x, double* y) const{
+        detail::gatherProduct(storage, numCols, x, 1, y, 1, 1);
+    }
+
+    // A B for a dense B with rows() == B.rows(); bands of B's columns run in parallel
+    Matrix multiply(ConstMatrixView dense) const{
+        if(dense.rows() != numCols)
+            throw error::NonFatalException("Unable to multiply matrices, mismatching dimensions");
+        Matrix result(dense.cols(), numRows);
+        detail::scatterProduct(storage, numCols, numRows, dense.getData(), dense.getStride(), result.getData(), dense.cols(), dense.cols());
+        return result;
+    }
+
+    // B A for a dense B: element (i, j) gathers row i of B against column j of A
+    Matrix multiplyLeft(ConstMatrixView dense) const{
+        if(dense.cols() != numRows)
+            throw error::NonFatalException("Unable to multiply matrices, mismatching dimensions");
+        Matrix result(numCols, dense.rows());
+        double* out = result.getData();
+        detail::forEachBand(0, dense.rows(), nonZeros(), [&](size_t low, size_t high){
+            for(size_t i = low; i < high; i++)
+                for(size_t j = 0; j < numCols; j++){
+                    double sum = 0.0;
+                    for(size_t p = storage.start[j]; p < storage.start[j + 1]; p++)
+                        sum += dense(i, storage.index[p]) * storage.values[p];
+                    out[i * numCols + j] = sum;
+                }
+        });
+        return result;
+    }
+};
+
+inline CSCMatrix CSRMatrix::toCSC() const{
+    return CSCMatrix(numRows, numCols, detail::transposeCompressed(storage, numRows, numCols));
+}
+
+inline CSRMatrix COOMatrix::toCSR() const{
+    return CSRMatrix::fromTriplets(numRows, numCols, rowIndex, colIndex, values);
+}
+
+inline CSCMatrix COOMatrix::toCSC() const{
+    return CSCMatrix::fromTriplets(numRows, numCols, rowIndex, colIndex, values);
+}
+
+// Sparse-dense products: S * B and B * S for any Matrix or view B
+inline Matrix operator*(const CSRMatrix& sparse, ConstMatrixView dense) { return sparse.multiply(dense); }
+inline Matrix operator*(ConstMatrixView dense, const CSRMatrix& sparse) { return sparse.multiplyLeft(dense); }
+inline Matrix operator*(const CSCMatrix& sparse, ConstMatrixView dense) { return sparse.multiply(dense); }
+inline Matrix operator*(ConstMatrixView dense, const CSCMatrix& sparse) { return sparse.multiplyLeft(dense); }
+
+} // namespace la
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "Allocator.hpp"
+#include "Gemm.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+
+// Strassen-Winograd multiplication for very large products (7 half-size
+// products and 15 block additions per level instead of 8 products), selected
+// with setMultiplyAlgorithm(MultiplyAlgorithm::Strassen). Each level halves
+// m, n and k; once any of them is below getStrassenThreshold() the blocked
+// GEMM from Gemm.hpp takes over. Odd dimensions are peeled off: the even
+// leading block goes through the recursion and the last row, column or
+// rank-1 term is finished with GEMM.
+//
+// On one thread the recursion follows the Boyer-Dumas-Pernet-Zhou schedule,
+// which needs only two half-size temporaries per level. With the thread pool
+// available, the seven top-level products run as separate tasks (each
+// recursing serially) and are combined with parallel block additions.
+//
+// Rounding differs from the classic product: the error bound grows with the
+// number of levels, which is why the recursion stops at a large threshold.
+
+namespace la{
+
+enum class MultiplyAlgorithm{
+    Classic,        // blocked GEMM for every product (the default)
+    Strassen        // Strassen-Winograd while m, n and k all reach the threshold
+};
+
+namespace detail{
+
+inline std::atomic<MultiplyAlgorithm>& multiplyAlgorithm(){
+    static std::atomic<MultiplyAlgorithm> algorithm{MultiplyAlgorithm::Classic};
+    return algorithm;
+}
+
+inline std::atomic<size_t>& strassenThreshold(){
+    static std::atomic<size_t> threshold{512};          // best leaf size in MatrixBenchmark (single core, AVX-512)
+    return threshold;
+}
+
+// out = x + y and out = x - y on rows x cols blocks, each with its own leading dimension
+template<class T>
+inline void addBlocks(size_t rows, size_t cols, const T* x, size_t ldx, const T* y, size_t ldy, T* out, size_t ldo){
+    const ElementwiseKernels<T>& kernels = simd<T>();
+    forEachBand(0, rows, cols, [&](size_t low, size_t high){
+        for(size_t r = low; r < high; r++) kernels.addVV(x + r * ldx, y + r * ldy, out + r * ldo, cols);
+    });
+}
+
+template<class T>
+inline void subBlocks(size_t rows, size_t cols, const T* x, size_t ldx, const T* y, size_t ldy, T* out, size_t ldo){
+    const ElementwiseKernels<T>& kernels = simd<T>();
+    forEachBand(0, rows, cols, [&](size_t low, size_t high){
+        for(size_t r = low; r < high; r++) kernels.subVV(x + r * ldx, y + r * ldy, out + r * ldo, cols);
+    });
+}
+
+// c = a * b with the blocked GEMM (which accumulates, so c is cleared first)
+template<class T>
+inline void classicMultiply(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc){
+    for(size_t r = 0; r < m; r++) std::fill(c + r * ldc, c + r * ldc + n, T(0));
+    gemm(m, n, k, a, lda, b, ldb, c, ldc);
+}
+
+// Quadrants of the even leading block of a rows x cols operand
+template<class T>
+struct Quadrants{
+    T *q11, *q12, *q21, *q22;
+
+    Quadrants(T* p, size_t ld, size_t halfRows, size_t halfCols)
+        : q11(p), q12(p + halfCols), q21(p + halfRows * ld), q22(p + halfRows * ld + halfCols) {}
+};
+
+// Finish the last row, column and rank-1 term that the even (2 mh) x (2 nh) x (2 kh) recursion left out
+template<class T>
+inline void strassenFringe(size_t m, size_t n, size_t k, size_t mh, size_t nh, size_t kh,
+                           const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc){
+    size_t M = 2 * mh, N = 2 * nh, K = 2 * kh;
+    if(k > K) gemm(M, N, k - K, a + K, lda, b + K * ldb, ldb, c, ldc);
+    if(n > N) classicMultiply(M, n - N, k, a, lda, b + N, ldb, c + N, ldc);
+    if(m > M) classicMultiply(m - M, n, k, a + M * lda, lda, b, ldb, c + M * ldc, ldc);
+}
+
+// c (m x n) = a (m x k) * b (k x n), overwriting c, with two temporaries per level:
+// X (mh x max(kh, nh)) and Y (kh x nh). Step order from Boyer, Dumas, Pernet and Zhou,
+// "Memory efficient scheduling of Strassen-Winograd's matrix multiplication algorithm".
+template<class T>
+void strassenSerial(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, size_t threshold){
+    if(std::min({m, n, k}) < threshold){
+        classicMultiply(m, n, k, a, lda, b, ldb, c, ldc);
+        return;
+    }
+
+    size_t mh = m / 2, nh = n / 2, kh = k / 2;
+    Quadrants<const T> A(a, lda, mh, kh), B(b, ldb, kh, nh);
+    Quadrants<T> C(c, ldc, mh, nh);
+
+    size_t ldx = std::max(kh, nh), ldy = nh;
+    ScratchVector<T> xBuffer(mh * ldx), yBuffer(kh * ldy);
+    T* x = xBuffer.data();
+    T* y = yBuffer.data();
+    auto product = [&](const T* p, size_t ldp, const T* q, size_t ldq, T* out, size_t ldo){
+        strassenSerial(mh, nh, kh, p, ldp, q, ldq, out, ldo, threshold);
+    };
+
+    subBlocks(mh, kh, A.q11, lda, A.q21, lda, x, ldx);         // S3 = A11 - A21
+    subBlocks(kh, nh, B.q22, ldb, B.q12, ldb, y, ldy);         // T3 = B22 - B12
+    product(x, ldx, y, ldy, C.q21, ldc);                        // P7 = S3 T3
+    addBlocks(mh, kh, A.q21, lda, A.q22, lda, x, ldx);         // S1 = A21 + A22
+    subBlocks(kh, nh, B.q12, ldb, B.q11, ldb, y, ldy);         // T1 = B12 - B11
+    product(x, ldx, y, ldy, C.q22, ldc);                        // P5 = S1 T1
+    subBlocks(kh, nh, B.q22, ldb, y, ldy, y, ldy);             // T2 = B22 - T1
+    subBlocks(mh, kh, x, ldx, A.q11, lda, x, ldx);             // S2 = S1 - A11
+    product(x, ldx, y, ldy, C.q12, ldc);                        // P6 = S2 T2
+    subBlocks(mh, kh, A.q12, lda, x, ldx, x, ldx);             // S4 = A12 - S2
+    product(x, ldx, B.q22, ldb, C.q11, ldc);                    // P3 = S4 B22
+    product(A.q11, lda, B.q11, ldb, x, ldx);                    // P1 = A11 B11
+    addBlocks(mh, nh, x, ldx, C.q12, ldc, C.q12, ldc);         // U2 = P1 + P6
+    addBlocks(mh, nh, C.q12, ldc, C.q21, ldc, C.q21, ldc);     // U3 = U2 + P7
+    addBlocks(mh, nh, C.q12, ldc, C.q22, ldc, C.q12, ldc);     // U4 = U2 + P5
+    addBlocks(mh, nh, C.q21, ldc, C.q22, ldc, C.q22, ldc);     // C22 = U7 = U3 + P5
+    addBlocks(mh, nh, C.q12, ldc, C.q11, ldc, C.q12, ldc);     // C12 = U5 = U4 + P3
+    subBlocks(kh, nh, y, ldy, B.q21, ldb, y, ldy);             // T4 = T2 - B21
+    product(A.q22, lda, y, ldy, C.q11, ldc);                    // P4 = A22 T4
+    subBlocks(mh, nh, C.q21, ldc, C.q11, ldc, C.q21, ldc);     // C21 = U6 = U3 - P4
+    product(A.q12, lda, B.q21, ldb, C.q11, ldc);                // P2 = A12 B21
+    addBlocks(mh, nh, x, ldx, C.q11, ldc, C.q11, ldc);         // C11 = U1 = P1 + P2
+
+    strassenFringe(m, n, k, mh, nh, kh, a, lda, b, ldb, c, ldc);
+}
+
+// One level with the seven products as thread-pool tasks. P2..P5 are written
+// straight into the quadrants of c, P1, P6 and P7 into temporaries; every task
+// builds its own operand sums and recurses serially.
+template<class T>
+void strassenParallel(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc, size_t threshold){
+    size_t mh = m / 2, nh = n / 2, kh = k / 2;
+    Quadrants<const T> A(a, lda, mh, kh), B(b, ldb, kh, nh);
+    Quadrants<T> C(c, ldc, mh, nh);
+    ScratchVector<T> p1(mh * nh), p6(mh * nh), p7(mh * nh);
+
+    ThreadPool::instance().parallelFor(0, 7, 1, [&](size_t low, size_t high){
+        for(size_t task = low; task < high; task++){
+            ScratchVector<T> s(task >= 2 && task != 3 ? mh * kh : 0), t(task >= 3 ? kh * nh : 0);
+            auto product = [&](const T* p, size_t ldp, const T* q, size_t ldq, T* out, size_t ldo){
+                strassenSerial(mh, nh, kh, p, ldp, q, ldq, out, ldo, threshold);
+            };
+
+            switch(task){
+            case 0:                                                     // P1 = A11 B11
+                product(A.q11, lda, B.q11, ldb, p1.data(), nh);
+                break;
+            case 1:                                                     // P2 = A12 B21
+                product(A.q12, lda, B.q21, ldb, C.q11, ldc);
+                break;
+            case 2:                                                     // P3 = S4 B22, S4 = A12 - (A21 + A22 - A11)
+                addBlocks(mh, kh, A.q21, lda, A.q22, lda, s.data(), kh);
+                subBlocks(mh, kh, s.data(), kh, A.q11, lda, s.data(), kh);
+                subBlocks(mh, kh, A.q12, lda, s.data(), kh, s.data(), kh);
+                product(s.data(), kh, B.q22, ldb, C.q12, ldc);
+                break;
+            case 3:                                                     // P4 = A22 T4, T4 = (B22 - (B12 - B11)) - B21
+                subBlocks(kh, nh, B.q12, ldb, B.q11, ldb, t.data(), nh);
+                subBlocks(kh, nh, B.q22, ldb, t.data(), nh, t.data(), nh);
+                subBlocks(kh, nh, t.data(), nh, B.q21, ldb, t.data(), nh);
+                product(A.q22, lda, t.data(), nh, C.q21, ldc);
+                break;
+            case 4:                                                     // P5 = S1 T1
+                addBlocks(mh, kh, A.q21, lda, A.q22, lda, s.data(), kh);
+                subBlocks(kh, nh, B.q12, ldb, B.q11, ldb, t.data(), nh);
+                product(s.data(), kh, t.data(), nh, C.q22, ldc);
+                break;
+            case 5:                                                     // P6 = S2 T2
+                addBlocks(mh, kh, A.q21, lda, A.q22, lda, s.data(), kh);
+                subBlocks(mh, kh, s.data(), kh, A.q11, lda, s.data(), kh);
+                subBlocks(kh, nh, B.q12, ldb, B.q11, ldb, t.data(), nh);
+                subBlocks(kh, nh, B.q22, ldb, t.data(), nh, t.data(), nh);
+                product(s.data(), kh, t.data(), nh, p6.data(), nh);
+                break;
+            default:                                                    // P7 = S3 T3
+                subBlocks(mh, kh, A.q11, lda, A.q21, lda, s.data(), kh);
+                subBlocks(kh, nh, B.q22, ldb, B.q12, ldb, t.data(), nh);
+                product(s.data(), kh, t.data(), nh, p7.data(), nh);
+                break;
+            }
+        }
+    });
+
+    addBlocks(mh, nh, C.q11, ldc, p1.data(), nh, C.q11, ldc);          // C11 = P2 + P1
+    addBlocks(mh, nh, p1.data(), nh, p6.data(), nh, p1.data(), nh);    // U2 = P1 + P6
+    addBlocks(mh, nh, p1.data(), nh, p7.data(), nh, p7.data(), nh);    // U3 = U2 + P7
+    addBlocks(mh, nh, C.q12, ldc, p1.data(), nh, C.q12, ldc);          // P3 + U2
+    addBlocks(mh, nh, C.q12, ldc, C.q22, ldc, C.q12, ldc);             // C12 = P3 + U2 + P5
+    addBlocks(mh, nh, C.q22, ldc, p7.data(), nh, C.q22, ldc);          // C22 = P5 + U3
+    subBlocks(mh, nh, p7.data(), nh, C.q21, ldc, C.q21, ldc);          // C21 = U3 - P4
+
+    strassenFringe(m, n, k, mh, nh, kh, a, lda, b, ldb, c, ldc);
+}
+
+// c (m x n) = a (m x k) * b (k x n) with the selected algorithm, overwriting c
+template<class T>
+inline void multiplyInto(size_t m, size_t n, size_t k, const T* a, size_t lda, const T* b, size_t ldb, T* c, size_t ldc){
+    size_t threshold = std::max<size_t>(strassenThreshold(), 2);
+    if(multiplyAlgorithm() != MultiplyAlgorithm::Strassen || std::min({m, n, k}) < threshold)
+        classicMultiply(m, n, k, a, lda, b, ldb, c, ldc);
+    else if(ThreadPool::instance().worthParallel(m * n))
+        strassenParallel(m, n, k, a, lda, b, ldb, c, ldc, threshold);
+    else
+        strassenSerial(m, n, k, a, lda, b, ldb, c, ldc, threshold);
+}
+
+} // namespace detail
+
+// --- Public configuration ---
+
+// Algorithm for matrix products (operator*, multiply); Classic by default
+inline void setMultiplyAlgorithm(MultiplyAlgorithm algorithm){
+    detail::multiplyAlgorithm() = algorithm;
+}
+
+inline MultiplyAlgorithm getMultiplyAlgorithm(){
+    return detail::multiplyAlgorithm();
+}
+
+// Strassen recursion continues while m, n and k are all at least this large; smaller
+// (sub)products use the blocked GEMM
+inline void setStrassenThreshold(size_t dimension){
+    detail::strassenThreshold() = dimension;
+}
+
+inline size_t getStrassenThreshold(){
+    return detail::strassenThreshold();
+}
+
+} // namespace la
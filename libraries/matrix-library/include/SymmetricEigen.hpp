@@ -0,0 +1,328 @@
+#pragma once
+
+// Eigen-decomposition A = X diag(lambda) X^T of a symmetric matrix.
+// Included by Matrix.hpp after the Matrix class; use it through Matrix.hpp.
+//
+// A is first reduced to tridiagonal form T = Q^T A Q with Householder
+// reflectors (stored LAPACK-style below the subdiagonal, so Q is applied
+// with the QR block-reflector kernels). The eigenvalues of T come from the
+// implicit QL algorithm. With every eigenvector requested, the QL rotations
+// are accumulated as well; when only the top `count` are requested, their
+// eigenvectors are found by inverse iteration on T instead, which avoids
+// the O(n^3) rotation accumulation.
+
+#include "QR.hpp"
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+namespace la{
+namespace detail{
+
+// Whether the n x n row-major matrix a is symmetric to within a relative tolerance
+inline bool isSymmetric(const double* a, size_t n, double tolerance){
+    for(size_t i = 0; i < n; i++)
+        for(size_t j = 0; j < i; j++){
+            double upper = a[j * n + i], lower = a[i * n + j];
+            if(std::abs(upper - lower) > tolerance * (1.0 + std::max(std::abs(upper), std::abs(lower))))
+                return false;
+        }
+    return true;
+}
+
+// In-place reduction of the symmetric n x n matrix a to tridiagonal form. d receives the
+// diagonal, e the subdiagonal (e[n-1] = 0) and tau the n - 1 reflector scalars; reflector k
+// acts on rows k + 1 .. n - 1 and its vector is stored below a[k + 1][k].
+inline void tridiagonalize(double* a, size_t n, double* d, double* e, double* tau){
+    std::vector<double> v(n), p(n), w(n);
+
+    for(size_t k = 0; k + 1 < n; k++){
+        size_t s = n - k - 1;                           // size of the trailing block
+        double* column = a + (k + 1) * n + k;           // column k from row k + 1, stride n
+
+        double alpha = column[0];
+        double sigma = 0.0;
+        for(size_t i = 1; i < s; i++) sigma += column[i * n] * column[i * n];
+
+        d[k] = a[k * n + k];
+        if(sigma == 0.0){
+            tau[k] = 0.0;
+            e[k] = alpha;
+            continue;
+        }
+
+        double beta = -std::copysign(std::sqrt(alpha * alpha + sigma), alpha);
+        tau[k] = (beta - alpha) / beta;
+        double scale = 1.0 / (alpha - beta);
+        for(size_t i = 1; i < s; i++) column[i * n] *= scale;
+        e[k] = beta;
+
+        // Contiguous copy of v (unit leading entry); A22 = a[k + 1 ..][k + 1 ..]
+        v[0] = 1.0;
+        for(size_t i = 1; i < s; i++) v[i] = column[i * n];
+        double* a22 = a + (k + 1) * n + (k + 1);
+
+        // p = tau A22 v
+        forEachBand(0, s, s, [&](size_t low, size_t high){
+            for(size_t i = low; i < high; i++){
+                const double* row = a22 + i * n;
+                double sum = 0.0;
+                for(size_t j = 0; j < s; j++) sum += row[j] * v[j];
+                p[i] = tau[k] * sum;
+            }
+        });
+
+        // w = p - (tau / 2)(p^T v) v
+        double pv = 0.0;
+        for(size_t i = 0; i < s; i++) pv += p[i] * v[i];
+        double half = 0.5 * tau[k] * pv;
+        for(size_t i = 0; i < s; i++) w[i] = p[i] - half * v[i];
+
+        // A22 -= v w^T + w v^T
+        forEachBand(0, s, s, [&](size_t low, size_t high){
+            for(size_t i = low; i < high; i++){
+                double* row = a22 + i * n;
+                double vi = v[i], wi = w[i];
+                for(size_t j = 0; j < s; j++) row[j] -= vi * w[j] + wi * v[j];
+            }
+        });
+    }
+    if(n > 0){
+        d[n - 1] = a[(n - 1) * n + (n - 1)];
+        e[n - 1] = 0.0;
+    }
+}
+
+// Implicit QL iteration on the symmetric tridiagonal (d, e); d receives the eigenvalues, unsorted.
+// If z is given (n x n row-major, one vector per row) the rotations are applied to its rows,
+// so starting from the identity row i ends up as the eigenvector of T for d[i].
+// Returns false if an eigenvalue failed to converge.
+inline bool tridiagonalQL(double* d, double* e, size_t n, double* z){
+    const double eps = std::numeric_limits<double>::epsilon();
+    double shift = 0.0, tst1 = 0.0;
+
+    for(size_t l = 0; l < n; l++){
+        tst1 = std::max(tst1, std::abs(d[l]) + std::abs(e[l]));
+        size_t m = l;
+        while(m < n - 1 && std::abs(e[m]) > eps * tst1) m++;
+
+        int iterations = 0;
+        while(m > l){
+            if(++iterations > 60) return false;
+
+            // Wilkinson-style shift from the leading 2x2 block
+            double g = d[l];
+            double p = (d[l + 1] - g) / (2.0 * e[l]);
+            double r = std::hypot(p, 1.0);
+            if(p < 0) r = -r;
+            d[l] = e[l] / (p + r);
+            d[l + 1] = e[l] * (p + r);
+            double dl1 = d[l + 1];
+            double h = g - d[l];
+            for(size_t i = l + 2; i < n; i++) d[i] -= h;
+            shift += h;
+
+            // Chase the bulge with plane rotations
+            p = d[m];
+            double c = 1.0, c2 = 1.0, c3 = 1.0, s = 0.0, s2 = 0.0;
+            double el1 = e[l + 1];
+            for(size_t i = m; i-- > l;){
+                c3 = c2;
+                c2 = c;
+                s2 = s;
+                g = c * e[i];
+                h = c * p;
+                r = std::hypot(p, e[i]);
+                e[i + 1] = s * r;
+                s = e[i] / r;
+                c = p / r;
+                p = c * d[i] - s * g;
+                d[i + 1] = h + s * (c * g + s * d[i]);
+
+                if(z){
+                    double* zi = z + i * n;
+                    double* zNext = z + (i + 1) * n;
+                    for(size_t k = 0; k < n; k++){
+                        double t = zNext[k];
+                        zNext[k] = s * zi[k] + c * t;
+                        zi[k] = c * zi[k] - s * t;
+                    }
+                }
+            }
+            p = -s * s2 * c3 * el1 * e[l] / dl1;
+            e[l] = s * p;
+            d[l] = c * p;
+
+            if(std::abs(e[l]) <= eps * tst1) break;
+        }
+        d[l] += shift;
+        e[l] = 0.0;
+    }
+    return true;
+}
+
+// Eigenvector of the symmetric tridiagonal (d, e) for the eigenvalue lambda by inverse iteration,
+// kept orthogonal to the `previous` unit vectors (rows of length n, for clustered eigenvalues)
+inline void tridiagonalInverseIteration(const double* d, const double* e, size_t n, double lambda,
+                                        const double* previous, size_t numPrevious, double* x){
+    double norm = 0.0;
+    for(size_t i = 0; i < n; i++)
+        norm = std::max(norm, std::abs(d[i]) + std::abs(e[i]) + (i > 0 ? std::abs(e[i - 1]) : 0.0));
+    double tiny = std::numeric_limits<double>::epsilon() * std::max(norm, 1.0);
+
+    // LU of T - lambda I with partial pivoting (as LAPACK's gttrf): diagonal, two superdiagonals, multipliers
+    std::vector<double> diag(n), upper(n, 0.0), upper2(n, 0.0), lower(n, 0.0);
+    std::vector<bool> swapped(n, false);
+    for(size_t i = 0; i < n; i++){
+        diag[i] = d[i] - lambda;
+        if(i + 1 < n){
+            upper[i] = e[i];
+            lower[i] = e[i];
+        }
+    }
+    for(size_t i = 0; i + 1 < n; i++){
+        if(std::abs(diag[i]) >= std::abs(lower[i])){
+            if(diag[i] == 0.0) diag[i] = tiny;
+            double factor = lower[i] / diag[i];
+            lower[i] = factor;
+            diag[i + 1] -= factor * upper[i];
+        }else{
+            double factor = diag[i] / lower[i];
+            diag[i] = lower[i];
+            lower[i] = factor;
+            double temp = upper[i];
+            upper[i] = diag[i + 1];
+            diag[i + 1] = temp - factor * diag[i + 1];
+            if(i + 2 < n){
+                upper2[i] = upper[i + 1];
+                upper[i + 1] = -factor * upper[i + 1];
+            }
+            swapped[i] = true;
+        }
+    }
+    if(n > 0 && diag[n - 1] == 0.0) diag[n - 1] = tiny;
+
+    // Deterministic start vector with no special structure
+    for(size_t i = 0; i < n; i++) x[i] = 1.0 + 0.5 * std::sin(1.0 + double(i));
+
+    auto orthonormalize = [&]{
+        for(size_t j = 0; j < numPrevious; j++){
+            const double* q = previous + j * n;
+            double dot = 0.0;
+            for(size_t i = 0; i < n; i++) dot += q[i] * x[i];
+            for(size_t i = 0; i < n; i++) x[i] -= dot * q[i];
+        }
+        double length = 0.0;
+        for(size_t i = 0; i < n; i++) length += x[i] * x[i];
+        length = std::sqrt(length);
+        if(length == 0.0) return;
+        for(size_t i = 0; i < n; i++) x[i] /= length;
+    };
+
+    orthonormalize();
+    for(int iteration = 0; iteration < 3; iteration++){
+        for(size_t i = 0; i + 1 < n; i++){
+            if(!swapped[i]){
+                x[i + 1] -= lower[i] * x[i];
+            }else{
+                double temp = x[i];
+                x[i] = x[i + 1];
+                x[i + 1] = temp - lower[i] * x[i];
+            }
+        }
+        for(size_t i = n; i-- > 0;){
+            double sum = x[i];
+            if(i + 1 < n) sum -= upper[i] * x[i + 1];
+            if(i + 2 < n) sum -= upper2[i] * x[i + 2];
+            x[i] = sum / diag[i];
+        }
+        orthonormalize();
+    }
+}
+
+} // namespace detail
+
+class SymmetricEigen{
+private:
+    size_t n;
+    std::vector<double> values;         // descending
+    std::vector<double> vectors;        // row-major n x count, one eigenvector per column
+
+public:
+    // Throws FatalException for non-square input and NonFatalException if the matrix
+    // is not symmetric or the iteration fails to converge. count = 0 computes every
+    // eigenpair; otherwise only the `count` largest eigenvalues and their eigenvectors.
+    explicit SymmetricEigen(ConstMatrixView matrix, size_t count = 0)
+        : n(matrix.cols()){
+        if(matrix.rows() != matrix.cols())
+            throw error::FatalException("Eigen-decomposition requires a square matrix.");
+
+        std::vector<double> a(n * n);
+        matrix.copyTo(a.data(), n);
+        if(!detail::isSymmetric(a.data(), n, 1e-10))
+            throw error::NonFatalException("Matrix is not symmetric, cannot compute symmetric eigen-decomposition.");
+        if(count == 0 || count > n) count = n;
+
+        std::vector<double> d(n), e(n), tau(n);
+        detail::tridiagonalize(a.data(), n, d.data(), e.data(), tau.data());
+
+        // Eigenvectors of T, one per row, in the order of `values`
+        std::vector<double> z;
+        std::vector<size_t> order(n);
+        std::iota(order.begin(), order.end(), 0);
+        auto descending = [&](size_t i, size_t j){ return d[i] > d[j]; };
+        values.resize(count);
+
+        if(count == n){
+            std::vector<double> rotations(n * n, 0.0);
+            for(size_t i = 0; i < n; i++) rotations[i * n + i] = 1.0;
+
+            if(!detail::tridiagonalQL(d.data(), e.data(), n, rotations.data()))
+                throw error::NonFatalException("Eigenvalue iteration did not converge.");
+            std::sort(order.begin(), order.end(), descending);
+
+            z.resize(n * n);
+            for(size_t j = 0; j < n; j++){
+                values[j] = d[order[j]];
+                std::copy_n(rotations.begin() + order[j] * n, n, z.begin() + j * n);
+            }
+        }else{
+            std::vector<double> diagonal = d, offDiagonal = e;
+            if(!detail::tridiagonalQL(d.data(), e.data(), n, nullptr))
+                throw error::NonFatalException("Eigenvalue iteration did not converge.");
+            std::partial_sort(order.begin(), order.begin() + count, order.end(), descending);
+
+            z.resize(count * n);
+            for(size_t j = 0; j < count; j++){
+                values[j] = d[order[j]];
+                detail::tridiagonalInverseIteration(diagonal.data(), offDiagonal.data(), n, values[j],
+                                                    z.data(), j, z.data() + j * n);
+            }
+        }
+
+        vectors.resize(n * count);
+        for(size_t j = 0; j < count; j++)
+            for(size_t i = 0; i < n; i++) vectors[i * count + j] = z[j * n + i];
+
+        // Back to the basis of A: X = Q Z, where Q acts on rows 1 .. n - 1
+        if(n > 1)
+            detail::qrApplyQ(a.data() + n, n - 1, n - 1, n, tau.data(), vectors.data() + count, count, count);
+    }
+
+    size_t getSize() const { return n; }
+    size_t getCount() const { return values.size(); }
+
+    // Eigenvalues in descending order
+    const std::vector<double>& getEigenvalues() const { return values; }
+
+    // n x count matrix whose columns are the unit eigenvectors, in the order of getEigenvalues()
+    Matrix getEigenvectors() const{
+        Matrix result(values.size(), n);
+        std::copy(vectors.begin(), vectors.end(), result.getData());
+        return result;
+    }
+};
+
+}
@@ -0,0 +1,243 @@
+#pragma once
+
+#include "Allocator.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Library-wide thread pool shared by every la::Matrix routine.
+// Workers are started lazily on the first parallel call and sleep between
+// calls. parallelFor hands out fixed-size chunks of an index range through an
+// atomic counter; the calling thread works on chunks too and returns once all
+// of them are done. Calls made from inside a parallel region (nested calls),
+// or while another thread owns the pool, simply run serially.
+// Operations on fewer elements than the parallel threshold never touch the pool.
+
+namespace la{
+namespace detail{
+
+constexpr size_t PARALLEL_TILE = 16 * 1024;     // doubles per elementwise tile (128 KiB, fits in L2)
+
+class ThreadPool{
+private:
+    std::vector<std::thread> workers;
+    std::mutex mutex;
+    std::condition_variable workAvailable, workFinished;
+    std::mutex submitMutex;                     // one parallel region at a time
+
+    // Current job
+    std::function<void(size_t, size_t)> job;
+    size_t jobEnd = 0, jobGrain = 1;
+    std::atomic<size_t> nextIndex{0};
+    size_t busyWorkers = 0;
+    uint64_t generation = 0;
+    bool stopping = false;
+    std::exception_ptr failure;
+
+    std::atomic<size_t> numThreads;             // including the calling thread; read without submitMutex
+    std::atomic<size_t> threshold{32 * 1024};   // minimum elements before going parallel
+
+    ThreadPool(){
+        numThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    static bool& insideRegion(){
+        thread_local bool inside = false;
+        return inside;
+    }
+
+    void runChunks(){
+        while(true){
+            size_t low = nextIndex.fetch_add(jobGrain);
+            if(low >= jobEnd) break;
+            size_t high = std::min(low + jobGrain, jobEnd);
+
+            try{
+                job(low, high);
+            }catch(...){
+                std::lock_guard<std::mutex> lock(mutex);
+                if(!failure) failure = std::current_exception();
+            }
+        }
+    }
+
+    void workerLoop(){
+        insideRegion() = true;
+        uint64_t seen = 0;
+
+        while(true){
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                workAvailable.wait(lock, [&]{ return stopping || generation != seen; });
+                if(stopping) return;
+                seen = generation;
+            }
+
+            runChunks();
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if(--busyWorkers == 0) workFinished.notify_one();
+        }
+    }
+
+    void startWorkers(){
+        while(workers.size() + 1 < numThreads)
+            workers.emplace_back([this]{ workerLoop(); });
+    }
+
+    void stopWorkers(){
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        workAvailable.notify_all();
+        for(std::thread& worker : workers) worker.join();
+        workers.clear();
+        stopping = false;
+    }
+
+public:
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool(){
+        stopWorkers();
+    }
+
+    static ThreadPool& instance(){
+        static ThreadPool pool;
+        return pool;
+    }
+
+    size_t getNumThreads() const { return numThreads; }
+
+    // 0 selects std::thread::hardware_concurrency()
+    void setNumThreads(size_t count){
+        std::lock_guard<std::mutex> submit(submitMutex);
+        stopWorkers();
+        numThreads = count ? count : std::max<size_t>(1, std::thread::hardware_concurrency());
+    }
+
+    size_t getThreshold() const { return threshold; }
+    void setThreshold(size_t elements) { threshold = elements; }
+
+    // Whether an operation touching `elements` values is worth splitting
+    bool worthParallel(size_t elements) const {
+        return numThreads > 1 && elements >= threshold && !insideRegion();
+    }
+
+    // Run body(low, high) over [begin, end) in chunks of `grain` indices
+    template<class F>
+    void parallelFor(size_t begin, size_t end, size_t grain, F&& body){
+        if(end <= begin) return;
+        grain = std::max<size_t>(grain, 1);
+
+        if(numThreads < 2 || end - begin <= grain || insideRegion()){
+            body(begin, end);
+            return;
+        }
+
+        std::unique_lock<std::mutex> submit(submitMutex, std::try_to_lock);
+        if(!submit.owns_lock()){
+            body(begin, end);
+            return;
+        }
+
+        startWorkers();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = [&body](size_t low, size_t high){ body(low, high); };
+            jobEnd = end;
+            jobGrain = grain;
+            nextIndex = begin;
+            busyWorkers = workers.size();
+            failure = nullptr;
+            generation++;
+        }
+        workAvailable.notify_all();
+
+        insideRegion() = true;
+        runChunks();
+        insideRegion() = false;
+
+        std::exception_ptr error;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workFinished.wait(lock, [&]{ return busyWorkers == 0; });
+            job = nullptr;
+            error = failure;
+        }
+        if(error) std::rethrow_exception(error);
+    }
+};
+
+// body(low, high) over [0, size) in PARALLEL_TILE tiles, serially below the threshold
+template<class F>
+void forEachTile(size_t size, F&& body){
+    ThreadPool& pool = ThreadPool::instance();
+    if(!pool.worthParallel(size)) body(0, size);
+    else pool.parallelFor(0, size, PARALLEL_TILE, body);
+}
+
+// Sum of partial(low, high) over [0, size) in PARALLEL_TILE tiles, added in tile order on every
+// path, so the rounding does not depend on the thread count or the parallel threshold
+template<class F>
+double sumTiles(size_t size, F&& partial){
+    ThreadPool& pool = ThreadPool::instance();
+    if(!pool.worthParallel(size)){
+        double sum = 0.0;
+        for(size_t tile = 0; tile < size; tile += PARALLEL_TILE) sum += partial(tile, std::min(tile + PARALLEL_TILE, size));
+        return sum;
+    }
+
+    ScratchVector<double> partials((size + PARALLEL_TILE - 1) / PARALLEL_TILE, 0.0);
+    pool.parallelFor(0, size, PARALLEL_TILE, [&](size_t low, size_t high){
+        for(size_t tile = low; tile < high; tile += PARALLEL_TILE)
+            partials[tile / PARALLEL_TILE] = partial(tile, std::min(tile + PARALLEL_TILE, high));
+    });
+
+    double sum = 0.0;
+    for(double value : partials) sum += value;
+    return sum;
+}
+
+// body(low, high) over [begin, end) where each index touches `elementsPerIndex` values
+// (rows of a matrix, columns of a right-hand side), in bands of about one tile
+template<class F>
+void forEachBand(size_t begin, size_t end, size_t elementsPerIndex, F&& body){
+    ThreadPool& pool = ThreadPool::instance();
+    if(end <= begin) return;
+    if(!pool.worthParallel((end - begin) * elementsPerIndex)) body(begin, end);
+    else pool.parallelFor(begin, end, std::max<size_t>(1, PARALLEL_TILE / std::max<size_t>(elementsPerIndex, 1)), body);
+}
+
+} // namespace detail
+
+// --- Public configuration ---
+
+// Threads used by la::Matrix operations (including the calling thread); 0 = hardware concurrency
+inline void setNumThreads(size_t count){
+    detail::ThreadPool::instance().setNumThreads(count);
+}
+
+inline size_t getNumThreads(){
+    return detail::ThreadPool::instance().getNumThreads();
+}
+
+// Operations on fewer elements than this run on the calling thread only
+inline void setParallelThreshold(size_t elements){
+    detail::ThreadPool::instance().setThreshold(elements);
+}
+
+inline size_t getParallelThreshold(){
+    return detail::ThreadPool::instance().getThreshold();
+}
+
+} // namespace la
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "Allocator.hpp"
+#include "Simd.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Transpose kernels for row-major buffers.
+// Out of place, the matrix is split recursively along its longer side until a
+// block fits in L1 (cache-oblivious: no tuning for the cache sizes), and each
+// leaf is transposed with the dispatched 4x4 (AVX2) or 8x8 (AVX-512) register
+// kernels. Square matrices are transposed in place by swapping tile pairs
+// through a small buffer; rectangular ones by following the cycles of the
+// index permutation, with one visited bit per element.
+
+namespace la{
+namespace detail{
+
+constexpr size_t TRANSPOSE_LEAF = 32 * 32;     // elements per leaf block (8 KiB, source and destination stay in L1)
+constexpr size_t TRANSPOSE_TILE = 32;          // tile edge for the square in-place transpose
+
+// out (cols x rows, leading dimension ldo) = transpose of a (rows x cols, leading dimension lda)
+template<class T>
+inline void transposeRecursive(const T* a, size_t lda, T* out, size_t ldo, size_t rows, size_t cols){
+    if(rows * cols <= TRANSPOSE_LEAF || rows < 16 || cols < 16){
+        simd<T>().transpose(a, lda, out, ldo, rows, cols);
+        return;
+    }
+
+    // Halve the longer side, keeping the first half a multiple of 8 for the register kernels
+    if(rows >= cols){
+        size_t half = (rows / 2 + 7) / 8 * 8;
+        transposeRecursive(a, lda, out, ldo, half, cols);
+        transposeRecursive(a + half * lda, lda, out + half, ldo, rows - half, cols);
+    }else{
+        size_t half = (cols / 2 + 7) / 8 * 8;
+        transposeRecursive(a, lda, out, ldo, rows, half);
+        transposeRecursive(a + half, lda, out + half * ldo, ldo, rows, cols - half);
+    }
+}
+
+// out (cols x rows, leading dimension ldo) = transpose of a (rows x cols, leading dimension lda);
+// row bands of a write disjoint columns of out
+template<class T>
+inline void transpose(const T* a, size_t lda, size_t rows, size_t cols, T* out, size_t ldo){
+    forEachBand(0, rows, cols, [&](size_t low, size_t high){
+        transposeRecursive(a + low * lda, lda, out + low, ldo, high - low, cols);
+    });
+}
+
+// Packed rows on both sides
+template<class T>
+inline void transpose(const T* a, size_t rows, size_t cols, T* out){
+    transpose(a, cols, rows, cols, out, rows);
+}
+
+// In-place transpose of the n x n matrix a
+template<class T>
+inline void transposeSquareInPlace(T* a, size_t n){
+    size_t tiles = (n + TRANSPOSE_TILE - 1) / TRANSPOSE_TILE;
+
+    // Tile row I owns the pairs (I, J) with J >= I, so bands of tile rows never touch the same data
+    forEachBand(0, tiles, TRANSPOSE_TILE * n, [&](size_t low, size_t high){
+        T buffer[TRANSPOSE_TILE * TRANSPOSE_TILE];
+        const ElementwiseKernels<T>& kernels = simd<T>();
+
+        for(size_t I = low; I < high; I++){
+            size_t i0 = I * TRANSPOSE_TILE, ib = std::min(TRANSPOSE_TILE, n - i0);
+
+            for(size_t i = 0; i < ib; i++)
+                for(size_t j = i + 1; j < ib; j++)
+                    std::swap(a[(i0 + i) * n + i0 + j], a[(i0 + j) * n + i0 + i]);
+
+            for(size_t J = I + 1; J < tiles; J++){
+                size_t j0 = J * TRANSPOSE_TILE, jb = std::min(TRANSPOSE_TILE, n - j0);
+                T* upper = a + i0 * n + j0;        // ib x jb
+                T* lower = a + j0 * n + i0;        // jb x ib
+
+                kernels.transpose(upper, n, buffer, ib, ib, jb);
+                kernels.transpose(lower, n, upper, n, jb, ib);
+                for(size_t r = 0; r < jb; r++)
+                    std::copy(buffer + r * ib, buffer + (r + 1) * ib, lower + r * n);
+            }
+        }
+    });
+}
+
+// In-place transpose of the rows x cols matrix a into cols x rows. Element p = i * cols + j
+// moves to j * rows + i; each cycle of that permutation is walked once, carrying one value.
+template<class T>
+inline void transposeCyclesInPlace(T* a, size_t rows, size_t cols){
+    if(rows == 1 || cols == 1) return;         // a vector has the same layout either way
+    if(rows == cols){
+        transposeSquareInPlace(a, rows);
+        return;
+    }
+
+    size_t size = rows * cols;
+    ScratchVector<uint64_t> visited((size + 63) / 64, 0);
+    auto seen = [&](size_t p){ return (visited[p / 64] >> (p % 64)) & 1u; };
+    auto mark = [&](size_t p){ visited[p / 64] |= uint64_t(1) << (p % 64); };
+
+    // The first and last elements stay where they are
+    for(size_t start = 1; start + 1 < size; start++){
+        if(seen(start)) continue;
+
+        T carried = a[start];
+        size_t p = start;
+        do{
+            size_t next = (p % cols) * rows + p / cols;
+            std::swap(carried, a[next]);
+            mark(next);
+            p = next;
+        }while(p != start);
+    }
+}
+
+} // namespace detail
+} // namespace la
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "Gemm.hpp"
+#include "ThreadPool.hpp"
+#include <algorithm>
+#include <cstddef>
+
+// Triangular solves with many right-hand sides (TRSM), shared by the LU,
+// Cholesky and QR factorizations. op(T) X = B is solved in place on B, where T
+// is a row-major triangular matrix and op(T) is T or T^T. Off-diagonal blocks
+// are applied with GEMM so large solves run at multiply speed; only the
+// TRSM_BLOCK-sized diagonal blocks use substitution, split across the thread
+// pool by right-hand-side columns.
+
+namespace la{
+namespace detail{
+
+constexpr size_t TRSM_BLOCK = 64;
+
+enum class Triangle{
+    Lower,
+    Upper
+};
+
+// Substitution on rows [i0, i1) and columns [low, high) of B, assuming the rows
+// outside the block have already been applied. op(T)(i, j) = t[i * rs + j * cs].
+inline void substituteBlock(bool forward, bool unitDiagonal, size_t i0, size_t i1,
+                            const double* t, size_t rs, size_t cs,
+                            double* b, size_t ldb, size_t low, size_t high){
+    auto solveRow = [&](size_t i, size_t j0, size_t j1){
+        double* bRow = b + i * ldb;
+        for(size_t j = j0; j < j1; j++){
+            double factor = t[i * rs + j * cs];
+            const double* source = b + j * ldb;
+            for(size_t c = low; c < high; c++)
+                bRow[c] -= factor * source[c];
+        }
+        if(!unitDiagonal){
+            double pivot = t[i * rs + i * cs];
+            for(size_t c = low; c < high; c++)
+                bRow[c] /= pivot;
+        }
+    };
+
+    if(forward)
+        for(size_t i = i0; i < i1; i++) solveRow(i, i0, i);
+    else
+        for(size_t i = i1; i-- > i0;) solveRow(i, i + 1, i1);
+}
+
+// Solve op(T) X = B in place. T is n x n (leading dimension ldt), B is n x numRhs (leading dimension ldb).
+inline void triangularSolve(Triangle triangle, bool transposed, bool unitDiagonal, size_t n,
+                            const double* t, size_t ldt, double* b, size_t ldb, size_t numRhs){
+    if(n == 0 || numRhs == 0) return;
+
+    size_t rs = transposed ? 1 : ldt;
+    size_t cs = transposed ? ldt : 1;
+    bool forward = (triangle == Triangle::Lower) != transposed;
+
+    auto diagonalBlock = [&](size_t i0, size_t i1){
+        forEachBand(0, numRhs, i1 - i0, [&](size_t low, size_t high){
+            substituteBlock(forward, unitDiagonal, i0, i1, t, rs, cs, b, ldb, low, high);
+        });
+    };
+
+    // Too few columns for packing to pay off: plain substitution
+    if(numRhs < GEMM_NR){
+        diagonalBlock(0, n);
+        return;
+    }
+
+    if(forward){
+        for(size_t i0 = 0; i0 < n; i0 += TRSM_BLOCK){
+            size_t i1 = std::min(i0 + TRSM_BLOCK, n);
+            gemm(i1 - i0, numRhs, i0, -1.0, t + i0 * rs, rs, cs, b, ldb, 1, b + i0 * ldb, ldb);
+            diagonalBlock(i0, i1);
+        }
+    }else{
+        for(size_t i1 = n; i1 > 0;){
+            size_t i0 = (i1 - 1) / TRSM_BLOCK * TRSM_BLOCK;
+            gemm(i1 - i0, numRhs, n - i1, -1.0, t + i0 * rs + i1 * cs, rs, cs, b + i1 * ldb, ldb, 1, b + i0 * ldb, ldb);
+            diagonalBlock(i0, i1);
+            i1 = i0;
+        }
+    }
+}
+
+} // namespace detail
+} // namespace la